@@ -1108,19 +1108,19 @@ const char *DrawNodeMenu(CGEditorContext *cgEd, RenderTexture2D view)
     Color HighlightColor = {80, 80, 80, 255};
 
     const char *menuItems[] = {"Variable", "Event", "Get", "Set", "Flow", "Sprite", "Draw Prop", "Logical", "Debug", "Literal"};
-    const char *subMenuItems[][9] = {
-        {"Create number", "Create string", "Create bool", "Create color", "", "", "", "", ""},
-        {"Event Start", "Event Tick", "Event On Button", "Create Custom Event", "Call Custom Event", "", "", "", ""},
-        {"Get variable", "Get Screen Width", "Get Screen Height", "Get Mouse X", "Get Mouse Y", "Get Random Number", "", "", ""},
-        {"Set variable", "Set Background", "Set FPS", "", "", "", "", "", ""},
-        {"Branch", "Loop", "Delay", "Flip Flop", "Break", "Return", "", "", ""},
-        {"Create sprite", "Spawn sprite", "Destroy sprite", "Set Sprite Position", "Set Sprite Rotation", "Set Sprite Texture", "Set Sprite Size", "Move To", "Force"},
-        {"Draw Prop Texture", "Draw Prop Rectangle", "Draw Prop Circle", "", "", "", "", "", ""},
-        {"Comparison", "Gate", "Arithmetic", "", "", "", "", "", ""},
-        {"Print To Log", "Draw Debug Line", "", "", "", "", "", "", ""},
-        {"Literal number", "Literal string", "Literal bool", "Literal color", "", "", "", "", ""}};
+    const char *subMenuItems[][13] = {
+        {"Create number", "Create string", "Create bool", "Create color", "", "", "", "", "", "", "", "", ""},
+        {"Event Start", "Event Tick", "Event On Button", "Create Custom Event", "Call Custom Event", "On Collision Begin", "On Collision End", "", "", "", "", "", ""},
+        {"Get variable", "Get Screen Width", "Get Screen Height", "Get Mouse X", "Get Mouse Y", "Get Random Number", "Raycast", "Overlap Circle", "Overlap Rectangle", "Nearest Sprite", "Sprite At Point", "Get Camera", ""},
+        {"Set variable", "Set Background", "Set FPS", "Set Camera", "Camera Follow", "", "", "", "", "", "", "", ""},
+        {"Branch", "Loop", "Delay", "Flip Flop", "Break", "Return", "", "", "", "", "", "", ""},
+        {"Create sprite", "Spawn sprite", "Destroy sprite", "Set Sprite Position", "Set Sprite Rotation", "Set Sprite Texture", "Set Sprite Size", "Move To", "Force", "Set Sprite Physics", "Set Collision Group", "Set Groups Collide", "Set Z Order"},
+        {"Draw Prop Texture", "Draw Prop Rectangle", "Draw Prop Circle", "", "", "", "", "", "", "", "", "", ""},
+        {"Comparison", "Gate", "Arithmetic", "", "", "", "", "", "", "", "", "", ""},
+        {"Print To Log", "Draw Debug Line", "", "", "", "", "", "", "", "", "", "", ""},
+        {"Literal number", "Literal string", "Literal bool", "Literal color", "", "", "", "", "", "", "", "", ""}};
     int menuItemCount = sizeof(menuItems) / sizeof(menuItems[0]);
-    int subMenuCounts[] = {4, 5, 6, 3, 6, 9, 3, 3, 2, 4};
+    int subMenuCounts[] = {4, 7, 12, 5, 6, 13, 3, 3, 2, 4};
 
     if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON))
     {
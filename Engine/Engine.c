@@ -7,6 +7,7 @@
 #include "Engine.h"
 #include "Interpreter.h"
 #include "HitboxEditor.h"
+#include "Transpiler.h"
 
 bool STRING_ALLOCATION_FAILURE = false;
 
@@ -79,6 +80,7 @@ EngineContext InitEngineContext()
 
     eng.viewportMode = VIEWPORT_CG_EDITOR;
     eng.isGameRunning = false;
+    eng.isLiveEditing = false;
 
     eng.saveSound = LoadSoundFromWave(LoadWaveFromMemory(".wav", save_wav, save_wav_len));
     if (eng.saveSound.frameCount == 0)
@@ -109,11 +111,15 @@ EngineContext InitEngineContext()
 
     eng.fpsLimit = 240;
     eng.shouldShowFPS = false;
+    eng.physicsWorkerCount = 1;
+    eng.textureBudgetMB = TEXTURE_CACHE_DEFAULT_BUDGET_MB;
 
     eng.isAnyMenuOpen = false;
 
     eng.shouldCloseWindow = false;
 
+    eng.shouldExportNative = false;
+
     return eng;
 }
 
@@ -481,6 +487,26 @@ void DrawSlider(Vector2 pos, bool *value, Vector2 mousePos)
     }
 }
 
+bool DrawSettingsButton(Vector2 pos, const char *text, Vector2 mousePos, Font font)
+{
+    Rectangle button = {pos.x, pos.y, 90, 30};
+    bool isHovered = CheckCollisionPointRec(mousePos, button);
+
+    DrawRectangleRounded(button, 0.2f, 4, isHovered ? (Color){0, 128, 0, 255} : (Color){60, 60, 60, 255});
+    DrawTextEx(font, text, (Vector2){button.x + (button.width - MeasureTextEx(font, text, 20, 1).x) / 2, button.y + 4}, 20, 1, WHITE);
+
+    if (isHovered)
+    {
+        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void DrawFPSLimitDropdown(Vector2 pos, int *limit, Vector2 mousePos, Font font)
 {
     static bool dropdownOpen = false;
@@ -528,6 +554,102 @@ void DrawFPSLimitDropdown(Vector2 pos, int *limit, Vector2 mousePos, Font font)
     }
 }
 
+void DrawPhysicsWorkersDropdown(Vector2 pos, int *workerCount, Vector2 mousePos, Font font)
+{
+    static bool dropdownOpen = false;
+    int workerOptions[] = {16, 8, 4, 2, 1};
+    int workerOptionsCount = sizeof(workerOptions) / sizeof(workerOptions[0]);
+
+    float blockHeight = 30;
+
+    Rectangle mainBox = {pos.x, pos.y, 90, blockHeight};
+    DrawRectangle(pos.x, pos.y, 90, blockHeight, (Color){60, 60, 60, 255});
+    DrawTextEx(font, TextFormat("%d", *workerCount), (Vector2){pos.x + 38 - 5 * (*workerCount / 10), pos.y + 4}, 20, 1, WHITE);
+    DrawRectangleLines(pos.x, pos.y, 90, blockHeight, WHITE);
+
+    if (dropdownOpen)
+    {
+        for (int i = 0; i < workerOptionsCount; i++)
+        {
+            Rectangle optionBox = {mainBox.x - (i + 1) * 40, mainBox.y, 40, blockHeight};
+            DrawRectangle(mainBox.x - (i + 1) * 40 - 2, mainBox.y, 40, blockHeight, (*workerCount == workerOptions[i]) ? (Color){0, 128, 0, 255} : (Color){60, 60, 60, 255});
+            DrawTextEx(font, TextFormat("%d", workerOptions[i]), (Vector2){optionBox.x + 14 - 5 * (workerOptions[i] / 10), optionBox.y + 4}, 20, 1, WHITE);
+
+            if (CheckCollisionPointRec(mousePos, optionBox))
+            {
+                SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+                {
+                    *workerCount = workerOptions[i];
+                    dropdownOpen = false;
+                }
+            }
+        }
+    }
+
+    if (CheckCollisionPointRec(mousePos, mainBox))
+    {
+        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            dropdownOpen = !dropdownOpen;
+        }
+    }
+    else if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    {
+        dropdownOpen = false;
+    }
+}
+
+void DrawTextureBudgetDropdown(Vector2 pos, int *budgetMB, Vector2 mousePos, Font font)
+{
+    static bool dropdownOpen = false;
+    int budgetOptions[] = {1024, 512, 256, 128, 64};
+    int budgetOptionsCount = sizeof(budgetOptions) / sizeof(budgetOptions[0]);
+
+    float blockHeight = 30;
+
+    Rectangle mainBox = {pos.x, pos.y, 90, blockHeight};
+    DrawRectangle(pos.x, pos.y, 90, blockHeight, (Color){60, 60, 60, 255});
+    const char *budgetText = TextFormat("%d MB", *budgetMB);
+    DrawTextEx(font, budgetText, (Vector2){pos.x + (90 - MeasureTextEx(font, budgetText, 20, 1).x) / 2, pos.y + 4}, 20, 1, WHITE);
+    DrawRectangleLines(pos.x, pos.y, 90, blockHeight, WHITE);
+
+    if (dropdownOpen)
+    {
+        for (int i = 0; i < budgetOptionsCount; i++)
+        {
+            Rectangle optionBox = {mainBox.x - (i + 1) * 50, mainBox.y, 50, blockHeight};
+            DrawRectangle(mainBox.x - (i + 1) * 50 - 2, mainBox.y, 50, blockHeight, (*budgetMB == budgetOptions[i]) ? (Color){0, 128, 0, 255} : (Color){60, 60, 60, 255});
+            const char *optionText = TextFormat("%d", budgetOptions[i]);
+            DrawTextEx(font, optionText, (Vector2){optionBox.x + (50 - MeasureTextEx(font, optionText, 20, 1).x) / 2, optionBox.y + 4}, 20, 1, WHITE);
+
+            if (CheckCollisionPointRec(mousePos, optionBox))
+            {
+                SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+                {
+                    *budgetMB = budgetOptions[i];
+                    dropdownOpen = false;
+                }
+            }
+        }
+    }
+
+    if (CheckCollisionPointRec(mousePos, mainBox))
+    {
+        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            dropdownOpen = !dropdownOpen;
+        }
+    }
+    else if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    {
+        dropdownOpen = false;
+    }
+}
+
 bool DrawSettingsMenu(EngineContext *eng, InterpreterContext *intp)
 {
 
@@ -632,10 +754,24 @@ bool DrawSettingsMenu(EngineContext *eng, InterpreterContext *intp)
 
         DrawTextEx(eng->font, "Show Hitboxes", (Vector2){eng->screenWidth / 4 + 200, 350}, 28, 1, WHITE);
         DrawSlider((Vector2){eng->screenWidth * 3 / 4 - 70, 355}, &intp->shouldShowHitboxes, eng->mousePos);
+
+        DrawTextEx(eng->font, "Physics Threads", (Vector2){eng->screenWidth / 4 + 200, 400}, 28, 1, WHITE);
+        DrawPhysicsWorkersDropdown((Vector2){eng->screenWidth * 3 / 4 - 100, 405}, &eng->physicsWorkerCount, eng->mousePos, eng->font);
+
+        DrawTextEx(eng->font, "Show Draw Calls", (Vector2){eng->screenWidth / 4 + 200, 450}, 28, 1, WHITE);
+        DrawSlider((Vector2){eng->screenWidth * 3 / 4 - 70, 455}, &intp->shouldShowDrawCalls, eng->mousePos);
+
+        DrawTextEx(eng->font, "Texture Memory", (Vector2){eng->screenWidth / 4 + 200, 500}, 28, 1, WHITE);
+        DrawTextureBudgetDropdown((Vector2){eng->screenWidth * 3 / 4 - 100, 505}, &eng->textureBudgetMB, eng->mousePos, eng->font);
         break;
     case SETTINGS_MODE_KEYBINDS:
         break;
     case SETTINGS_MODE_EXPORT:
+        DrawTextEx(eng->font, "Native Build", (Vector2){eng->screenWidth / 4 + 200, 300}, 28, 1, WHITE);
+        if (DrawSettingsButton((Vector2){eng->screenWidth * 3 / 4 - 100, 300}, "Export", eng->mousePos, eng->font))
+        {
+            eng->shouldExportNative = true;
+        }
         break;
     default:
         settingsMode = SETTINGS_MODE_ENGINE;
@@ -644,6 +780,75 @@ bool DrawSettingsMenu(EngineContext *eng, InterpreterContext *intp)
     return true;
 }
 
+void ExportNativeBuild(EngineContext *eng, GraphContext *graph, CGEditorContext *cgEd)
+{
+    if (cgEd->hasChanged)
+    {
+        AddToLog(eng, "Project not saved!{I102}", LOG_LEVEL_WARNING);
+        return;
+    }
+
+    char projectName[MAX_FILE_NAME];
+    strmac(projectName, MAX_FILE_NAME, "%s", GetFileNameWithoutExt(eng->CGFilePath));
+
+    InterpreterContext exportIntp = InitInterpreterContext();
+    exportIntp.projectPath = eng->projectPath;
+    exportIntp.physicsWorkerCount = eng->physicsWorkerCount;
+    exportIntp.textureBudgetMB = eng->textureBudgetMB;
+    RuntimeGraphContext exportGraph = ConvertToRuntimeGraph(graph, &exportIntp);
+    exportIntp.runtimeGraph = &exportGraph;
+
+    for (int i = 0; i < exportIntp.logMessageCount; i++)
+    {
+        AddToLog(eng, exportIntp.logMessages[i], exportIntp.logMessageLevels[i]);
+    }
+
+    if (exportIntp.buildErrorOccured || exportIntp.buildFailed)
+    {
+        AddToLog(eng, "Build failed{I100}", LOG_LEVEL_ERROR);
+        FreeInterpreterContext(&exportIntp);
+        return;
+    }
+
+    char cwd[MAX_FILE_PATH];
+    if (!GetCWD(cwd, sizeof(cwd)))
+    {
+        FreeInterpreterContext(&exportIntp);
+        return;
+    }
+
+    char engineSourcePath[MAX_FILE_PATH];
+    strmac(engineSourcePath, MAX_FILE_PATH, "%s%cEngine", cwd, PATH_SEPARATOR);
+    if (!DirectoryExists(engineSourcePath))
+    {
+        strmac(engineSourcePath, MAX_FILE_PATH, "%s", cwd);
+    }
+
+    char sourcePath[MAX_FILE_PATH];
+    char executablePath[MAX_FILE_PATH];
+    strmac(sourcePath, MAX_FILE_PATH, "%s%c%s.c", eng->projectPath, PATH_SEPARATOR, projectName);
+    strmac(executablePath, MAX_FILE_PATH, "%s%c%s%s", eng->projectPath, PATH_SEPARATOR, projectName, NATIVE_EXECUTABLE_EXTENSION);
+
+    if (!IsShellSafePath(engineSourcePath) || !IsShellSafePath(sourcePath) || !IsShellSafePath(executablePath))
+    {
+        AddToLog(eng, "Project path contains characters the build command cannot quote{E228}", LOG_LEVEL_ERROR);
+    }
+    else if (!TranspileRuntimeGraph(&exportGraph, &exportIntp, projectName, sourcePath))
+    {
+        AddToLog(eng, "Failed to generate native source{E226}", LOG_LEVEL_ERROR);
+    }
+    else if (!CompileTranspiledProject(engineSourcePath, sourcePath, executablePath))
+    {
+        AddToLog(eng, "Native compilation failed, is gcc installed?{E227}", LOG_LEVEL_ERROR);
+    }
+    else
+    {
+        AddToLog(eng, "Native build exported{E300}", LOG_LEVEL_SUCCESS);
+    }
+
+    FreeInterpreterContext(&exportIntp);
+}
+
 void CountingSortByLayer(EngineContext *eng)
 {
     int **elements = malloc(MAX_LAYER_COUNT * sizeof(int *));
@@ -684,6 +889,31 @@ void CountingSortByLayer(EngineContext *eng)
     free(elements);
 }
 
+// Live edit patches the unsaved graph into the paused game, keeping its variables, sprites and forces
+bool PatchLiveGame(EngineContext *eng, GraphContext *graph, InterpreterContext *intp, RuntimeGraphContext *runtimeGraph)
+{
+    bool patched = HotPatchRuntimeGraph(graph, intp, runtimeGraph);
+
+    for (int i = 0; i < intp->logMessageCount; i++)
+        AddToLog(eng, intp->logMessages[i], intp->logMessageLevels[i]);
+    intp->newLogMessage = false;
+    intp->logMessageCount = 0;
+
+    eng->delayFrames = true;
+    if (patched)
+        eng->wasBuilt = true;
+    return patched;
+}
+
+void ResumeLiveEdit(EngineContext *eng, GraphContext *graph, InterpreterContext *intp, RuntimeGraphContext *runtimeGraph)
+{
+    if (!PatchLiveGame(eng, graph, intp, runtimeGraph))
+        return;
+
+    eng->isLiveEditing = false;
+    eng->viewportMode = VIEWPORT_GAME_SCREEN;
+}
+
 void DrawUIElements(EngineContext *eng, GraphContext *graph, CGEditorContext *cgEd, InterpreterContext *intp, RuntimeGraphContext *runtimeGraph)
 {
     eng->isSaveButtonHovered = false;
@@ -722,12 +952,18 @@ void DrawUIElements(EngineContext *eng, GraphContext *graph, CGEditorContext *cg
                 cgEd->isFirstFrame = true;
                 eng->isGameRunning = false;
                 eng->wasBuilt = false;
+                eng->isLiveEditing = false;
                 FreeInterpreterContext(intp);
             }
             break;
         case UI_ACTION_RUN_GAME:
             if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
             {
+                if (eng->isLiveEditing)
+                {
+                    ResumeLiveEdit(eng, graph, intp, runtimeGraph);
+                    break;
+                }
                 if (cgEd->hasChanged)
                 {
                     AddToLog(eng, "Project not saved!{I102}", LOG_LEVEL_WARNING);
@@ -746,6 +982,11 @@ void DrawUIElements(EngineContext *eng, GraphContext *graph, CGEditorContext *cg
         case UI_ACTION_BUILD_GRAPH:
             if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
             {
+                if (eng->isLiveEditing)
+                {
+                    PatchLiveGame(eng, graph, intp, runtimeGraph);
+                    break;
+                }
                 if (cgEd->hasChanged)
                 {
                     AddToLog(eng, "Project not saved!{I102}", LOG_LEVEL_WARNING);
@@ -912,7 +1153,7 @@ void DrawUIElements(EngineContext *eng, GraphContext *graph, CGEditorContext *cg
             break;
 
         case UI_ACTION_VAR_TOOLTIP_RUNTIME:
-            strmac(temp, MAX_VARIABLE_TOOLTIP_SIZE, "%s %s = %s", ValueTypeToString(intp->values[eng->uiElements[eng->hoveredUIElementIndex].valueIndex].type), intp->values[eng->uiElements[eng->hoveredUIElementIndex].valueIndex].name, ValueToString(intp->values[eng->uiElements[eng->hoveredUIElementIndex].valueIndex]));
+            strmac(temp, MAX_VARIABLE_TOOLTIP_SIZE, "%s %s = %s", ValueTypeToString(intp->values.types[eng->uiElements[eng->hoveredUIElementIndex].valueIndex]), intp->values.names[eng->uiElements[eng->hoveredUIElementIndex].valueIndex], ValueToString(GetValue(intp, eng->uiElements[eng->hoveredUIElementIndex].valueIndex)));
             AddUIElement(eng, (UIElement){
                                      .name = "VarTooltip",
                                      .shape = UIRectangle,
@@ -1220,7 +1461,7 @@ void BuildUITexture(EngineContext *eng, GraphContext *graph, CGEditorContext *cg
         {
             if (eng->isGameRunning)
             {
-                if (!intp->values[i].isVariable)
+                if (!intp->values.isVariable[i])
                 {
                     continue;
                 }
@@ -1234,8 +1475,8 @@ void BuildUITexture(EngineContext *eng, GraphContext *graph, CGEditorContext *cg
             }
 
             Color varColor;
-            strmac(cutMessage, MAX_VARIABLE_NAME_SIZE, "%s", eng->isGameRunning ? intp->values[i].name : graph->variables[i]);
-            switch (eng->isGameRunning ? intp->values[i].type : graph->variableTypes[i])
+            strmac(cutMessage, MAX_VARIABLE_NAME_SIZE, "%s", eng->isGameRunning ? intp->values.names[i] : graph->variables[i]);
+            switch (eng->isGameRunning ? intp->values.types[i] : graph->variableTypes[i])
             {
             case VAL_NUMBER:
             case NODE_CREATE_NUMBER:
@@ -1596,7 +1837,11 @@ bool HandleUICollisions(EngineContext *eng, GraphContext *graph, InterpreterCont
     }
     else if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_R))
     {
-        if (cgEd->hasChanged)
+        if (eng->isLiveEditing)
+        {
+            ResumeLiveEdit(eng, graph, intp, runtimeGraph);
+        }
+        else if (cgEd->hasChanged)
         {
             AddToLog(eng, "Project not saved!{I102}", LOG_LEVEL_WARNING);
         }
@@ -1619,12 +1864,34 @@ bool HandleUICollisions(EngineContext *eng, GraphContext *graph, InterpreterCont
         cgEd->isFirstFrame = true;
         eng->isGameRunning = false;
         eng->wasBuilt = false;
+        eng->isLiveEditing = false;
         eng->isGameFullscreen = false;
         FreeInterpreterContext(intp);
     }
+    else if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_L))
+    {
+        if (eng->viewportMode == VIEWPORT_GAME_SCREEN && eng->isGameRunning)
+        {
+            cgEd->delayFrames = true;
+            eng->delayFrames = true;
+            eng->viewportMode = VIEWPORT_CG_EDITOR;
+            cgEd->isFirstFrame = true;
+            eng->isGameFullscreen = false;
+            eng->isLiveEditing = true;
+            AddToLog(eng, "Live edit: Ctrl+L patches the changes into the running game{E301}", LOG_LEVEL_NORMAL);
+        }
+        else if (eng->isLiveEditing)
+        {
+            ResumeLiveEdit(eng, graph, intp, runtimeGraph);
+        }
+    }
     else if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_B))
     {
-        if (cgEd->hasChanged)
+        if (eng->isLiveEditing)
+        {
+            PatchLiveGame(eng, graph, intp, runtimeGraph);
+        }
+        else if (cgEd->hasChanged)
         {
             AddToLog(eng, "Project not saved!{I102}", LOG_LEVEL_WARNING);
         }
@@ -1648,6 +1915,25 @@ bool HandleUICollisions(EngineContext *eng, GraphContext *graph, InterpreterCont
             }
         }
     }
+    else if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_H) && eng->viewportMode == VIEWPORT_CG_EDITOR)
+    {
+        int failedCount;
+        int generatedCount = GenerateMissingHitboxes(graph, eng->projectPath, eng->physicsWorkerCount, &failedCount);
+        if (generatedCount > 0)
+        {
+            cgEd->hasChanged = true;
+            AddToLog(eng, TextFormat("Generated %d sprite hitboxes from texture alpha{H300}", generatedCount), LOG_LEVEL_SUCCESS);
+        }
+        if (failedCount > 0)
+        {
+            AddToLog(eng, TextFormat("Could not generate %d sprite hitboxes, their textures need a valid Literal string file name{H100}", failedCount), LOG_LEVEL_WARNING);
+        }
+        if (generatedCount == 0 && failedCount == 0)
+        {
+            AddToLog(eng, "Every sprite already has a hitbox{H301}", LOG_LEVEL_NORMAL);
+        }
+        eng->delayFrames = true;
+    }
     else if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_S) && IsKeyDown(KEY_LEFT_SHIFT))
     {
         cgEd->delayFrames = true;
@@ -1656,6 +1942,7 @@ bool HandleUICollisions(EngineContext *eng, GraphContext *graph, InterpreterCont
         cgEd->isFirstFrame = true;
         eng->isGameRunning = false;
         eng->wasBuilt = false;
+        eng->isLiveEditing = false;
         eng->isGameFullscreen = false;
         FreeInterpreterContext(intp);
     }
@@ -1938,6 +2225,12 @@ int main()
 
         ContextChangePerFrame(&eng);
 
+        if (eng.shouldExportNative)
+        {
+            ExportNativeBuild(&eng, &graph, &cgEd);
+            eng.shouldExportNative = false;
+        }
+
         int prevHoveredUIIndex = eng.hoveredUIElementIndex;
         eng.isAnyMenuOpen = eng.showSaveWarning == 1 || eng.showSettingsMenu;
 
@@ -2056,7 +2349,11 @@ int main()
             BeginTextureMode(eng.viewportTex);
             ClearBackground(BLACK);
 
+            intp.physicsWorkerCount = eng.physicsWorkerCount;
+            intp.textureBudgetMB = eng.textureBudgetMB;
             eng.isGameRunning = HandleGameScreen(&intp, &runtimeGraph, mouseInViewportTex, viewportRecInViewportTex);
+            // Threads that could not start fall back to one, the setting follows so they are not retried every frame
+            eng.physicsWorkerCount = intp.physicsWorkerCount;
 
             if (!eng.isGameRunning)
             {
@@ -2111,6 +2408,7 @@ int main()
                     float scaleX = (float)newWidth / (float)img.width;
                     float scaleY = (float)newHeight / (float)img.height;
 
+                    Image source = ImageCopy(img);
                     ImageResize(&img, newWidth, newHeight);
 
                     Texture2D tex = LoadTextureFromImage(img);
@@ -2121,6 +2419,7 @@ int main()
                         eng.viewportTex.texture.height / 2.0f};
 
                     hbEd = InitHitboxEditor(tex, texPos, (Vector2){scaleX, scaleY});
+                    hbEd.image = source;
 
                     for (int i = 0; i < graph.pinCount; i++)
                     {
@@ -2152,6 +2451,8 @@ int main()
             DrawHitboxEditor(&hbEd, mouseInViewportTex);
             DrawTextEx(eng.font, "ESC - Save & Exit Hitbox Editor", (Vector2){viewportRecInViewportTex.x + 30, viewportRecInViewportTex.y + 30}, 30, 1, GRAY);
             DrawTextEx(eng.font, "R - reset hitbox", (Vector2){viewportRecInViewportTex.x + 30, viewportRecInViewportTex.y + 70}, 30, 1, GRAY);
+            DrawTextEx(eng.font, TextFormat("G - generate from texture, up to %d vertices (Up/Down)", hbEd.vertexBudget), (Vector2){viewportRecInViewportTex.x + 30, viewportRecInViewportTex.y + 110}, 30, 1, GRAY);
+            DrawTextEx(eng.font, TextFormat("C - collide as: %s", GetHitboxFitLabel(&hbEd.poly)), (Vector2){viewportRecInViewportTex.x + 30, viewportRecInViewportTex.y + 150}, 30, 1, GRAY);
             EndTextureMode();
 
             break;
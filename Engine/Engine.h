@@ -158,6 +158,7 @@ typedef struct EngineContext
 
     bool isGameRunning;
     bool wasBuilt;
+    bool isLiveEditing;
     VarFilter varsFilter;
 
     Sound saveSound;
@@ -169,8 +170,12 @@ typedef struct EngineContext
     bool isSoundOn;
     int fpsLimit;
     bool shouldShowFPS;
+    int physicsWorkerCount;
+    int textureBudgetMB;
     bool isAutoSaveON;
 
+    bool shouldExportNative;
+
     Logs logs;
 
 } EngineContext;
@@ -1,11 +1,21 @@
 #include "raylib.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include "HitboxEditor.h"
+#include "Interpreter.h"
+#include "Threads.h"
 
 #define SNAP_DIST 10.0f
 #define MAX_VERTICES 64
 
+// Pixels with less alpha than this are treated as see-through when tracing
+#define HBED_ALPHA_THRESHOLD 128
+// Deviation in texture pixels below which generation stops adding vertices
+#define HBED_SIMPLIFY_TOLERANCE 1.0f
+#define HBED_DEFAULT_VERTEX_BUDGET 16
+#define HBED_MAX_BATCH_WORKERS 16
+
 HitboxEditorContext InitHitboxEditor(Texture2D tex, Vector2 pos, Vector2 scale)
 {
     HitboxEditorContext hbEd = {0};
@@ -16,6 +26,7 @@ HitboxEditorContext InitHitboxEditor(Texture2D tex, Vector2 pos, Vector2 scale)
     hbEd.draggingVerticeIndex = -1;
     hbEd.scale = scale;
     hbEd.lastActionType = HBED_LAST_ACTION_TYPE_NONE;
+    hbEd.vertexBudget = HBED_DEFAULT_VERTEX_BUDGET;
     return hbEd;
 }
 
@@ -26,6 +37,452 @@ static bool IsNear(Vector2 a, Vector2 b, float dist)
     return (dx * dx + dy * dy) < (dist * dist);
 }
 
+static float SegmentDistance(Vector2 p, Vector2 a, Vector2 b)
+{
+    Vector2 ab = {b.x - a.x, b.y - a.y};
+    float lengthSq = ab.x * ab.x + ab.y * ab.y;
+    float t = lengthSq > 0 ? ((p.x - a.x) * ab.x + (p.y - a.y) * ab.y) / lengthSq : 0;
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    float dx = p.x - (a.x + ab.x * t);
+    float dy = p.y - (a.y + ab.y * t);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// Douglas-Peucker on a closed ring, refined worst point first so it can stop at the vertex budget:
+// starts from two far apart points and keeps adding whichever point strays furthest from the outline so far
+static int SimplifyRing(const Vector2 *ring, int n, int budget, float tolerance, Vector2 *out)
+{
+    if (n <= 3)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = ring[i];
+        return n;
+    }
+
+    int kept[MAX_POLYGON_VERTICES];
+    int count = 2;
+    kept[0] = 0;
+    kept[1] = 0;
+    float farthest = -1;
+    for (int i = 1; i < n; i++)
+    {
+        float dx = ring[i].x - ring[0].x;
+        float dy = ring[i].y - ring[0].y;
+        if (dx * dx + dy * dy > farthest)
+        {
+            farthest = dx * dx + dy * dy;
+            kept[1] = i;
+        }
+    }
+
+    while (count < budget)
+    {
+        // Below three vertices there is no polygon yet, so any point beats the tolerance
+        float worst = count < 3 ? -1 : tolerance;
+        int worstIndex = -1;
+        int worstSlot = -1;
+        for (int k = 0; k < count; k++)
+        {
+            int from = kept[k];
+            int to = k + 1 < count ? kept[k + 1] : n;
+            for (int i = from + 1; i < to; i++)
+            {
+                float d = SegmentDistance(ring[i], ring[from], ring[to % n]);
+                if (d > worst)
+                {
+                    worst = d;
+                    worstIndex = i;
+                    worstSlot = k + 1;
+                }
+            }
+        }
+        if (worstIndex == -1)
+            break;
+
+        for (int k = count; k > worstSlot; k--)
+            kept[k] = kept[k - 1];
+        kept[worstSlot] = worstIndex;
+        count++;
+    }
+
+    for (int k = 0; k < count; k++)
+        out[k] = ring[kept[k]];
+    return count;
+}
+
+static bool IsOutlineSimple(const Vector2 *v, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i + 2; j < n; j++)
+        {
+            if (i == 0 && j == n - 1)
+                continue;
+            if (CheckCollisionLines(v[i], v[(i + 1) % n], v[j], v[(j + 1) % n], NULL))
+                return false;
+        }
+    }
+    return true;
+}
+
+static int ComparePoints(const void *a, const void *b)
+{
+    const Vector2 *p = a;
+    const Vector2 *q = b;
+    if (p->x != q->x)
+        return p->x < q->x ? -1 : 1;
+    return p->y < q->y ? -1 : p->y > q->y ? 1 : 0;
+}
+
+static float Turn(Vector2 o, Vector2 a, Vector2 b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Monotone chain, sorts points in place and writes the hull to hull, which needs room for n + 1 points
+static int BuildConvexHull(Vector2 *points, int n, Vector2 *hull)
+{
+    qsort(points, n, sizeof(Vector2), ComparePoints);
+
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        while (count >= 2 && Turn(hull[count - 2], hull[count - 1], points[i]) <= 0)
+            count--;
+        hull[count++] = points[i];
+    }
+    int lowerCount = count + 1;
+    for (int i = n - 2; i >= 0; i--)
+    {
+        while (count >= lowerCount && Turn(hull[count - 2], hull[count - 1], points[i]) <= 0)
+            count--;
+        hull[count++] = points[i];
+    }
+    return count - 1;
+}
+
+// Marks every pixel of the 4-connected area around seed that is marked from with to, returns its size
+static int FloodArea(unsigned char *mark, int width, int height, int seed, unsigned char from, unsigned char to, int *stack)
+{
+    int size = 0;
+    int top = 0;
+    mark[seed] = to;
+    stack[top++] = seed;
+    while (top > 0)
+    {
+        int i = stack[--top];
+        int x = i % width;
+        int y = i / width;
+        size++;
+
+        int neighbours[4] = {x > 0 ? i - 1 : -1, x < width - 1 ? i + 1 : -1, y > 0 ? i - width : -1, y < height - 1 ? i + width : -1};
+        for (int k = 0; k < 4; k++)
+        {
+            if (neighbours[k] != -1 && mark[neighbours[k]] == from)
+            {
+                mark[neighbours[k]] = to;
+                stack[top++] = neighbours[k];
+            }
+        }
+    }
+    return size;
+}
+
+static bool IsTracedPixel(const unsigned char *mark, int width, int height, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < width && y < height && mark[y * width + x] == 3;
+}
+
+// Follows the pixel edges around the area marked 3 clockwise from its top left corner, keeping only the corners
+static Vector2 *TraceOutline(const unsigned char *mark, int width, int height, int seed, int *cornerCount)
+{
+    static const int stepX[4] = {1, 0, -1, 0};
+    static const int stepY[4] = {0, 1, 0, -1};
+    // Pixels ahead of a corner on the left and right of each heading, as offsets from the corner
+    static const int leftX[4] = {0, 0, -1, -1};
+    static const int leftY[4] = {-1, 0, 0, -1};
+    static const int rightX[4] = {0, -1, -1, 0};
+    static const int rightY[4] = {0, 0, -1, -1};
+
+    int capacity = 256;
+    int count = 0;
+    Vector2 *corners = malloc(sizeof(Vector2) * capacity);
+    if (!corners)
+        return NULL;
+
+    int startX = seed % width;
+    int startY = seed / width;
+    int x = startX;
+    int y = startY;
+    int heading = 0;
+    corners[count++] = (Vector2){x, y};
+
+    while (true)
+    {
+        x += stepX[heading];
+        y += stepY[heading];
+        if (x == startX && y == startY)
+            break;
+
+        int turned = heading;
+        if (!IsTracedPixel(mark, width, height, x + rightX[heading], y + rightY[heading]))
+            turned = (heading + 1) % 4;
+        else if (IsTracedPixel(mark, width, height, x + leftX[heading], y + leftY[heading]))
+            turned = (heading + 3) % 4;
+
+        if (turned != heading)
+        {
+            if (count == capacity)
+            {
+                Vector2 *grown = realloc(corners, sizeof(Vector2) * capacity * 2);
+                if (!grown)
+                {
+                    free(corners);
+                    return NULL;
+                }
+                corners = grown;
+                capacity *= 2;
+            }
+            corners[count++] = (Vector2){x, y};
+        }
+        heading = turned;
+    }
+
+    *cornerCount = count;
+    return corners;
+}
+
+bool GenerateHitboxFromAlpha(Image image, int maxVertices, Polygon *hitbox)
+{
+    if (image.data == NULL || image.width <= 0 || image.height <= 0)
+        return false;
+
+    int width = image.width;
+    int height = image.height;
+    int pixelCount = width * height;
+    int budget = maxVertices < 3 ? 3 : maxVertices > MAX_POLYGON_VERTICES ? MAX_POLYGON_VERTICES : maxVertices;
+
+    Color *pixels = LoadImageColors(image);
+    unsigned char *mark = malloc(pixelCount);
+    int *stack = malloc(sizeof(int) * pixelCount);
+    if (!pixels || !mark || !stack)
+    {
+        if (pixels)
+            UnloadImageColors(pixels);
+        free(mark);
+        free(stack);
+        return false;
+    }
+
+    for (int i = 0; i < pixelCount; i++)
+        mark[i] = pixels[i].a >= HBED_ALPHA_THRESHOLD ? 1 : 0;
+    UnloadImageColors(pixels);
+
+    // A polygon holds one area, so stray specks and detached parts give way to the largest one
+    int seed = -1;
+    int largest = 0;
+    for (int i = 0; i < pixelCount; i++)
+    {
+        if (mark[i] != 1)
+            continue;
+        int size = FloodArea(mark, width, height, i, 1, 2, stack);
+        if (size > largest)
+        {
+            largest = size;
+            seed = i;
+        }
+    }
+
+    Vector2 *corners = NULL;
+    int cornerCount = 0;
+    if (seed != -1)
+    {
+        FloodArea(mark, width, height, seed, 2, 3, stack);
+        corners = TraceOutline(mark, width, height, seed, &cornerCount);
+    }
+    free(mark);
+    free(stack);
+    if (!corners)
+        return false;
+
+    for (int i = 0; i < cornerCount; i++)
+    {
+        corners[i].x -= width / 2.0f;
+        corners[i].y -= height / 2.0f;
+    }
+
+    Polygon generated = {0};
+    generated.count = SimplifyRing(corners, cornerCount, budget, HBED_SIMPLIFY_TOLERANCE, generated.vertices);
+
+    // Thin parts can make the simplified outline cross itself, which collisions can't use, so fall back to the hull
+    if (!IsOutlineSimple(generated.vertices, generated.count))
+    {
+        Vector2 *hull = malloc(sizeof(Vector2) * (cornerCount + 1));
+        if (!hull)
+        {
+            free(corners);
+            return false;
+        }
+        int hullCount = BuildConvexHull(corners, cornerCount, hull);
+        generated.count = SimplifyRing(hull, hullCount, budget, HBED_SIMPLIFY_TOLERANCE, generated.vertices);
+        free(hull);
+    }
+    free(corners);
+
+    generated.isClosed = true;
+    *hitbox = generated;
+    return true;
+}
+
+typedef struct HitboxJob
+{
+    char path[MAX_FILE_PATH];
+    int pinIndex;
+    Polygon hitbox;
+    bool isGenerated;
+} HitboxJob;
+
+typedef struct HitboxBatchWorker
+{
+    HitboxJob *jobs;
+    int jobCount;
+    int first;
+    int stride;
+} HitboxBatchWorker;
+
+static void RunHitboxBatch(HitboxBatchWorker *worker)
+{
+    for (int i = worker->first; i < worker->jobCount; i += worker->stride)
+    {
+        HitboxJob *job = &worker->jobs[i];
+        Image image = LoadImage(job->path);
+        job->isGenerated = GenerateHitboxFromAlpha(image, HBED_DEFAULT_VERTEX_BUDGET, &job->hitbox);
+        if (image.data != NULL)
+            UnloadImage(image);
+    }
+}
+
+#ifdef _WIN32
+static unsigned long __stdcall HitboxBatchMain(void *parameter)
+#else
+static void *HitboxBatchMain(void *parameter)
+#endif
+{
+    RunHitboxBatch(parameter);
+    return 0;
+}
+
+// File name of the Literal string node linked to the given pin, NULL when it comes from anywhere else
+static const char *FindLinkedTextureName(GraphContext *graph, int pinID)
+{
+    for (int k = 0; k < graph->linkCount; k++)
+    {
+        if (graph->links[k].inputPinID != pinID)
+            continue;
+
+        for (int n = 0; n < graph->nodeCount; n++)
+        {
+            if (graph->nodes[n].type == NODE_LITERAL_STRING && graph->nodes[n].outputPins[0] == graph->links[k].outputPinID)
+            {
+                int textPin = FindPinIndexByID(graph, graph->nodes[n].inputPins[0]);
+                return textPin != -1 ? graph->pins[textPin].textFieldValue : NULL;
+            }
+        }
+        return NULL;
+    }
+    return NULL;
+}
+
+int GenerateMissingHitboxes(GraphContext *graph, const char *projectPath, int workerCount, int *failedCount)
+{
+    *failedCount = 0;
+
+    int jobCount = 0;
+    HitboxJob *jobs = malloc(sizeof(HitboxJob) * (graph->nodeCount > 0 ? graph->nodeCount : 1));
+    if (!jobs)
+        return 0;
+
+    for (int n = 0; n < graph->nodeCount; n++)
+    {
+        if (graph->nodes[n].type != NODE_CREATE_SPRITE)
+            continue;
+
+        int hitboxPin = FindPinIndexByID(graph, graph->nodes[n].inputPins[5]);
+        if (hitboxPin == -1 || (graph->pins[hitboxPin].hitbox.isClosed && graph->pins[hitboxPin].hitbox.count > 2))
+            continue;
+
+        const char *fileName = FindLinkedTextureName(graph, graph->nodes[n].inputPins[1]);
+        if (!fileName)
+        {
+            (*failedCount)++;
+            continue;
+        }
+
+        HitboxJob *job = &jobs[jobCount++];
+        strmac(job->path, MAX_FILE_PATH, "%s%c%s", projectPath, PATH_SEPARATOR, fileName);
+        job->pinIndex = hitboxPin;
+        job->isGenerated = false;
+    }
+
+    if (workerCount > HBED_MAX_BATCH_WORKERS)
+        workerCount = HBED_MAX_BATCH_WORKERS;
+    if (workerCount > jobCount)
+        workerCount = jobCount;
+    if (workerCount < 1)
+        workerCount = 1;
+
+    // Decoding and tracing are the slow part and touch nothing shared, so each worker takes every workerCount-th texture
+    HitboxBatchWorker workers[HBED_MAX_BATCH_WORKERS];
+    ThreadHandle threads[HBED_MAX_BATCH_WORKERS];
+    bool isStarted[HBED_MAX_BATCH_WORKERS] = {0};
+
+    for (int w = 0; w < workerCount; w++)
+    {
+        workers[w] = (HitboxBatchWorker){jobs, jobCount, w, workerCount};
+        if (w == 0)
+            continue;
+#ifdef _WIN32
+        threads[w] = CreateThread(NULL, 0, HitboxBatchMain, &workers[w], 0, NULL);
+        isStarted[w] = threads[w] != NULL;
+#else
+        isStarted[w] = pthread_create(&threads[w], NULL, HitboxBatchMain, &workers[w]) == 0;
+#endif
+    }
+
+    RunHitboxBatch(&workers[0]);
+    for (int w = 1; w < workerCount; w++)
+    {
+        if (!isStarted[w])
+        {
+            RunHitboxBatch(&workers[w]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(threads[w], 0xFFFFFFFF);
+        CloseHandle(threads[w]);
+#else
+        pthread_join(threads[w], NULL);
+#endif
+    }
+
+    int generatedCount = 0;
+    for (int i = 0; i < jobCount; i++)
+    {
+        if (jobs[i].isGenerated)
+        {
+            graph->pins[jobs[i].pinIndex].hitbox = jobs[i].hitbox;
+            generatedCount++;
+        }
+        else
+        {
+            (*failedCount)++;
+        }
+    }
+
+    free(jobs);
+    return generatedCount;
+}
+
 bool UpdateHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal, GraphContext *graph, int hitboxEditingPinID)
 {
     if (IsKeyPressed(KEY_ESCAPE))
@@ -44,9 +501,12 @@ bool UpdateHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal, GraphCont
                     graph->pins[i].hitbox = hbEd->poly;
                 }
             }
-            UnloadTexture(hbEd->texture);
-            hbEd->texture.id = 0;
         }
+        // Every exit ends the session, an open polygon is dropped and the next one starts from the pin again
+        UnloadTexture(hbEd->texture);
+        hbEd->texture.id = 0;
+        UnloadImage(hbEd->image);
+        hbEd->image = (Image){0};
         return false;
     }
     if (IsKeyPressed(KEY_R))
@@ -54,6 +514,35 @@ bool UpdateHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal, GraphCont
         hbEd->poly.count = 0;
         hbEd->poly.isClosed = false;
     }
+    if (IsKeyPressed(KEY_UP) && hbEd->vertexBudget < MAX_VERTICES)
+    {
+        hbEd->vertexBudget++;
+    }
+    if (IsKeyPressed(KEY_DOWN) && hbEd->vertexBudget > 3)
+    {
+        hbEd->vertexBudget--;
+    }
+    if (IsKeyPressed(KEY_C))
+    {
+        hbEd->poly.fit = (hbEd->poly.fit + 1) % HITBOX_FIT_COUNT;
+    }
+    if (IsKeyPressed(KEY_G))
+    {
+        Polygon generated;
+        if (GenerateHitboxFromAlpha(hbEd->image, hbEd->vertexBudget, &generated))
+        {
+            for (int i = 0; i < generated.count; i++)
+            {
+                generated.vertices[i].x *= hbEd->scale.x;
+                generated.vertices[i].y *= hbEd->scale.y;
+            }
+            generated.fit = hbEd->poly.fit;
+            hbEd->lastActionType = HBED_LAST_ACTION_TYPE_GENERATE;
+            hbEd->lastActionPoly = hbEd->poly;
+            hbEd->poly = generated;
+            hbEd->draggingVerticeIndex = -1;
+        }
+    }
     if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_Z))
     {
         switch (hbEd->lastActionType)
@@ -77,6 +566,9 @@ bool UpdateHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal, GraphCont
             hbEd->poly.vertices[hbEd->lastActionVerticeIndex].x -= hbEd->lastActionVertice.x;
             hbEd->poly.vertices[hbEd->lastActionVerticeIndex].y -= hbEd->lastActionVertice.y;
             break;
+        case HBED_LAST_ACTION_TYPE_GENERATE:
+            hbEd->poly = hbEd->lastActionPoly;
+            break;
         }
 
         hbEd->lastActionType = HBED_LAST_ACTION_TYPE_NONE;
@@ -168,6 +660,48 @@ bool UpdateHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal, GraphCont
     return true;
 }
 
+const char *GetHitboxFitLabel(const Polygon *poly)
+{
+    static const char *fitNames[HITBOX_FIT_COUNT] = {"Automatic", "Polygon", "Circle", "Rectangle", "Capsule"};
+    static const char *typeNames[] = {"none", "rectangle", "circle", "polygon", "capsule"};
+
+    const char *fitName = poly->fit < HITBOX_FIT_COUNT ? fitNames[poly->fit] : fitNames[HITBOX_FIT_AUTO];
+    if (poly->fit != HITBOX_FIT_AUTO || !poly->isClosed)
+        return fitName;
+    return TextFormat("%s (%s)", fitName, typeNames[FitPolygonHitbox(poly).type]);
+}
+
+// Outlines the primitive the closed polygon will collide as, nothing when it collides as itself
+static void DrawFittedHitbox(HitboxEditorContext *hbEd)
+{
+    FittedHitbox fitted = FitPolygonHitbox(&hbEd->poly);
+    Vector2 anchor = {hbEd->position.x + fitted.offset.x, hbEd->position.y + fitted.offset.y};
+
+    switch (fitted.type)
+    {
+    case HITBOX_CIRCLE:
+        DrawCircleLines(anchor.x, anchor.y, fitted.radius, YELLOW);
+        break;
+    case HITBOX_RECT:
+        DrawRectangleLinesEx((Rectangle){anchor.x, anchor.y, fitted.rectSize.x, fitted.rectSize.y}, 2, YELLOW);
+        break;
+    case HITBOX_CAPSULE:
+    {
+        Vector2 start = {anchor.x - fitted.capsuleAxis.x, anchor.y - fitted.capsuleAxis.y};
+        Vector2 end = {anchor.x + fitted.capsuleAxis.x, anchor.y + fitted.capsuleAxis.y};
+        float length = sqrtf(fitted.capsuleAxis.x * fitted.capsuleAxis.x + fitted.capsuleAxis.y * fitted.capsuleAxis.y);
+        Vector2 side = length > 0 ? (Vector2){-fitted.capsuleAxis.y / length * fitted.radius, fitted.capsuleAxis.x / length * fitted.radius} : (Vector2){0, 0};
+        DrawCircleLines(start.x, start.y, fitted.radius, YELLOW);
+        DrawCircleLines(end.x, end.y, fitted.radius, YELLOW);
+        DrawLineEx((Vector2){start.x + side.x, start.y + side.y}, (Vector2){end.x + side.x, end.y + side.y}, 2, YELLOW);
+        DrawLineEx((Vector2){start.x - side.x, start.y - side.y}, (Vector2){end.x - side.x, end.y - side.y}, 2, YELLOW);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 void DrawHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal)
 {
     ClearBackground((Color){80, 0, 90, 100});
@@ -204,6 +738,8 @@ void DrawHitboxEditor(HitboxEditorContext *hbEd, Vector2 mouseLocal)
             hbEd->position.y + hbEd->poly.vertices[hbEd->poly.count - 1].y};
         DrawLineEx(last, first, 2, WHITE);
 
+        DrawFittedHitbox(hbEd);
+
         for (int i = 0; i < hbEd->poly.count; i++)
         {
             Vector2 vertice = {
@@ -9,11 +9,14 @@ typedef enum{
     HBED_LAST_ACTION_TYPE_NONE,
     HBED_LAST_ACTION_TYPE_ADD,
     HBED_LAST_ACTION_TYPE_DELETE,
-    HBED_LAST_ACTION_TYPE_MOVE
+    HBED_LAST_ACTION_TYPE_MOVE,
+    HBED_LAST_ACTION_TYPE_GENERATE
 }HitboxEditorLastActionType;
 
 typedef struct {
     Texture2D texture;
+    // Full resolution copy of the texture that hitboxes are generated from
+    Image image;
     Vector2 position;
     Polygon poly;
     int draggingVerticeIndex;
@@ -21,8 +24,15 @@ typedef struct {
     HitboxEditorLastActionType lastActionType;
     int lastActionVerticeIndex;
     Vector2 lastActionVertice;
+    Polygon lastActionPoly;
+    int vertexBudget;
 } HitboxEditorContext;
 
 HitboxEditorContext InitHitboxEditor(Texture2D tex, Vector2 pos, Vector2 scale);
 bool UpdateHitboxEditor(HitboxEditorContext *e, Vector2 mouseLocal, GraphContext *graph, int hitboxEditingPinID);
-void DrawHitboxEditor(HitboxEditorContext *e, Vector2 mouseLocal);
\ No newline at end of file
+void DrawHitboxEditor(HitboxEditorContext *e, Vector2 mouseLocal);
+
+const char *GetHitboxFitLabel(const Polygon *poly);
+
+bool GenerateHitboxFromAlpha(Image image, int maxVertices, Polygon *hitbox);
+int GenerateMissingHitboxes(GraphContext *graph, const char *projectPath, int workerCount, int *failedCount);
\ No newline at end of file
@@ -22,6 +22,8 @@ typedef enum
     NODE_EVENT_ON_BUTTON = 202,
     NODE_CREATE_CUSTOM_EVENT = 203,
     NODE_CALL_CUSTOM_EVENT = 204,
+    NODE_EVENT_ON_COLLISION_BEGIN = 205,
+    NODE_EVENT_ON_COLLISION_END = 206,
 
     NODE_GET_VARIABLE = 300,
     NODE_GET_SCREEN_WIDTH = 301,
@@ -29,10 +31,18 @@ typedef enum
     NODE_GET_MOUSE_X = 303,
     NODE_GET_MOUSE_Y = 304,
     NODE_GET_RANDOM_NUMBER = 305,
+    NODE_RAYCAST = 306,
+    NODE_OVERLAP_CIRCLE = 307,
+    NODE_OVERLAP_RECTANGLE = 308,
+    NODE_NEAREST_SPRITE = 309,
+    NODE_SPRITE_AT_POINT = 310,
+    NODE_GET_CAMERA = 311,
 
     NODE_SET_VARIABLE = 400,
     NODE_SET_BACKGROUND = 401,
     NODE_SET_FPS = 402,
+    NODE_SET_CAMERA = 403,
+    NODE_CAMERA_FOLLOW = 404,
 
     NODE_BRANCH = 500,
     NODE_LOOP = 501,
@@ -51,6 +61,10 @@ typedef enum
     NODE_MOVE_TO_SPRITE = 607,
     NODE_FORCE_SPRITE = 608,
     NODE_STOP_MOVEMENT_SPRITE = 609, //
+    NODE_SET_SPRITE_PHYSICS = 610,
+    NODE_SET_COLLISION_GROUP = 611,
+    NODE_SET_GROUPS_COLLIDE = 612,
+    NODE_SET_Z_ORDER = 613,
 
     NODE_DRAW_PROP_TEXTURE = 700,
     NODE_DRAW_PROP_RECTANGLE = 701,
@@ -125,7 +139,8 @@ typedef enum
     KEY_ACTION_PRESSED,
     KEY_ACTION_RELEASED,
     KEY_ACTION_DOWN,
-    KEY_ACTION_NOT_DOWN
+    KEY_ACTION_NOT_DOWN,
+    KEY_ACTION_COUNT
 } KeyAction;
 
 typedef struct InfoByType
@@ -164,6 +179,8 @@ static InfoByType NodeInfoByType[] = {
     {NODE_EVENT_ON_BUTTON, 2, 1, 160, 120, {148, 0, 0, 200}, false, {PIN_FIELD_KEY, PIN_DROPDOWN_KEY_ACTION}, {PIN_FLOW}, {"Key", "Action"}, {"Next"}},
     {NODE_CREATE_CUSTOM_EVENT, 0, 1, 240, 200, {148, 0, 0, 200}, false, {0}, {PIN_FLOW}, {"Prev"}, {"Next"}, true},      // not implemented
     {NODE_CALL_CUSTOM_EVENT, 0, 1, 240, 200, {148, 0, 0, 200}, false, {PIN_FLOW}, {PIN_FLOW}, {"Prev"}, {"Next"}, true}, // not implemented
+    {NODE_EVENT_ON_COLLISION_BEGIN, 2, 1, 190, 120, {148, 0, 0, 200}, false, {PIN_SPRITE_VARIABLE, PIN_SPRITE_VARIABLE}, {PIN_FLOW}, {"Sprite", "Other"}, {"Next"}},
+    {NODE_EVENT_ON_COLLISION_END, 2, 1, 190, 120, {148, 0, 0, 200}, false, {PIN_SPRITE_VARIABLE, PIN_SPRITE_VARIABLE}, {PIN_FLOW}, {"Sprite", "Other"}, {"Next"}},
 
     {NODE_GET_VARIABLE, 1, 1, 140, 70, {60, 100, 159, 200}, false, {PIN_VARIABLE}, {PIN_UNKNOWN_VALUE}, {"Variable"}, {"Get value"}},
     {NODE_GET_SCREEN_WIDTH, 0, 1, 250, 70, {60, 100, 159, 200}, false, {0}, {PIN_NUM}, {0}, {"Screen Width"}},
@@ -171,14 +188,22 @@ static InfoByType NodeInfoByType[] = {
     {NODE_GET_MOUSE_X, 0, 1, 200, 70, {60, 100, 159, 200}, false, {0}, {PIN_NUM}, {0}, {"Mouse X"}},
     {NODE_GET_MOUSE_Y, 0, 1, 200, 70, {60, 100, 159, 200}, false, {0}, {PIN_NUM}, {0}, {"Mouse Y"}},
     {NODE_GET_RANDOM_NUMBER, 0, 1, 260, 70, {60, 100, 159, 200}, false, {0}, {0}, {0}, {0}, true}, // not implemented
+    {NODE_RAYCAST, 6, 5, 200, 220, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW, PIN_BOOL, PIN_SPRITE, PIN_NUM, PIN_NUM}, {"Prev", "Start X", "Start Y", "End X", "End Y", "Group"}, {"Next", "Hit", "Sprite", "Hit X", "Hit Y"}},
+    {NODE_OVERLAP_CIRCLE, 5, 3, 200, 190, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW, PIN_SPRITE, PIN_NUM}, {"Prev", "X", "Y", "Radius", "Group"}, {"Next", "Sprite", "Count"}},
+    {NODE_OVERLAP_RECTANGLE, 6, 3, 200, 220, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW, PIN_SPRITE, PIN_NUM}, {"Prev", "X", "Y", "Width", "Height", "Group"}, {"Next", "Sprite", "Count"}},
+    {NODE_NEAREST_SPRITE, 5, 3, 200, 190, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW, PIN_SPRITE, PIN_NUM}, {"Prev", "X", "Y", "Radius", "Group"}, {"Next", "Sprite", "Distance"}},
+    {NODE_SPRITE_AT_POINT, 4, 2, 200, 160, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW, PIN_SPRITE}, {"Prev", "X", "Y", "Group"}, {"Next", "Sprite"}},
+    {NODE_GET_CAMERA, 0, 4, 200, 160, {60, 100, 159, 200}, false, {0}, {PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {0}, {"Camera X", "Camera Y", "Zoom", "Rotation"}},
 
     {NODE_SET_VARIABLE, 3, 2, 140, 130, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_VARIABLE, PIN_UNKNOWN_VALUE}, {PIN_FLOW, PIN_NONE}, {"Prev", "Variable", "Set value"}, {"Next", ""}}, // shouldn't have PIN_NONE
     {NODE_SET_BACKGROUND, 2, 1, 240, 100, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_COLOR}, {PIN_FLOW}, {"Prev", "Color"}, {"Next"}},
     {NODE_SET_FPS, 2, 1, 140, 100, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM}, {PIN_FLOW}, {"Prev", "FPS"}, {"Next"}},
+    {NODE_SET_CAMERA, 5, 1, 160, 190, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW}, {"Prev", "X", "Y", "Zoom", "Rotation"}, {"Next"}},
+    {NODE_CAMERA_FOLLOW, 2, 1, 160, 100, {60, 100, 159, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE}, {PIN_FLOW}, {"Prev", "Sprite"}, {"Next"}},
 
     {NODE_BRANCH, 2, 2, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW, PIN_BOOL}, {PIN_FLOW, PIN_FLOW}, {"Prev", "Condition"}, {"True", "False"}},
     {NODE_LOOP, 2, 2, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW, PIN_BOOL}, {PIN_FLOW, PIN_FLOW}, {"Prev", "Condition"}, {"Next", "Loop body"}},
-    {NODE_DELAY, 2, 1, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW, PIN_NUM}, {PIN_FLOW}, {"Prev", "Seconds"}, {"Next"}, true},     // not implemented
+    {NODE_DELAY, 2, 1, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW, PIN_NUM}, {PIN_FLOW}, {"Prev", "Seconds"}, {"Next"}},
     {NODE_FLIP_FLOP, 1, 2, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW}, {PIN_FLOW, PIN_FLOW}, {"Prev"}, {"Flip", "Flop"}, true},   // not implemented
     {NODE_BREAK, 1, 0, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW}, {0}, {"Prev"}, {0}, true},                                     // not implemented
     {NODE_RETURN, 2, 0, 130, 100, {90, 90, 90, 200}, false, {PIN_FLOW, PIN_UNKNOWN_VALUE}, {0}, {"Prev", "Return value"}, {0}, true}, // not implemented
@@ -190,8 +215,12 @@ static InfoByType NodeInfoByType[] = {
     {NODE_SET_SPRITE_ROTATION, 3, 1, 180, 130, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Rotation"}, {"Next"}},
     {NODE_SET_SPRITE_TEXTURE, 3, 1, 180, 130, {0, 0, 0, 255}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_STRING}, {PIN_FLOW}, {"Prev", "Sprite", "Texture name"}, {"Next"}},
     {NODE_SET_SPRITE_SIZE, 4, 1, 170, 160, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Width", "Height"}, {"Next"}},
-    {NODE_MOVE_TO_SPRITE, 0, 0, 260, 36, {0, 0, 0, 255}, false, {0}, {0}, {0}, {0}, true}, // not implemented
+    {NODE_MOVE_TO_SPRITE, 5, 1, 160, 190, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "X", "Y", "Seconds"}, {"Next"}},
     {NODE_FORCE_SPRITE, 5, 1, 160, 190, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM, PIN_NUM, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Pixels / second", "Angle", "Time"}, {"Next"}},
+    {NODE_SET_SPRITE_PHYSICS, 4, 1, 170, 160, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Gravity", "Damping"}, {"Next"}},
+    {NODE_SET_COLLISION_GROUP, 3, 1, 170, 130, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Group"}, {"Next"}},
+    {NODE_SET_GROUPS_COLLIDE, 4, 1, 170, 160, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_BOOL}, {PIN_FLOW}, {"Prev", "Group", "Other group", "Collide"}, {"Next"}},
+    {NODE_SET_Z_ORDER, 3, 1, 170, 130, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_SPRITE_VARIABLE, PIN_NUM}, {PIN_FLOW}, {"Prev", "Sprite", "Z order"}, {"Next"}},
 
     {NODE_DRAW_PROP_TEXTURE, 0, 0, 260, 36, {0, 0, 0, 255}, false, {0}, {0}, {0}, {0}, true},                                                                                                                                                   // not implemented
     {NODE_DRAW_PROP_RECTANGLE, 7, 2, 230, 250, {40, 110, 70, 200}, false, {PIN_FLOW, PIN_NUM, PIN_NUM, PIN_NUM, PIN_NUM, PIN_COLOR, PIN_NUM}, {PIN_FLOW, PIN_NONE}, {"Prev", "Pos X", "Pos Y", "Width", "Height", "Color", "Layer"}, {"Next"}}, // shouldn't have PIN_NONE
@@ -235,86 +264,114 @@ static inline int NodeTypeToIndex(NodeType type)
         return 8;
     case NODE_CALL_CUSTOM_EVENT:
         return 9;
+    case NODE_EVENT_ON_COLLISION_BEGIN:
+        return 10;
+    case NODE_EVENT_ON_COLLISION_END:
+        return 11;
 
     case NODE_GET_VARIABLE:
-        return 10;
+        return 12;
     case NODE_GET_SCREEN_WIDTH:
-        return 11;
+        return 13;
     case NODE_GET_SCREEN_HEIGHT:
-        return 12;
+        return 14;
     case NODE_GET_MOUSE_X:
-        return 13;
+        return 15;
     case NODE_GET_MOUSE_Y:
-        return 14;
+        return 16;
     case NODE_GET_RANDOM_NUMBER:
-        return 15;
+        return 17;
+    case NODE_RAYCAST:
+        return 18;
+    case NODE_OVERLAP_CIRCLE:
+        return 19;
+    case NODE_OVERLAP_RECTANGLE:
+        return 20;
+    case NODE_NEAREST_SPRITE:
+        return 21;
+    case NODE_SPRITE_AT_POINT:
+        return 22;
+    case NODE_GET_CAMERA:
+        return 23;
 
     case NODE_SET_VARIABLE:
-        return 16;
+        return 24;
     case NODE_SET_BACKGROUND:
-        return 17;
+        return 25;
     case NODE_SET_FPS:
-        return 18;
+        return 26;
+    case NODE_SET_CAMERA:
+        return 27;
+    case NODE_CAMERA_FOLLOW:
+        return 28;
 
     case NODE_BRANCH:
-        return 19;
+        return 29;
     case NODE_LOOP:
-        return 20;
+        return 30;
     case NODE_DELAY:
-        return 21;
+        return 31;
     case NODE_FLIP_FLOP:
-        return 22;
+        return 32;
     case NODE_BREAK:
-        return 23;
+        return 33;
     case NODE_RETURN:
-        return 24;
+        return 34;
 
     case NODE_CREATE_SPRITE:
-        return 25;
+        return 35;
     case NODE_SPAWN_SPRITE:
-        return 26;
+        return 36;
     case NODE_DESTROY_SPRITE:
-        return 27;
+        return 37;
     case NODE_SET_SPRITE_POSITION:
-        return 28;
+        return 38;
     case NODE_SET_SPRITE_ROTATION:
-        return 29;
+        return 39;
     case NODE_SET_SPRITE_TEXTURE:
-        return 30;
+        return 40;
     case NODE_SET_SPRITE_SIZE:
-        return 31;
+        return 41;
     case NODE_MOVE_TO_SPRITE:
-        return 32;
+        return 42;
     case NODE_FORCE_SPRITE:
-        return 33;
+        return 43;
+    case NODE_SET_SPRITE_PHYSICS:
+        return 44;
+    case NODE_SET_COLLISION_GROUP:
+        return 45;
+    case NODE_SET_GROUPS_COLLIDE:
+        return 46;
+    case NODE_SET_Z_ORDER:
+        return 47;
 
     case NODE_DRAW_PROP_TEXTURE:
-        return 34;
+        return 48;
     case NODE_DRAW_PROP_RECTANGLE:
-        return 35;
+        return 49;
     case NODE_DRAW_PROP_CIRCLE:
-        return 36;
+        return 50;
 
     case NODE_COMPARISON:
-        return 37;
+        return 51;
     case NODE_GATE:
-        return 38;
+        return 52;
     case NODE_ARITHMETIC:
-        return 39;
+        return 53;
 
     case NODE_PRINT_TO_LOG:
-        return 40;
+        return 54;
     case NODE_DRAW_DEBUG_LINE:
-        return 41;
+        return 55;
 
     case NODE_LITERAL_NUMBER:
-        return 42;
+        return 56;
     case NODE_LITERAL_STRING:
-        return 43;
+        return 57;
     case NODE_LITERAL_BOOL:
-        return 44;
+        return 58;
     case NODE_LITERAL_COLOR:
-        return 45;
+        return 59;
 
     default:
         return -1;
@@ -500,6 +557,10 @@ static inline const char *NodeTypeToString(NodeType type)
         return "Create Event";
     case NODE_CALL_CUSTOM_EVENT:
         return "Call Event";
+    case NODE_EVENT_ON_COLLISION_BEGIN:
+        return "On Collision Begin";
+    case NODE_EVENT_ON_COLLISION_END:
+        return "On Collision End";
 
     case NODE_GET_VARIABLE:
         return "Get var";
@@ -513,6 +574,18 @@ static inline const char *NodeTypeToString(NodeType type)
         return "Get mouse Y";
     case NODE_GET_RANDOM_NUMBER:
         return "Get random num";
+    case NODE_RAYCAST:
+        return "Raycast";
+    case NODE_OVERLAP_CIRCLE:
+        return "Overlap circle";
+    case NODE_OVERLAP_RECTANGLE:
+        return "Overlap rectangle";
+    case NODE_NEAREST_SPRITE:
+        return "Nearest sprite";
+    case NODE_SPRITE_AT_POINT:
+        return "Sprite at point";
+    case NODE_GET_CAMERA:
+        return "Get camera";
 
     case NODE_SET_VARIABLE:
         return "Set var";
@@ -520,6 +593,10 @@ static inline const char *NodeTypeToString(NodeType type)
         return "Set Background";
     case NODE_SET_FPS:
         return "Set FPS";
+    case NODE_SET_CAMERA:
+        return "Set camera";
+    case NODE_CAMERA_FOLLOW:
+        return "Camera follow";
 
     case NODE_BRANCH:
         return "Branch";
@@ -552,6 +629,14 @@ static inline const char *NodeTypeToString(NodeType type)
         return "Move To";
     case NODE_FORCE_SPRITE:
         return "Force";
+    case NODE_SET_SPRITE_PHYSICS:
+        return "Set physics";
+    case NODE_SET_COLLISION_GROUP:
+        return "Set group";
+    case NODE_SET_GROUPS_COLLIDE:
+        return "Groups collide";
+    case NODE_SET_Z_ORDER:
+        return "Set Z order";
 
     case NODE_DRAW_PROP_TEXTURE:
         return "Prop Texture";
@@ -610,6 +695,10 @@ static inline NodeType StringToNodeType(const char strType[])
         return NODE_CREATE_CUSTOM_EVENT;
     if (strcmp(strType, "Call Custom Event") == 0)
         return NODE_CALL_CUSTOM_EVENT;
+    if (strcmp(strType, "On Collision Begin") == 0)
+        return NODE_EVENT_ON_COLLISION_BEGIN;
+    if (strcmp(strType, "On Collision End") == 0)
+        return NODE_EVENT_ON_COLLISION_END;
 
     if (strcmp(strType, "Get variable") == 0)
         return NODE_GET_VARIABLE;
@@ -623,6 +712,18 @@ static inline NodeType StringToNodeType(const char strType[])
         return NODE_GET_MOUSE_Y;
     if (strcmp(strType, "Get Random Number") == 0)
         return NODE_GET_RANDOM_NUMBER;
+    if (strcmp(strType, "Raycast") == 0)
+        return NODE_RAYCAST;
+    if (strcmp(strType, "Overlap Circle") == 0)
+        return NODE_OVERLAP_CIRCLE;
+    if (strcmp(strType, "Overlap Rectangle") == 0)
+        return NODE_OVERLAP_RECTANGLE;
+    if (strcmp(strType, "Nearest Sprite") == 0)
+        return NODE_NEAREST_SPRITE;
+    if (strcmp(strType, "Sprite At Point") == 0)
+        return NODE_SPRITE_AT_POINT;
+    if (strcmp(strType, "Get Camera") == 0)
+        return NODE_GET_CAMERA;
 
     if (strcmp(strType, "Set variable") == 0)
         return NODE_SET_VARIABLE;
@@ -630,6 +731,10 @@ static inline NodeType StringToNodeType(const char strType[])
         return NODE_SET_BACKGROUND;
     if (strcmp(strType, "Set FPS") == 0)
         return NODE_SET_FPS;
+    if (strcmp(strType, "Set Camera") == 0)
+        return NODE_SET_CAMERA;
+    if (strcmp(strType, "Camera Follow") == 0)
+        return NODE_CAMERA_FOLLOW;
 
     if (strcmp(strType, "Branch") == 0)
         return NODE_BRANCH;
@@ -662,6 +767,14 @@ static inline NodeType StringToNodeType(const char strType[])
         return NODE_MOVE_TO_SPRITE;
     if (strcmp(strType, "Force") == 0)
         return NODE_FORCE_SPRITE;
+    if (strcmp(strType, "Set Sprite Physics") == 0)
+        return NODE_SET_SPRITE_PHYSICS;
+    if (strcmp(strType, "Set Collision Group") == 0)
+        return NODE_SET_COLLISION_GROUP;
+    if (strcmp(strType, "Set Groups Collide") == 0)
+        return NODE_SET_GROUPS_COLLIDE;
+    if (strcmp(strType, "Set Z Order") == 0)
+        return NODE_SET_Z_ORDER;
 
     if (strcmp(strType, "Draw Prop Texture") == 0)
         return NODE_DRAW_PROP_TEXTURE;
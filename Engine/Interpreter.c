@@ -1,7 +1,9 @@
 #include "Interpreter.h"
 #include "raymath.h"
+#include "rlgl.h"
+#include "Threads.h"
 
-#define MAX_FORCES 99
+#define LATENT_WAIT_POOL_CHUNK 256
 
 InterpreterContext InitInterpreterContext()
 {
@@ -9,9 +11,7 @@ InterpreterContext InitInterpreterContext()
 
     intp.valueCount = 0;
     intp.varCount = 0;
-    intp.onButtonNodeIndexesCount = 0;
     intp.componentCount = 0;
-    intp.forcesCount = 0;
     intp.loopNodeIndex = -1;
 
     intp.isFirstFrame = true;
@@ -27,100 +27,526 @@ InterpreterContext InitInterpreterContext()
 
     intp.fps = 60;
 
+    intp.physicsWorkerCount = 1;
+
+    intp.textureBudgetMB = TEXTURE_CACHE_DEFAULT_BUDGET_MB;
+
+    for (int i = 0; i < MAX_COLLISION_GROUPS; i++)
+    {
+        intp.collisionMasks[i] = 0xFFFFFFFFu;
+    }
+
     intp.shouldShowHitboxes = false;
 
     intp.isPaused = false;
 
-    intp.cameraOffset = (Vector2){0, 0};
+    intp.camera.zoom = 1;
+    intp.camera.followComponent = -1;
 
     return intp;
 }
 
-void FreeRuntimeGraphContext(RuntimeGraphContext *rg)
+#define BUILD_ARENA_BLOCK_SIZE (64 * 1024)
+#define BUILD_ARENA_ALIGNMENT 16
+
+static size_t AlignArenaSize(size_t size)
 {
-    if (!rg) return;
+    return (size + BUILD_ARENA_ALIGNMENT - 1) & ~(size_t)(BUILD_ARENA_ALIGNMENT - 1);
+}
+
+// Returns zeroed memory that lives until FreeBuildArena; requests larger than a quarter block get a block of their own
+static void *ArenaAlloc(BuildArena *arena, size_t size)
+{
+    size = AlignArenaSize(size ? size : 1);
 
-    if (rg->nodes)
+    BuildArenaBlock *block = arena->blocks;
+    if (!block || block->used + size > block->capacity)
     {
-        for (int i = 0; i < rg->nodeCount; i++)
-        {
-            RuntimeNode *node = &rg->nodes[i];
+        bool isDedicated = size > BUILD_ARENA_BLOCK_SIZE / 4;
+        size_t capacity = isDedicated ? size : BUILD_ARENA_BLOCK_SIZE;
+        size_t header = AlignArenaSize(sizeof(BuildArenaBlock));
 
-            for (int j = 0; j < node->inputCount; j++)
-            {
-                if (node->inputPins[j])
-                {
-                    free(node->inputPins[j]);
-                    node->inputPins[j] = NULL;
-                }
-            }
+        block = calloc(1, header + capacity);
+        if (!block)
+            return NULL;
 
-            for (int j = 0; j < node->outputCount; j++)
-            {
-                if (node->outputPins[j])
-                {
-                    free(node->outputPins[j]);
-                    node->outputPins[j] = NULL;
-                }
-            }
+        block->data = (unsigned char *)block + header;
+        block->capacity = capacity;
+        if (isDedicated && arena->blocks)
+        {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+        else
+        {
+            block->next = arena->blocks;
+            arena->blocks = block;
         }
 
-        free(rg->nodes);
-        rg->nodes = NULL;
+        arena->bytesReserved += header + capacity;
+        arena->blockCount++;
+    }
+
+    void *memory = block->data + block->used;
+    block->used += size;
+    arena->bytesUsed += size;
+    arena->allocationCount++;
+    return memory;
+}
+
+static char *ArenaString(BuildArena *arena, const char *text, size_t maxSize)
+{
+    size_t length = 0;
+    while (length + 1 < maxSize && text[length])
+    {
+        length++;
+    }
+
+    char *copy = ArenaAlloc(arena, length + 1);
+    if (copy)
+    {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
     }
+    return copy;
+}
 
-    if (rg->pins)
+static void FreeBuildArena(BuildArena *arena)
+{
+    BuildArenaBlock *block = arena->blocks;
+    while (block)
     {
-        free(rg->pins);
-        rg->pins = NULL;
+        BuildArenaBlock *next = block->next;
+        free(block);
+        block = next;
     }
+    *arena = (BuildArena){0};
+}
+
+void FreeRuntimeGraphContext(RuntimeGraphContext *rg)
+{
+    if (!rg) return;
+
+    // Nodes, pins, entry points and detached code live in the interpreter's build arena, only the growable bytecode is owned here
+    rg->nodes = NULL;
+    rg->nodeInfos = NULL;
+    rg->pins = NULL;
+    rg->pinInfos = NULL;
+    rg->entryPoints = NULL;
+    rg->pureCode = NULL;
+    rg->pureCount = 0;
+    rg->valueProducers = NULL;
+
+    free(rg->code);
+    rg->code = NULL;
+
+    rg->compiledEvents = NULL;
 
     rg->nodeCount = 0;
     rg->pinCount = 0;
+    rg->codeCount = 0;
+    rg->codeCapacity = 0;
 }
 
-void FreeInterpreterContext(InterpreterContext *intp)
+static bool AllocValueStore(BuildArena *arena, ValueStore *store, int capacity)
 {
-    if (!intp)
-        return;
+    store->types = ArenaAlloc(arena, sizeof(ValueType) * capacity);
+    store->numbers = ArenaAlloc(arena, sizeof(float) * capacity);
+    store->booleans = ArenaAlloc(arena, sizeof(bool) * capacity);
+    store->strings = ArenaAlloc(arena, sizeof(char *) * capacity);
+    store->colors = ArenaAlloc(arena, sizeof(Color) * capacity);
+    store->componentIndexes = ArenaAlloc(arena, sizeof(int) * capacity);
+    store->names = ArenaAlloc(arena, sizeof(char *) * capacity);
+    store->isVariable = ArenaAlloc(arena, sizeof(bool) * capacity);
+    store->versions = ArenaAlloc(arena, sizeof(unsigned int) * capacity);
+
+    if (!store->types || !store->numbers || !store->booleans || !store->strings || !store->colors || !store->componentIndexes || !store->names || !store->isVariable || !store->versions)
+        return false;
+
+    for (int i = 0; i < capacity; i++)
+    {
+        store->versions[i] = 1;
+    }
+
+    return true;
+}
+
+static bool AllocRigidBodies(BuildArena *arena, RigidBodies *bodies, int capacity, int nodeCount)
+{
+    bodies->velocityX = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->velocityY = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->gravity = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->damping = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->pushX = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->pushY = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->pushCount = ArenaAlloc(arena, sizeof(int) * capacity);
+    bodies->stepX = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->stepY = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->previousX = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->previousY = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->isBlocked = ArenaAlloc(arena, sizeof(bool) * capacity);
+    bodies->impactTime = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->touchTime = ArenaAlloc(arena, sizeof(float) * capacity);
+    bodies->forceByNode = ArenaAlloc(arena, sizeof(LatentWait *) * (nodeCount + 1));
+    bodies->nodeCount = nodeCount;
+
+    return bodies->velocityX && bodies->velocityY && bodies->gravity && bodies->damping && bodies->pushX && bodies->pushY && bodies->pushCount && bodies->stepX && bodies->stepY && bodies->previousX && bodies->previousY && bodies->isBlocked && bodies->impactTime && bodies->touchTime && bodies->forceByNode;
+}
+
+#define PHYSICS_JOB_CHUNK 64
+// Below this many items a phase runs on the game thread, waking the workers would cost more than it saves
+#define PHYSICS_PARALLEL_MIN_ITEMS 512
+
+typedef void (*PhysicsJob)(InterpreterContext *intp, int worker, int first, int last);
+
+typedef struct PhysicsRange
+{
+    int next;
+    int end;
+} PhysicsRange;
+
+struct PhysicsPool
+{
+    // Threads including the game thread, which is worker 0
+    int workerCount;
+    ThreadHandle threads[MAX_PHYSICS_WORKERS];
+    int startedCount;
+
+    ThreadLock lock;
+    ThreadCondition wake;
+    ThreadCondition done;
+
+    // Current phase: every worker starts on its own share of the items and steals from the others once it runs dry
+    PhysicsJob job;
+    InterpreterContext *intp;
+    PhysicsRange ranges[MAX_PHYSICS_WORKERS];
+    unsigned int generation;
+    int busyCount;
+    bool shouldQuit;
+
+    // Grid query buffers of workers 1 and up, the game thread uses the grid's own
+    CollisionScratch scratch[MAX_PHYSICS_WORKERS];
+    int scratchCapacity;
+};
+
+typedef struct PhysicsWorkerStart
+{
+    struct PhysicsPool *pool;
+    int worker;
+} PhysicsWorkerStart;
+
+static void LockPool(struct PhysicsPool *pool)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&pool->lock);
+#else
+    pthread_mutex_lock(&pool->lock);
+#endif
+}
+
+static void UnlockPool(struct PhysicsPool *pool)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&pool->lock);
+#else
+    pthread_mutex_unlock(&pool->lock);
+#endif
+}
+
+static void WaitPool(struct PhysicsPool *pool, ThreadCondition *condition)
+{
+#ifdef _WIN32
+    SleepConditionVariableSRW(condition, &pool->lock, 0xFFFFFFFF, 0);
+#else
+    pthread_cond_wait(condition, &pool->lock);
+#endif
+}
+
+static void WakePool(ThreadCondition *condition)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(condition);
+#else
+    pthread_cond_broadcast(condition);
+#endif
+}
+
+// Takes the next chunk of the worker's own range, or steals the last chunk of whichever range has the most left
+static bool ClaimPhysicsChunk(struct PhysicsPool *pool, int worker, int *first, int *last)
+{
+    LockPool(pool);
+
+    PhysicsRange *own = &pool->ranges[worker];
+    if (own->next < own->end)
+    {
+        *first = own->next;
+        *last = own->next + PHYSICS_JOB_CHUNK < own->end ? own->next + PHYSICS_JOB_CHUNK : own->end;
+        own->next = *last;
+        UnlockPool(pool);
+        return true;
+    }
 
-    if (intp->values)
+    int victim = -1;
+    int mostLeft = 0;
+    for (int w = 0; w < pool->workerCount; w++)
     {
-        for (int i = 0; i < intp->valueCount; i++)
+        int left = pool->ranges[w].end - pool->ranges[w].next;
+        if (left > mostLeft)
         {
-            if (intp->values[i].type == VAL_STRING && intp->values[i].string)
-            {
-                free((void *)intp->values[i].string);
-            }
+            mostLeft = left;
+            victim = w;
         }
-        free(intp->values);
     }
 
-    free(intp->onButtonNodeIndexes);
+    if (victim != -1)
+    {
+        PhysicsRange *range = &pool->ranges[victim];
+        *last = range->end;
+        *first = range->end - PHYSICS_JOB_CHUNK > range->next ? range->end - PHYSICS_JOB_CHUNK : range->next;
+        range->end = *first;
+    }
 
-    free(intp->forces);
+    UnlockPool(pool);
+    return victim != -1;
+}
 
-    if (intp->components)
+static void RunPhysicsChunks(struct PhysicsPool *pool, int worker)
+{
+    int first;
+    int last;
+    while (ClaimPhysicsChunk(pool, worker, &first, &last))
     {
-        for (int i = 0; i < intp->componentCount; i++)
+        pool->job(pool->intp, worker, first, last);
+    }
+}
+
+static void RunPhysicsWorker(struct PhysicsPool *pool, int worker)
+{
+    unsigned int seen = 0;
+
+    LockPool(pool);
+    while (true)
+    {
+        while (!pool->shouldQuit && pool->generation == seen)
         {
-            if (intp->components[i].isSprite && intp->components[i].sprite.texture.id)
-            {
-                UnloadTexture(intp->components[i].sprite.texture);
-            }
+            WaitPool(pool, &pool->wake);
         }
-        free(intp->components);
+        if (pool->shouldQuit)
+            break;
+        seen = pool->generation;
+        UnlockPool(pool);
+
+        RunPhysicsChunks(pool, worker);
+
+        LockPool(pool);
+        if (--pool->busyCount == 0)
+            WakePool(&pool->done);
     }
+    UnlockPool(pool);
+}
 
-    free(intp->varIndexes);
+#ifdef _WIN32
+static unsigned long __stdcall PhysicsWorkerMain(void *parameter)
+#else
+static void *PhysicsWorkerMain(void *parameter)
+#endif
+{
+    PhysicsWorkerStart *start = parameter;
+    struct PhysicsPool *pool = start->pool;
+    int worker = start->worker;
+    free(start);
 
-    char *projectPath = intp->projectPath;
-    *intp = InitInterpreterContext();
-    intp->projectPath = projectPath;
+    RunPhysicsWorker(pool, worker);
+    return 0;
+}
+
+static void StopPhysicsPool(struct PhysicsPool *pool)
+{
+    if (!pool)
+        return;
+
+    LockPool(pool);
+    pool->shouldQuit = true;
+    WakePool(&pool->wake);
+    UnlockPool(pool);
+
+    for (int i = 1; i <= pool->startedCount; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], 0xFFFFFFFF);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+#ifndef _WIN32
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+#endif
+
+    for (int i = 0; i < MAX_PHYSICS_WORKERS; i++)
+    {
+        free(pool->scratch[i].candidates);
+        free(pool->scratch[i].visitStamp);
+    }
+    free(pool);
+}
+
+static struct PhysicsPool *StartPhysicsPool(int workerCount)
+{
+    struct PhysicsPool *pool = calloc(1, sizeof(struct PhysicsPool));
+    if (!pool)
+        return NULL;
+
+#ifdef _WIN32
+    InitializeSRWLock(&pool->lock);
+    InitializeConditionVariable(&pool->wake);
+    InitializeConditionVariable(&pool->done);
+#else
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+#endif
+
+    pool->workerCount = workerCount;
+    for (int i = 1; i < workerCount; i++)
+    {
+        PhysicsWorkerStart *start = malloc(sizeof(PhysicsWorkerStart));
+        if (!start)
+            break;
+        start->pool = pool;
+        start->worker = i;
+
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, PhysicsWorkerMain, start, 0, NULL);
+        bool isStarted = pool->threads[i] != NULL;
+#else
+        bool isStarted = pthread_create(&pool->threads[i], NULL, PhysicsWorkerMain, start) == 0;
+#endif
+        if (!isStarted)
+        {
+            free(start);
+            break;
+        }
+        pool->startedCount = i;
+    }
+
+    if (pool->startedCount != workerCount - 1)
+    {
+        StopPhysicsPool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+// Runs job over items 0 .. itemCount - 1 and returns once every item is done. Jobs only write data of their own items
+static void RunPhysicsJob(InterpreterContext *intp, PhysicsJob job, int itemCount)
+{
+    struct PhysicsPool *pool = intp->physicsPool;
+    if (!pool || itemCount < PHYSICS_PARALLEL_MIN_ITEMS)
+    {
+        if (itemCount > 0)
+            job(intp, 0, 0, itemCount);
+        return;
+    }
+
+    LockPool(pool);
+    pool->job = job;
+    pool->intp = intp;
+    for (int w = 0; w < pool->workerCount; w++)
+    {
+        pool->ranges[w].next = (int)((long long)itemCount * w / pool->workerCount);
+        pool->ranges[w].end = (int)((long long)itemCount * (w + 1) / pool->workerCount);
+    }
+    pool->busyCount = pool->workerCount - 1;
+    pool->generation++;
+    WakePool(&pool->wake);
+    UnlockPool(pool);
+
+    RunPhysicsChunks(pool, 0);
+
+    LockPool(pool);
+    while (pool->busyCount > 0)
+    {
+        WaitPool(pool, &pool->done);
+    }
+    UnlockPool(pool);
+}
+
+// The pair lists outlive a hot patch, so they are kept out of the arena
+static void FreeContactCache(ContactCache *contacts)
+{
+    free(contacts->touching.pairs);
+    free(contacts->ended.pairs);
+    free(contacts->previous.pairs);
+    for (int w = 0; w < MAX_PHYSICS_WORKERS; w++)
+    {
+        free(contacts->found[w].pairs);
+    }
+    *contacts = (ContactCache){0};
+}
+
+// Kept out of the arena too, a hot patch hands the atlas over when it still holds every file
+static void FreeTextureAtlas(TextureAtlas *atlas)
+{
+    for (int i = 0; i < atlas->pageCount; i++)
+    {
+        if (atlas->pages[i].id)
+            UnloadTexture(atlas->pages[i]);
+    }
+    for (int i = 0; i < atlas->entryCount; i++)
+    {
+        free(atlas->entries[i].fileName);
+    }
+    free(atlas->pages);
+    free(atlas->entries);
+    *atlas = (TextureAtlas){0};
+}
+
+// Sprites only borrow from the cache, every texture it loaded goes with it
+static void FreeTextureCache(TextureCache *cache)
+{
+    for (int i = 0; i < cache->entryCount; i++)
+    {
+        if (cache->entries[i].texture.id)
+            UnloadTexture(cache->entries[i].texture);
+    }
+    for (int i = 0; i < cache->nameCapacity; i++)
+    {
+        if (cache->names[i].entry != -1)
+            free(cache->names[i].fileName);
+    }
+    free(cache->entries);
+    free(cache->names);
+    *cache = (TextureCache){0};
+}
+
+void FreeInterpreterContext(InterpreterContext *intp)
+{
+    if (!intp)
+        return;
 
     if(intp->runtimeGraph){
         FreeRuntimeGraphContext(intp->runtimeGraph);
     }
+
+    StopPhysicsPool(intp->physicsPool);
+    FreeContactCache(&intp->contacts);
+    FreeTextureAtlas(&intp->atlas);
+    FreeTextureCache(&intp->textureCache);
+    free(intp->renderQueue.items);
+    free(intp->renderQueue.sorted);
+    free(intp->debugLines.lines);
+
+    // Values, names, strings, components, rigid bodies and the runtime nodes and pins all go with the arena
+    FreeBuildArena(&intp->arena);
+
+    char *projectPath = intp->projectPath;
+    *intp = InitInterpreterContext();
+    intp->projectPath = projectPath;
 }
 
 char *ValueTypeToString(ValueType type)
@@ -167,7 +593,12 @@ char *ValueToString(Value value)
         strmac(temp, MAX_LOG_MESSAGE_SIZE, "%d %d %d %d", value.color.r, value.color.g, value.color.b, value.color.a);
         break;
     case VAL_SPRITE:
-        strmac(temp, MAX_LOG_MESSAGE_SIZE, "%s, PosX: %.0f, PosY: %.0f, Rotation: %.2f", value.sprite.isVisible ? "Visible" : "Not visible", value.sprite.position.x, value.sprite.position.y, value.sprite.rotation);
+        if (!value.component)
+        {
+            strmac(temp, MAX_LOG_MESSAGE_SIZE, "Not created");
+            break;
+        }
+        strmac(temp, MAX_LOG_MESSAGE_SIZE, "%s, PosX: %.0f, PosY: %.0f, Rotation: %.2f", value.component->isVisible ? "Visible" : "Not visible", value.component->sprite.position.x, value.component->sprite.position.y, value.component->sprite.rotation);
         break;
     default:
         strmac(temp, MAX_LOG_MESSAGE_SIZE, "Error");
@@ -175,6 +606,41 @@ char *ValueToString(Value value)
     return temp;
 }
 
+Value GetValue(InterpreterContext *intp, int valueIndex)
+{
+    Value value = {.type = VAL_NULL, .componentIndex = -1};
+    if (valueIndex < 0 || valueIndex >= intp->valueCount)
+        return value;
+
+    ValueStore *values = &intp->values;
+    value.type = values->types[valueIndex];
+    value.componentIndex = values->componentIndexes[valueIndex];
+
+    switch (value.type)
+    {
+    case VAL_NUMBER:
+        value.number = values->numbers[valueIndex];
+        break;
+    case VAL_STRING:
+        value.string = values->strings[valueIndex];
+        break;
+    case VAL_BOOL:
+        value.boolean = values->booleans[valueIndex];
+        break;
+    case VAL_COLOR:
+        value.color = values->colors[valueIndex];
+        break;
+    case VAL_SPRITE:
+        if (value.componentIndex >= 0 && value.componentIndex < intp->componentCount)
+            value.component = &intp->components[value.componentIndex];
+        break;
+    default:
+        break;
+    }
+
+    return value;
+}
+
 void AddToLogFromInterpreter(InterpreterContext *intp, Value message, int level)
 {
     if (intp->logMessageCount >= MAX_LOG_MESSAGES)
@@ -201,1605 +667,6204 @@ int GetPinIndexByID(int id, GraphContext *graph)
     return -1;
 }
 
-void UpdateSpecialValues(InterpreterContext *intp, Vector2 mousePos, Rectangle screenBoundary)
+static inline void MarkValueWritten(ValueStore *values, int valueIndex)
 {
-    intp->values[SPECIAL_VALUE_MOUSE_X].number = mousePos.x;
-    intp->values[SPECIAL_VALUE_MOUSE_Y].number = mousePos.y;
-    intp->values[SPECIAL_VALUE_SCREEN_WIDTH].number = screenBoundary.width;
-    intp->values[SPECIAL_VALUE_SCREEN_HEIGHT].number = screenBoundary.height;
+    if (valueIndex >= 0)
+        values->versions[valueIndex]++;
 }
 
-RuntimeGraphContext ConvertToRuntimeGraph(GraphContext *graph, InterpreterContext *intp)
+static void UpdateSpecialValue(ValueStore *values, int valueIndex, float number)
 {
-    RuntimeGraphContext runtime = {0};
+    if (values->numbers[valueIndex] != number)
+    {
+        values->numbers[valueIndex] = number;
+        MarkValueWritten(values, valueIndex);
+    }
+}
 
-    runtime.nodeCount = graph->nodeCount;
-    runtime.nodes = malloc(sizeof(RuntimeNode) * graph->nodeCount);
+static Vector2 GetGameScreenCenter(const GameCamera *camera)
+{
+    return (Vector2){camera->screen.x + camera->screen.width / 2, camera->screen.y + camera->screen.height / 2};
+}
+
+static Camera2D ToCamera2D(const GameCamera *camera)
+{
+    return (Camera2D){GetGameScreenCenter(camera), camera->position, camera->rotation, camera->zoom};
+}
+
+static Vector2 GameScreenToWorld(const GameCamera *camera, Vector2 point)
+{
+    Vector2 fromCenter = Vector2Scale(Vector2Subtract(point, GetGameScreenCenter(camera)), 1 / camera->zoom);
+    return Vector2Add(camera->position, Vector2Rotate(fromCenter, -camera->rotation * DEG2RAD));
+}
+
+// World rectangle the game screen shows, grown to hold it whole when the camera is rotated
+static Rectangle GetCameraView(const GameCamera *camera)
+{
+    float sine = fabsf(sinf(camera->rotation * DEG2RAD));
+    float cosine = fabsf(cosf(camera->rotation * DEG2RAD));
+    float halfWidth = camera->screen.width / 2 / camera->zoom;
+    float halfHeight = camera->screen.height / 2 / camera->zoom;
+    Vector2 extent = {cosine * halfWidth + sine * halfHeight, sine * halfWidth + cosine * halfHeight};
+    return (Rectangle){camera->position.x - extent.x, camera->position.y - extent.y, extent.x * 2, extent.y * 2};
+}
+
+static void PublishCamera(InterpreterContext *intp)
+{
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_CAMERA_X, intp->camera.position.x);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_CAMERA_Y, intp->camera.position.y);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_CAMERA_ZOOM, intp->camera.zoom);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_CAMERA_ROTATION, intp->camera.rotation);
+}
+
+// Zoom at or below zero, like an unset input, means no zoom. Placing the camera stops it following a sprite
+static void SetCamera(InterpreterContext *intp, float x, float y, float zoom, float rotation)
+{
+    intp->camera.position = (Vector2){x, y};
+    intp->camera.isPlaced = true;
+    intp->camera.zoom = zoom > 0 ? zoom : 1;
+    intp->camera.rotation = rotation;
+    intp->camera.followComponent = -1;
+    PublishCamera(intp);
+}
 
-    if (!runtime.nodes)
+static void SetCameraFollow(InterpreterContext *intp, int componentIndex)
+{
+    if (componentIndex < 0 || componentIndex >= intp->componentCount || !intp->components[componentIndex].isSprite)
     {
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: nodes{I200}"}, LOG_LEVEL_ERROR);
-        return runtime;
+        intp->camera.followComponent = -1;
+        return;
     }
 
-    runtime.pinCount = graph->pinCount;
-    runtime.pins = malloc(sizeof(RuntimePin) * graph->pinCount);
+    intp->camera.followComponent = componentIndex;
+    intp->camera.position = intp->components[componentIndex].sprite.position;
+    intp->camera.isPlaced = true;
+    PublishCamera(intp);
+}
 
-    if (!runtime.pins)
+// Runs after the physics step, so the followed sprite is centered where it is drawn this frame
+static void UpdateGameCamera(InterpreterContext *intp)
+{
+    int c = intp->camera.followComponent;
+    if (c >= 0 && c < intp->componentCount)
     {
-        free(runtime.nodes);
-        runtime.nodes = NULL;
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: pins{I201}"}, LOG_LEVEL_ERROR);
-        return runtime;
+        intp->camera.position = intp->components[c].sprite.position;
+        PublishCamera(intp);
     }
+}
 
-    for (int i = 0; i < graph->pinCount; i++)
-    {
-        Pin *src = &graph->pins[i];
-        RuntimePin *dst = &runtime.pins[i];
+// The mouse is reported in world coordinates, which match the screen's while the camera is left alone
+void UpdateSpecialValues(InterpreterContext *intp, Vector2 mousePos, Rectangle screenBoundary)
+{
+    intp->camera.screen = screenBoundary;
+    if (!intp->camera.isPlaced)
+        intp->camera.position = GetGameScreenCenter(&intp->camera);
+
+    Vector2 mouse = GameScreenToWorld(&intp->camera, mousePos);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_MOUSE_X, mouse.x);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_MOUSE_Y, mouse.y);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_SCREEN_WIDTH, screenBoundary.width);
+    UpdateSpecialValue(&intp->values, SPECIAL_VALUE_SCREEN_HEIGHT, screenBoundary.height);
+    PublishCamera(intp);
+}
 
-        dst->id = src->id;
-        dst->type = src->type;
-        dst->nodeIndex = -1;
-        dst->isInput = src->isInput;
-        dst->valueIndex = -1;
-        dst->pickedOption = src->pickedOption;
-        dst->nextNodeIndex = -1;
-        dst->componentIndex = -1;
-        strmac(dst->textFieldValue, MAX_LITERAL_NODE_FIELD_SIZE, "%s", src->textFieldValue);
+// Returns true when a pure instruction has to run again and remembers the input versions it saw
+static inline bool PureInputsChanged(ValueStore *values, Instruction *ins)
+{
+    bool changed = false;
+    for (int i = 0; i < 2; i++)
+    {
+        int operand = ins->operands[2 + i];
+        unsigned int version = operand >= 0 ? values->versions[operand] : 0;
+        if (version != ins->operandVersions[i])
+        {
+            ins->operandVersions[i] = version;
+            changed = true;
+        }
     }
+    return changed;
+}
 
-    for (int i = 0; i < graph->nodeCount; i++)
-    {
-        Node *srcNode = &graph->nodes[i];
-        RuntimeNode *dstNode = &runtime.nodes[i];
+// Recomputes a Comparison, Gate or Arithmetic result only when one of its inputs was written since the last run
+static void EvaluatePureInstruction(ValueStore *values, Instruction *ins)
+{
+    if (!PureInputsChanged(values, ins))
+        return;
 
-        dstNode->index = i;
-        dstNode->type = srcNode->type;
-        dstNode->inputCount = srcNode->inputCount;
+    int *in = ins->operands;
+    switch (ins->op)
+    {
+    case OP_COMPARISON:
+    {
+        float numA = values->numbers[in[2]];
+        float numB = values->numbers[in[3]];
+        bool *result = &values->booleans[ins->result];
+        switch (ins->option)
+        {
+        case EQUAL_TO:
+            *result = numA == numB;
+            break;
+        case GREATER_THAN:
+            *result = numA > numB;
+            break;
+        case LESS_THAN:
+            *result = numA < numB;
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+
+    case OP_GATE:
+    {
+        bool boolA = values->booleans[in[2]];
+        bool boolB = values->booleans[in[3]];
+        bool *result = &values->booleans[ins->result];
+        switch (ins->option)
+        {
+        case AND:
+            *result = boolA && boolB;
+            break;
+        case OR:
+            *result = boolA || boolB;
+            break;
+        case NOT:
+            *result = !boolA;
+            break;
+        case XOR:
+            *result = boolA != boolB;
+            break;
+        case NAND:
+            *result = !(boolA && boolB);
+            break;
+        case NOR:
+            *result = !(boolA || boolB);
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+
+    case OP_ARITHMETIC:
+    {
+        float numA = values->numbers[in[2]];
+        float numB = values->numbers[in[3]];
+        float *result = &values->numbers[ins->result];
+        switch (ins->option)
+        {
+        case ADD:
+            *result = numA + numB;
+            break;
+        case SUBTRACT:
+            *result = numA - numB;
+            break;
+        case MULTIPLY:
+            *result = numA * numB;
+            break;
+        case DIVIDE:
+            *result = numA / numB;
+            break;
+        case MODULO:
+            *result = (int)numA % (int)numB;
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    MarkValueWritten(values, ins->result);
+}
+
+static void PullOperands(ValueStore *values, RuntimeGraphContext *graph, Instruction *ins, int depth)
+{
+    if (depth > graph->pureCount)
+        return;
+
+    for (int i = 0; i < MAX_INSTRUCTION_OPERANDS; i++)
+    {
+        if (!(ins->pullMask & (1 << i)))
+            continue;
+
+        Instruction *producer = &graph->pureCode[graph->valueProducers[ins->operands[i]]];
+        PullOperands(values, graph, producer, depth + 1);
+        EvaluatePureInstruction(values, producer);
+    }
+}
+
+static inline RuntimePin *RuntimeInputPin(RuntimeGraphContext *rg, RuntimeNode *node, int index)
+{
+    if (index < 0 || index >= node->inputCount)
+        return NULL;
+    return &rg->pins[node->firstPin + index];
+}
+
+static inline RuntimePin *RuntimeOutputPin(RuntimeGraphContext *rg, RuntimeNode *node, int index)
+{
+    if (index < 0 || index >= node->outputCount)
+        return NULL;
+    return &rg->pins[node->firstPin + node->inputCount + index];
+}
+
+static OpCode NodeTypeToOpCode(NodeType type)
+{
+    switch (type)
+    {
+    case NODE_UNKNOWN:
+        return OP_UNKNOWN_NODE;
+    case NODE_CREATE_NUMBER:
+        return OP_SET_NUMBER;
+    case NODE_CREATE_STRING:
+        return OP_SET_STRING;
+    case NODE_CREATE_BOOL:
+        return OP_SET_BOOL;
+    case NODE_CREATE_COLOR:
+        return OP_SET_COLOR;
+    case NODE_SET_VARIABLE:
+        return OP_SET_VARIABLE;
+    case NODE_SET_BACKGROUND:
+        return OP_SET_BACKGROUND;
+    case NODE_SET_FPS:
+        return OP_SET_FPS;
+    case NODE_CREATE_SPRITE:
+        return OP_CREATE_SPRITE;
+    case NODE_SPAWN_SPRITE:
+        return OP_SPAWN_SPRITE;
+    case NODE_DESTROY_SPRITE:
+        return OP_DESTROY_SPRITE;
+    case NODE_SET_SPRITE_POSITION:
+        return OP_SET_SPRITE_POSITION;
+    case NODE_SET_SPRITE_ROTATION:
+        return OP_SET_SPRITE_ROTATION;
+    case NODE_SET_SPRITE_TEXTURE:
+        return OP_SET_SPRITE_TEXTURE;
+    case NODE_SET_SPRITE_SIZE:
+        return OP_SET_SPRITE_SIZE;
+    case NODE_FORCE_SPRITE:
+        return OP_FORCE_SPRITE;
+    case NODE_SET_SPRITE_PHYSICS:
+        return OP_SET_SPRITE_PHYSICS;
+    case NODE_SET_COLLISION_GROUP:
+        return OP_SET_COLLISION_GROUP;
+    case NODE_SET_GROUPS_COLLIDE:
+        return OP_SET_GROUPS_COLLIDE;
+    case NODE_SET_Z_ORDER:
+        return OP_SET_Z_ORDER;
+    case NODE_SET_CAMERA:
+        return OP_SET_CAMERA;
+    case NODE_CAMERA_FOLLOW:
+        return OP_CAMERA_FOLLOW;
+    case NODE_RAYCAST:
+        return OP_RAYCAST;
+    case NODE_OVERLAP_CIRCLE:
+        return OP_OVERLAP_CIRCLE;
+    case NODE_OVERLAP_RECTANGLE:
+        return OP_OVERLAP_RECTANGLE;
+    case NODE_NEAREST_SPRITE:
+        return OP_NEAREST_SPRITE;
+    case NODE_SPRITE_AT_POINT:
+        return OP_SPRITE_AT_POINT;
+    case NODE_MOVE_TO_SPRITE:
+        return OP_MOVE_TO_SPRITE;
+    case NODE_DELAY:
+        return OP_DELAY;
+    case NODE_DRAW_PROP_RECTANGLE:
+    case NODE_DRAW_PROP_CIRCLE:
+        return OP_SHOW_PROP;
+    case NODE_COMPARISON:
+        return OP_COMPARISON;
+    case NODE_GATE:
+        return OP_GATE;
+    case NODE_ARITHMETIC:
+        return OP_ARITHMETIC;
+    case NODE_PRINT_TO_LOG:
+        return OP_PRINT_TO_LOG;
+    case NODE_DRAW_DEBUG_LINE:
+        return OP_DRAW_DEBUG_LINE;
+    default:
+        return OP_NOP;
+    }
+}
+
+static int EmitInstruction(RuntimeGraphContext *rg, Instruction ins)
+{
+    if (rg->codeCount >= rg->codeCapacity)
+    {
+        int newCapacity = rg->codeCapacity ? rg->codeCapacity * 2 : 64;
+        Instruction *tmp = realloc(rg->code, sizeof(Instruction) * newCapacity);
+        if (!tmp)
+        {
+            return -1;
+        }
+        rg->code = tmp;
+        rg->codeCapacity = newCapacity;
+    }
+
+    rg->code[rg->codeCount] = ins;
+    return rg->codeCount++;
+}
+
+static Instruction MakeInstruction(OpCode op, int nodeIndex)
+{
+    Instruction ins = {0};
+    ins.op = op;
+    ins.nodeIndex = nodeIndex;
+    ins.result = -1;
+    ins.componentIndex = -1;
+    ins.jump = -1;
+    for (int i = 0; i < MAX_INSTRUCTION_OPERANDS; i++)
+    {
+        ins.operands[i] = -1;
+    }
+    return ins;
+}
+
+static Instruction MakeNodeInstruction(RuntimeGraphContext *rg, OpCode op, int nodeIndex)
+{
+    RuntimeNode *node = &rg->nodes[nodeIndex];
+    Instruction ins = MakeInstruction(op, nodeIndex);
+
+    for (int i = 0; i < node->inputCount && i < MAX_INSTRUCTION_OPERANDS; i++)
+    {
+        ins.operands[i] = RuntimeInputPin(rg, node, i)->valueIndex;
+    }
+
+    RuntimePin *optionPin = RuntimeInputPin(rg, node, 1);
+    if (optionPin)
+    {
+        ins.option = optionPin->pickedOption;
+    }
+
+    RuntimePin *resultPin = RuntimeOutputPin(rg, node, 1);
+    if (resultPin)
+    {
+        ins.result = resultPin->valueIndex;
+        ins.componentIndex = resultPin->componentIndex;
+    }
+
+    return ins;
+}
+
+// Nodes that only apply one input do nothing while it is unlinked, like a Set Variable without a slot, and are not emitted
+static bool IsDroppedWhenUnlinked(RuntimeGraphContext *rg, OpCode op, int nodeIndex)
+{
+    RuntimeNode *node = &rg->nodes[nodeIndex];
+    switch (op)
+    {
+    case OP_SET_BACKGROUND:
+    case OP_SET_FPS:
+    case OP_PRINT_TO_LOG:
+        return RuntimeInputPin(rg, node, 1) && RuntimeInputPin(rg, node, 1)->valueIndex == SPECIAL_VALUE_UNLINKED;
+    case OP_SET_VARIABLE:
+        return !RuntimeOutputPin(rg, node, 1) || RuntimeOutputPin(rg, node, 1)->valueIndex == -1;
+    default:
+        return false;
+    }
+}
+
+static int NextFlowNodeIndex(RuntimeGraphContext *rg, int nodeIndex, int outPin)
+{
+    if (nodeIndex < 0 || nodeIndex >= rg->nodeCount)
+        return -1;
+
+    RuntimePin *pin = RuntimeOutputPin(rg, &rg->nodes[nodeIndex], outPin);
+    if (!pin)
+        return -1;
+
+    return pin->nextNodeIndex;
+}
+
+static bool IsPureNode(NodeType type)
+{
+    return type == NODE_COMPARISON || type == NODE_GATE || type == NODE_ARITHMETIC;
+}
+
+static void MarkPulledOperands(RuntimeGraphContext *rg, int valueCount, Instruction *code, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = 0; j < MAX_INSTRUCTION_OPERANDS; j++)
+        {
+            int operand = code[i].operands[j];
+            if (operand >= 0 && operand < valueCount && rg->valueProducers[operand] != -1)
+            {
+                code[i].pullMask |= 1 << j;
+            }
+        }
+    }
+}
+
+// Pure nodes that no flow chain reaches are evaluated on demand, whenever an instruction reads their result
+static bool CompileDetachedPureNodes(RuntimeGraphContext *rg, InterpreterContext *intp, int *compiledAddress)
+{
+    rg->valueProducers = ArenaAlloc(&intp->arena, sizeof(int) * (intp->valueCount + 1));
+    rg->pureCode = ArenaAlloc(&intp->arena, sizeof(Instruction) * (rg->nodeCount + 1));
+    if (!rg->valueProducers || !rg->pureCode)
+        return false;
+
+    for (int i = 0; i < intp->valueCount; i++)
+    {
+        rg->valueProducers[i] = -1;
+    }
+
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        if (!IsPureNode(rg->nodes[i].type) || compiledAddress[i] != -1)
+            continue;
+
+        Instruction ins = MakeNodeInstruction(rg, NodeTypeToOpCode(rg->nodes[i].type), i);
+        if (ins.result < 0 || ins.result >= intp->valueCount)
+            continue;
+
+        rg->valueProducers[ins.result] = rg->pureCount;
+        rg->pureCode[rg->pureCount++] = ins;
+    }
+
+    MarkPulledOperands(rg, intp->valueCount, rg->code, rg->codeCount);
+    MarkPulledOperands(rg, intp->valueCount, rg->pureCode, rg->pureCount);
+
+    return true;
+}
+
+typedef struct
+{
+    int nodeIndex;
+    int outPin;
+    int endJump;
+    int patch;
+} FlowCompileTask;
+
+// Lowers every flow chain reachable from an event node into a linear instruction stream.
+// Branch/Loop targets are patched once the pending chain is emitted, loop bodies end with a jump back to their OP_LOOP
+bool CompileRuntimeGraph(RuntimeGraphContext *rg, InterpreterContext *intp)
+{
+    rg->entryPoints = ArenaAlloc(&intp->arena, sizeof(int) * (rg->nodeCount + 1));
+    int *visitStamp = calloc(rg->nodeCount + 1, sizeof(int));
+    int *compiledAddress = malloc(sizeof(int) * (rg->nodeCount + 1));
+    int *compiledEndJump = malloc(sizeof(int) * (rg->nodeCount + 1));
+    int taskCapacity = 64;
+    FlowCompileTask *tasks = malloc(sizeof(FlowCompileTask) * taskCapacity);
+
+    if (!rg->entryPoints || !visitStamp || !compiledAddress || !compiledEndJump || !tasks)
+    {
+        free(visitStamp);
+        free(compiledAddress);
+        free(compiledEndJump);
+        free(tasks);
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: bytecode{I212}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
+
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        rg->entryPoints[i] = -1;
+        compiledAddress[i] = -1;
+        compiledEndJump[i] = -1;
+    }
+
+    bool outOfMemory = false;
+    bool cycleFound = false;
+    int stamp = 0;
+
+    for (int i = 0; i < rg->nodeCount && !outOfMemory; i++)
+    {
+        NodeType type = rg->nodes[i].type;
+        if (type != NODE_EVENT_START && type != NODE_EVENT_TICK && type != NODE_EVENT_ON_BUTTON && type != NODE_EVENT_ON_COLLISION_BEGIN && type != NODE_EVENT_ON_COLLISION_END)
+        {
+            continue;
+        }
+
+        rg->entryPoints[i] = rg->codeCount;
+
+        int taskCount = 0;
+        tasks[taskCount++] = (FlowCompileTask){i, 0, -1, -1};
+
+        while (taskCount > 0 && !outOfMemory)
+        {
+            FlowCompileTask task = tasks[--taskCount];
+
+            if (task.patch >= 0)
+            {
+                rg->code[task.patch].jump = rg->codeCount;
+            }
+
+            stamp++;
+            int prevNodeIndex = task.nodeIndex;
+            int outPin = task.outPin;
+            int endJump = task.endJump;
+
+            while (true)
+            {
+                int currNodeIndex = NextFlowNodeIndex(rg, prevNodeIndex, outPin);
+                bool chainEnded = currNodeIndex < 0 || currNodeIndex >= rg->nodeCount;
+
+                if (!chainEnded && visitStamp[currNodeIndex] == stamp)
+                {
+                    // Flowing back into the chain is only allowed when a Loop guards the cycle
+                    bool isGuarded = false;
+                    for (int j = compiledAddress[currNodeIndex]; j < rg->codeCount; j++)
+                    {
+                        if (rg->code[j].op == OP_LOOP)
+                        {
+                            isGuarded = true;
+                            break;
+                        }
+                    }
+
+                    if (isGuarded)
+                    {
+                        Instruction jump = MakeInstruction(OP_JUMP, currNodeIndex);
+                        jump.jump = compiledAddress[currNodeIndex];
+                        if (EmitInstruction(rg, jump) < 0)
+                            outOfMemory = true;
+                        break;
+                    }
+
+                    cycleFound = true;
+                    chainEnded = true;
+                }
+
+                if (chainEnded)
+                {
+                    Instruction end = MakeInstruction(endJump == -1 ? OP_END : OP_JUMP, prevNodeIndex);
+                    end.jump = endJump;
+                    if (EmitInstruction(rg, end) < 0)
+                        outOfMemory = true;
+                    break;
+                }
+
+                if (compiledAddress[currNodeIndex] != -1 && compiledEndJump[currNodeIndex] == endJump)
+                {
+                    Instruction jump = MakeInstruction(OP_JUMP, currNodeIndex);
+                    jump.jump = compiledAddress[currNodeIndex];
+                    if (EmitInstruction(rg, jump) < 0)
+                        outOfMemory = true;
+                    break;
+                }
+
+                visitStamp[currNodeIndex] = stamp;
+                compiledAddress[currNodeIndex] = rg->codeCount;
+                compiledEndJump[currNodeIndex] = endJump;
+
+                RuntimeNode *node = &rg->nodes[currNodeIndex];
+
+                if (taskCount + 1 >= taskCapacity)
+                {
+                    FlowCompileTask *tmp = realloc(tasks, sizeof(FlowCompileTask) * taskCapacity * 2);
+                    if (!tmp)
+                    {
+                        outOfMemory = true;
+                        break;
+                    }
+                    tasks = tmp;
+                    taskCapacity *= 2;
+                }
+
+                if (node->type == NODE_BRANCH)
+                {
+                    int branch = EmitInstruction(rg, MakeNodeInstruction(rg, OP_BRANCH, currNodeIndex));
+                    if (branch < 0)
+                    {
+                        outOfMemory = true;
+                        break;
+                    }
+                    tasks[taskCount++] = (FlowCompileTask){currNodeIndex, 1, endJump, branch};
+                    prevNodeIndex = currNodeIndex;
+                    outPin = 0;
+                    continue;
+                }
+
+                if (node->type == NODE_LOOP)
+                {
+                    Instruction loopIns = MakeNodeInstruction(rg, OP_LOOP, currNodeIndex);
+                    loopIns.loopSteps = INFINITE_LOOP_PROTECTION_STEPS;
+                    int loop = EmitInstruction(rg, loopIns);
+                    if (loop < 0)
+                    {
+                        outOfMemory = true;
+                        break;
+                    }
+                    tasks[taskCount++] = (FlowCompileTask){currNodeIndex, 0, endJump, loop};
+                    prevNodeIndex = currNodeIndex;
+                    outPin = 1;
+                    endJump = loop;
+                    continue;
+                }
+
+                OpCode op = NodeTypeToOpCode(node->type);
+                if (op != OP_NOP && !IsDroppedWhenUnlinked(rg, op, currNodeIndex) && EmitInstruction(rg, MakeNodeInstruction(rg, op, currNodeIndex)) < 0)
+                {
+                    outOfMemory = true;
+                    break;
+                }
+
+                prevNodeIndex = currNodeIndex;
+                outPin = 0;
+            }
+        }
+    }
+
+    if (!outOfMemory && !CompileDetachedPureNodes(rg, intp, compiledAddress))
+    {
+        outOfMemory = true;
+    }
+
+    free(visitStamp);
+    free(compiledAddress);
+    free(compiledEndJump);
+    free(tasks);
+
+    if (outOfMemory)
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: bytecode{I212}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
+
+    if (cycleFound)
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Flow cycle detected, use a Loop node instead{I104}"}, LOG_LEVEL_WARNING);
+    }
+
+    return true;
+}
+
+static bool IsLiteralNode(NodeType type)
+{
+    return type == NODE_LITERAL_NUMBER || type == NODE_LITERAL_STRING || type == NODE_LITERAL_BOOL || type == NODE_LITERAL_COLOR;
+}
+
+// Sort key grouping literal nodes that hold the same value, ties keep node order
+typedef struct LiteralKey
+{
+    ValueType type;
+    float number;
+    bool boolean;
+    Color color;
+    const char *string;
+    int slot;
+    int nodeIndex;
+} LiteralKey;
+
+// Sort key grouping detached pure nodes that compute the same value, ties keep code order
+typedef struct PureKey
+{
+    OpCode op;
+    int option;
+    int a;
+    int b;
+    int index;
+} PureKey;
+
+static int CompareInt(int a, int b)
+{
+    return (a > b) - (a < b);
+}
+
+static int CompareLiteralKeys(const void *left, const void *right)
+{
+    const LiteralKey *a = left;
+    const LiteralKey *b = right;
+
+    int result = CompareInt(a->type, b->type);
+    if (result == 0)
+    {
+        switch (a->type)
+        {
+        case VAL_NUMBER:
+            result = (a->number > b->number) - (a->number < b->number);
+            break;
+        case VAL_STRING:
+            result = strcmp(a->string, b->string);
+            break;
+        case VAL_BOOL:
+            result = CompareInt(a->boolean, b->boolean);
+            break;
+        case VAL_COLOR:
+            result = memcmp(&a->color, &b->color, sizeof(Color));
+            break;
+        default:
+            break;
+        }
+    }
+    return result != 0 ? result : CompareInt(a->nodeIndex, b->nodeIndex);
+}
+
+static int ComparePureKeys(const void *left, const void *right)
+{
+    const PureKey *a = left;
+    const PureKey *b = right;
+
+    int result = CompareInt(a->op, b->op);
+    if (result == 0)
+        result = CompareInt(a->option, b->option);
+    if (result == 0)
+        result = CompareInt(a->a, b->a);
+    if (result == 0)
+        result = CompareInt(a->b, b->b);
+    return result != 0 ? result : CompareInt(a->index, b->index);
+}
+
+static void RemapOperands(Instruction *code, int count, const int *slotRemap, int valueCount)
+{
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = 0; j < MAX_INSTRUCTION_OPERANDS; j++)
+        {
+            int operand = code[i].operands[j];
+            if (operand >= 0 && operand < valueCount)
+                code[i].operands[j] = slotRemap[operand];
+        }
+    }
+}
+
+static bool IsPureOp(OpCode op)
+{
+    return op == OP_COMPARISON || op == OP_GATE || op == OP_ARITHMETIC;
+}
+
+static void MarkLiveProducers(RuntimeGraphContext *rg, Instruction *ins, int valueCount, bool *isLive, int *worklist, int *worklistCount)
+{
+    for (int i = 0; i < MAX_INSTRUCTION_OPERANDS; i++)
+    {
+        int operand = ins->operands[i];
+        if (operand < 0 || operand >= valueCount || rg->valueProducers[operand] == -1)
+            continue;
+
+        int producer = rg->valueProducers[operand];
+        if (!isLive[producer] && rg->pureCode[producer].op != OP_NOP)
+        {
+            isLive[producer] = true;
+            worklist[(*worklistCount)++] = producer;
+        }
+    }
+}
+
+// Evaluates pure instructions whose inputs are all constant at build time and turns them into NOPs
+static bool FoldConstants(Instruction *code, int count, ValueStore *values, bool *isConstant, int valueCount)
+{
+    bool changed = false;
+    for (int i = 0; i < count; i++)
+    {
+        Instruction *ins = &code[i];
+        if (!IsPureOp(ins->op))
+            continue;
+
+        int a = ins->operands[2];
+        int b = ins->operands[3];
+        bool isUnary = ins->op == OP_GATE && ins->option == NOT;
+        if (ins->result < 0 || ins->result >= valueCount || isConstant[ins->result])
+            continue;
+        if (a < 0 || a >= valueCount || !isConstant[a])
+            continue;
+        if (!isUnary && (b < 0 || b >= valueCount || !isConstant[b]))
+            continue;
+        if (ins->op == OP_ARITHMETIC && ins->option == MODULO && (int)values->numbers[b] == 0)
+            continue;
+
+        EvaluatePureInstruction(values, ins);
+        isConstant[ins->result] = true;
+        ins->op = OP_NOP;
+        changed = true;
+    }
+    return changed;
+}
+
+// Runs after CompileRuntimeGraph: shares duplicate literal slots, folds constant pure nodes, merges identical
+// detached pure nodes, drops detached nodes nobody reads and squeezes the resulting NOPs out of the bytecode
+static bool OptimizeRuntimeGraph(RuntimeGraphContext *rg, InterpreterContext *intp)
+{
+    ValueStore *values = &intp->values;
+    int valueCount = intp->valueCount;
+
+    bool *isConstant = calloc(valueCount + 1, sizeof(bool));
+    bool *isLive = calloc(rg->pureCount + 1, sizeof(bool));
+    bool *isLowered = calloc(rg->nodeCount + 1, sizeof(bool));
+    int *newAddress = malloc(sizeof(int) * (rg->codeCount + 1));
+    int *worklist = malloc(sizeof(int) * (rg->pureCount + 1));
+
+    if (!isConstant || !isLive || !isLowered || !newAddress || !worklist)
+    {
+        free(isConstant);
+        free(isLive);
+        free(isLowered);
+        free(newAddress);
+        free(worklist);
+        return false;
+    }
+
+    int mergedLiterals = 0;
+
+    // Duplicate literals are found by sorting on their value, then every read of a duplicate is pointed at the first one
+    int literalCount = 0;
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        if (IsLiteralNode(rg->nodes[i].type))
+            literalCount++;
+    }
+
+    LiteralKey *literals = malloc(sizeof(LiteralKey) * (literalCount + 1));
+    PureKey *pureKeys = malloc(sizeof(PureKey) * (rg->pureCount + 1));
+    int *slotRemap = malloc(sizeof(int) * (valueCount + 1));
+    if (!literals || !pureKeys || !slotRemap)
+    {
+        free(literals);
+        free(pureKeys);
+        free(slotRemap);
+        free(isConstant);
+        free(isLive);
+        free(isLowered);
+        free(newAddress);
+        free(worklist);
+        return false;
+    }
+
+    for (int i = 0; i < valueCount; i++)
+    {
+        slotRemap[i] = i;
+    }
+
+    literalCount = 0;
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        if (!IsLiteralNode(rg->nodes[i].type))
+            continue;
+        RuntimePin *pin = RuntimeOutputPin(rg, &rg->nodes[i], 0);
+        if (!pin || pin->valueIndex < 0 || pin->valueIndex >= valueCount)
+            continue;
+
+        int slot = pin->valueIndex;
+        isConstant[slot] = true;
+        if (values->types[slot] == VAL_STRING && !values->strings[slot])
+            continue;
+        if (values->types[slot] == VAL_NUMBER && isnan(values->numbers[slot]))
+            continue;
+
+        literals[literalCount++] = (LiteralKey){
+            .type = values->types[slot],
+            .number = values->numbers[slot],
+            .boolean = values->booleans[slot],
+            .color = values->colors[slot],
+            .string = values->strings[slot],
+            .slot = slot,
+            .nodeIndex = i};
+    }
+
+    qsort(literals, literalCount, sizeof(LiteralKey), CompareLiteralKeys);
+    for (int i = 1; i < literalCount; i++)
+    {
+        LiteralKey first = literals[i - 1];
+        first.nodeIndex = literals[i].nodeIndex;
+        if (CompareLiteralKeys(&first, &literals[i]) != 0)
+            continue;
+
+        slotRemap[literals[i].slot] = slotRemap[literals[i - 1].slot];
+        isConstant[literals[i].slot] = false;
+        mergedLiterals++;
+    }
+    RemapOperands(rg->code, rg->codeCount, slotRemap, valueCount);
+    RemapOperands(rg->pureCode, rg->pureCount, slotRemap, valueCount);
+
+    // Nothing writes the unlinked slot, so a pure node reading it folds like one reading a literal
+    isConstant[SPECIAL_VALUE_UNLINKED] = true;
+
+    while (FoldConstants(rg->code, rg->codeCount, values, isConstant, valueCount) | FoldConstants(rg->pureCode, rg->pureCount, values, isConstant, valueCount))
+    {
+    }
+
+    // Identical detached nodes sort next to each other; merging one level can expose the next, so repeat until stable
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+
+        int keyCount = 0;
+        for (int i = 0; i < rg->pureCount; i++)
+        {
+            Instruction *ins = &rg->pureCode[i];
+            if (ins->op == OP_NOP)
+                continue;
+            pureKeys[keyCount++] = (PureKey){ins->op, ins->option, ins->operands[2], ins->operands[3], i};
+        }
+        qsort(pureKeys, keyCount, sizeof(PureKey), ComparePureKeys);
+
+        for (int i = 0; i < valueCount; i++)
+        {
+            slotRemap[i] = i;
+        }
+
+        int first = 0;
+        for (int i = 1; i < keyCount; i++)
+        {
+            PureKey *a = &pureKeys[first];
+            PureKey *b = &pureKeys[i];
+            if (a->op != b->op || a->option != b->option || a->a != b->a || a->b != b->b)
+            {
+                first = i;
+                continue;
+            }
+
+            Instruction *ins = &rg->pureCode[b->index];
+            slotRemap[ins->result] = rg->pureCode[a->index].result;
+            ins->op = OP_NOP;
+            merged = true;
+        }
+
+        if (merged)
+        {
+            RemapOperands(rg->code, rg->codeCount, slotRemap, valueCount);
+            RemapOperands(rg->pureCode, rg->pureCount, slotRemap, valueCount);
+        }
+    }
+
+    free(literals);
+    free(pureKeys);
+    free(slotRemap);
+
+    // Detached nodes are only live through a chain of reads that starts in the bytecode
+    int worklistCount = 0;
+    for (int pc = 0; pc < rg->codeCount; pc++)
+    {
+        if (rg->code[pc].op != OP_NOP)
+            MarkLiveProducers(rg, &rg->code[pc], valueCount, isLive, worklist, &worklistCount);
+    }
+    while (worklistCount > 0)
+    {
+        MarkLiveProducers(rg, &rg->pureCode[worklist[--worklistCount]], valueCount, isLive, worklist, &worklistCount);
+    }
+
+    int pureCount = 0;
+    for (int i = 0; i < rg->pureCount; i++)
+    {
+        if (isLive[i])
+            rg->pureCode[pureCount++] = rg->pureCode[i];
+    }
+    rg->pureCount = pureCount;
+
+    for (int i = 0; i < valueCount; i++)
+    {
+        rg->valueProducers[i] = -1;
+    }
+    for (int i = 0; i < rg->pureCount; i++)
+    {
+        rg->valueProducers[rg->pureCode[i].result] = i;
+        isLowered[rg->pureCode[i].nodeIndex] = true;
+    }
+
+    int codeCount = 0;
+    for (int pc = 0; pc < rg->codeCount; pc++)
+    {
+        newAddress[pc] = codeCount;
+        if (rg->code[pc].op != OP_NOP)
+            codeCount++;
+    }
+    newAddress[rg->codeCount] = codeCount;
+
+    codeCount = 0;
+    for (int pc = 0; pc < rg->codeCount; pc++)
+    {
+        Instruction ins = rg->code[pc];
+        if (ins.op == OP_NOP)
+            continue;
+        if (ins.jump >= 0 && ins.jump <= rg->codeCount)
+            ins.jump = newAddress[ins.jump];
+        ins.pullMask = 0;
+        if (ins.op != OP_JUMP && ins.op != OP_END)
+            isLowered[ins.nodeIndex] = true;
+        rg->code[codeCount++] = ins;
+    }
+    rg->codeCount = codeCount;
+
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        if (rg->entryPoints[i] >= 0)
+            rg->entryPoints[i] = newAddress[rg->entryPoints[i]];
+    }
+
+    for (int i = 0; i < rg->pureCount; i++)
+    {
+        rg->pureCode[i].pullMask = 0;
+    }
+    MarkPulledOperands(rg, valueCount, rg->code, rg->codeCount);
+    MarkPulledOperands(rg, valueCount, rg->pureCode, rg->pureCount);
+
+    int removedNodes = mergedLiterals;
+    for (int i = 0; i < rg->nodeCount; i++)
+    {
+        NodeType type = rg->nodes[i].type;
+        bool isLowerable = NodeTypeToOpCode(type) != OP_NOP || type == NODE_BRANCH || type == NODE_LOOP;
+        if (isLowerable && !isLowered[i])
+            removedNodes++;
+    }
+
+    if (removedNodes > 0)
+    {
+        char message[MAX_LOG_MESSAGE_SIZE];
+        strmac(message, MAX_LOG_MESSAGE_SIZE, "Optimizer removed %d node%s{I301}", removedNodes, removedNodes == 1 ? "" : "s");
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = message}, LOG_LEVEL_NORMAL);
+    }
+
+    free(isConstant);
+    free(isLive);
+    free(isLowered);
+    free(newAddress);
+    free(worklist);
+
+    return true;
+}
+
+typedef struct
+{
+    int *keys;
+    int *values;
+    int capacity;
+} IdMap;
+
+typedef struct
+{
+    const char **keys;
+    int *values;
+    int capacity;
+} NameMap;
+
+// Lookups built once per build so that pin, link and variable resolution stay linear in graph size
+typedef struct
+{
+    IdMap pinIndexById;
+    IdMap nodeIndexById;
+    int *runtimePinByGraphPin;
+    NameMap nodeByName;
+    NameMap spriteComponentByName;
+    int *variableNodes;
+
+    // Hot patch only: the running build, whose atlas is handed over instead of packed again
+    InterpreterContext *previous;
+    IdMap previousNodeById;
+    bool isAtlasTaken;
+} BuildLookup;
+
+static int HashCapacity(int count)
+{
+    int capacity = 16;
+    while (capacity < count * 2)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+static unsigned int HashInt(int key)
+{
+    unsigned int h = (unsigned int)key;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static unsigned int HashString(const char *key)
+{
+    unsigned int h = 2166136261u;
+    while (*key)
+    {
+        h ^= (unsigned char)*key++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool InitIdMap(IdMap *map, int count)
+{
+    map->capacity = HashCapacity(count);
+    map->keys = malloc(sizeof(int) * map->capacity);
+    map->values = malloc(sizeof(int) * map->capacity);
+    if (!map->keys || !map->values)
+        return false;
+
+    for (int i = 0; i < map->capacity; i++)
+    {
+        map->values[i] = -1;
+    }
+    return true;
+}
+
+static void IdMapPut(IdMap *map, int key, int value)
+{
+    unsigned int slot = HashInt(key) & (map->capacity - 1);
+    while (map->values[slot] != -1 && map->keys[slot] != key)
+    {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    map->keys[slot] = key;
+    map->values[slot] = value;
+}
+
+static int IdMapGet(IdMap *map, int key)
+{
+    unsigned int slot = HashInt(key) & (map->capacity - 1);
+    while (map->values[slot] != -1)
+    {
+        if (map->keys[slot] == key)
+            return map->values[slot];
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    return -1;
+}
+
+static bool InitNameMap(NameMap *map, int count)
+{
+    map->capacity = HashCapacity(count);
+    map->keys = malloc(sizeof(char *) * map->capacity);
+    map->values = malloc(sizeof(int) * map->capacity);
+    if (!map->keys || !map->values)
+        return false;
+
+    for (int i = 0; i < map->capacity; i++)
+    {
+        map->values[i] = -1;
+    }
+    return true;
+}
+
+static void NameMapPut(NameMap *map, const char *key, int value, bool overwrite)
+{
+    unsigned int slot = HashString(key) & (map->capacity - 1);
+    while (map->values[slot] != -1)
+    {
+        if (strcmp(map->keys[slot], key) == 0)
+        {
+            if (overwrite)
+                map->values[slot] = value;
+            return;
+        }
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    map->keys[slot] = key;
+    map->values[slot] = value;
+}
+
+static int NameMapGet(NameMap *map, const char *key)
+{
+    unsigned int slot = HashString(key) & (map->capacity - 1);
+    while (map->values[slot] != -1)
+    {
+        if (strcmp(map->keys[slot], key) == 0)
+            return map->values[slot];
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    return -1;
+}
+
+static void FreeBuildLookup(BuildLookup *lookup)
+{
+    free(lookup->pinIndexById.keys);
+    free(lookup->pinIndexById.values);
+    free(lookup->nodeIndexById.keys);
+    free(lookup->nodeIndexById.values);
+    free(lookup->runtimePinByGraphPin);
+    free(lookup->nodeByName.keys);
+    free(lookup->nodeByName.values);
+    free(lookup->spriteComponentByName.keys);
+    free(lookup->spriteComponentByName.values);
+    free(lookup->variableNodes);
+    free(lookup->previousNodeById.keys);
+    free(lookup->previousNodeById.values);
+    *lookup = (BuildLookup){0};
+}
+
+static bool InitBuildLookup(BuildLookup *lookup, GraphContext *graph)
+{
+    *lookup = (BuildLookup){0};
+
+    lookup->runtimePinByGraphPin = malloc(sizeof(int) * (graph->pinCount + 1));
+    lookup->variableNodes = malloc(sizeof(int) * (graph->variablesCount + 1));
+    if (!InitIdMap(&lookup->pinIndexById, graph->pinCount) || !InitIdMap(&lookup->nodeIndexById, graph->nodeCount) || !InitNameMap(&lookup->nodeByName, graph->nodeCount) ||
+        !InitNameMap(&lookup->spriteComponentByName, graph->nodeCount) || !lookup->runtimePinByGraphPin || !lookup->variableNodes)
+    {
+        FreeBuildLookup(lookup);
+        return false;
+    }
+
+    for (int i = 0; i < graph->pinCount; i++)
+    {
+        IdMapPut(&lookup->pinIndexById, graph->pins[i].id, i);
+        lookup->runtimePinByGraphPin[i] = -1;
+    }
+
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        IdMapPut(&lookup->nodeIndexById, graph->nodes[i].id, i);
+        NameMapPut(&lookup->nodeByName, graph->nodes[i].name, i, false);
+    }
+
+    for (int i = 0; i < graph->variablesCount; i++)
+    {
+        lookup->variableNodes[i] = graph->variables[i] ? NameMapGet(&lookup->nodeByName, graph->variables[i]) : -1;
+    }
+
+    return true;
+}
+
+static unsigned int HashPinSetting(const Pin *pin)
+{
+    switch (pin->type)
+    {
+    case PIN_FIELD_NUM:
+    case PIN_FIELD_STRING:
+    case PIN_FIELD_BOOL:
+    case PIN_FIELD_COLOR:
+        return HashString(pin->textFieldValue);
+    case PIN_FIELD_KEY:
+    case PIN_DROPDOWN_COMPARISON_OPERATOR:
+    case PIN_DROPDOWN_GATE:
+    case PIN_DROPDOWN_ARITHMETIC:
+    case PIN_DROPDOWN_KEY_ACTION:
+    case PIN_VARIABLE:
+    case PIN_SPRITE_VARIABLE:
+        return HashInt(pin->pickedOption);
+    case PIN_EDIT_HITBOX:
+    {
+        unsigned int h = HashInt(pin->hitbox.count);
+        if (pin->hitbox.fit != HITBOX_FIT_AUTO)
+            h = h * 31 + HashInt(pin->hitbox.fit);
+        for (int i = 0; i < pin->hitbox.count && i < MAX_POLYGON_VERTICES; i++)
+        {
+            h = h * 31 + HashInt((int)(pin->hitbox.vertices[i].x * 64));
+            h = h * 31 + HashInt((int)(pin->hitbox.vertices[i].y * 64));
+        }
+        return h;
+    }
+    default:
+        return 0;
+    }
+}
+
+// Links are summed in per target pin, so the signature does not depend on link order
+static void ComputeNodeInfos(GraphContext *graph, BuildLookup *lookup, RuntimeNodeInfo *infos)
+{
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        Node *node = &graph->nodes[i];
+        unsigned int signature = HashInt(node->type) ^ HashString(node->name);
+        for (int j = 0; j < node->inputCount; j++)
+        {
+            int pinIndex = IdMapGet(&lookup->pinIndexById, node->inputPins[j]);
+            if (pinIndex != -1)
+                signature = signature * 31 + HashPinSetting(&graph->pins[pinIndex]);
+        }
+        infos[i].id = node->id;
+        infos[i].signature = signature;
+    }
+
+    for (int i = 0; i < graph->linkCount; i++)
+    {
+        int inputIndex = IdMapGet(&lookup->pinIndexById, graph->links[i].inputPinID);
+        if (inputIndex == -1)
+            continue;
+        int nodeIndex = IdMapGet(&lookup->nodeIndexById, graph->pins[inputIndex].nodeID);
+        if (nodeIndex == -1)
+            continue;
+        infos[nodeIndex].signature += HashInt(graph->links[i].outputPinID ^ (graph->pins[inputIndex].posInNode << 24));
+    }
+}
+
+static unsigned long long HashContent(const unsigned char *data, int size)
+{
+    unsigned long long h = 14695981039346656037ull;
+    for (int i = 0; i < size; i++)
+    {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Slot holding fileName, or the empty slot it would go in
+static int FindCachedName(const TextureCache *cache, const char *fileName)
+{
+    unsigned int slot = HashString(fileName) & (cache->nameCapacity - 1);
+    while (cache->names[slot].entry != -1 && strcmp(cache->names[slot].fileName, fileName) != 0)
+    {
+        slot = (slot + 1) & (cache->nameCapacity - 1);
+    }
+    return slot;
+}
+
+static bool GrowCachedNames(TextureCache *cache)
+{
+    int capacity = HashCapacity(cache->nameCount + 1);
+    if (capacity <= cache->nameCapacity)
+        return true;
+
+    TextureCacheName *names = malloc(sizeof(TextureCacheName) * capacity);
+    if (!names)
+        return false;
+    for (int i = 0; i < capacity; i++)
+    {
+        names[i] = (TextureCacheName){NULL, -1};
+    }
+
+    TextureCacheName *oldNames = cache->names;
+    int oldCapacity = cache->nameCapacity;
+    cache->names = names;
+    cache->nameCapacity = capacity;
+    for (int i = 0; i < oldCapacity; i++)
+    {
+        if (oldNames[i].entry != -1)
+            cache->names[FindCachedName(cache, oldNames[i].fileName)] = oldNames[i];
+    }
+    free(oldNames);
+    return true;
+}
+
+// Unloads textures no sprite shows, least recently used first, until the loaded ones fit the budget again
+static void EvictCachedTextures(InterpreterContext *intp)
+{
+    TextureCache *cache = &intp->textureCache;
+    long long budget = (long long)intp->textureBudgetMB * 1024 * 1024;
+    while (cache->loadedBytes > budget)
+    {
+        int oldest = -1;
+        for (int i = 0; i < cache->entryCount; i++)
+        {
+            CachedTexture *entry = &cache->entries[i];
+            if (entry->texture.id && entry->refCount == 0 && (oldest == -1 || entry->lastUsed < cache->entries[oldest].lastUsed))
+                oldest = i;
+        }
+        if (oldest == -1)
+            return;
+
+        UnloadTexture(cache->entries[oldest].texture);
+        cache->entries[oldest].texture = (Texture2D){0};
+        cache->loadedBytes -= cache->entries[oldest].vramBytes;
+        cache->evictions++;
+    }
+}
+
+// Entry holding the file's texture with a reference taken on it, -1 when the file does not load.
+// A known name costs one hash lookup, anything else reads the file and shares the texture of any file with the same bytes
+static int AcquireCachedTexture(InterpreterContext *intp, const char *fileName)
+{
+    TextureCache *cache = &intp->textureCache;
+    if (!fileName || !fileName[0])
+        return -1;
+
+    cache->clock++;
+    int slot = cache->nameCapacity ? FindCachedName(cache, fileName) : -1;
+    if (slot != -1 && cache->names[slot].entry != -1 && cache->entries[cache->names[slot].entry].texture.id)
+    {
+        CachedTexture *entry = &cache->entries[cache->names[slot].entry];
+        entry->refCount++;
+        entry->lastUsed = cache->clock;
+        cache->hits++;
+        return cache->names[slot].entry;
+    }
+    cache->misses++;
+
+    char path[MAX_FILE_PATH];
+    strmac(path, MAX_FILE_PATH, "%s%c%s", intp->projectPath, PATH_SEPARATOR, fileName);
+    int size = 0;
+    unsigned char *data = LoadFileData(path, &size);
+    if (!data)
+        return -1;
+
+    unsigned long long hash = HashContent(data, size);
+    int index = -1;
+    for (int i = 0; i < cache->entryCount && index == -1; i++)
+    {
+        if (cache->entries[i].contentHash == hash && cache->entries[i].contentSize == size)
+            index = i;
+    }
+
+    if (index == -1 || !cache->entries[index].texture.id)
+    {
+        if (index == -1 && cache->entryCount == cache->entryCapacity)
+        {
+            int capacity = cache->entryCapacity ? cache->entryCapacity * 2 : 16;
+            CachedTexture *entries = realloc(cache->entries, sizeof(CachedTexture) * capacity);
+            if (!entries)
+            {
+                UnloadFileData(data);
+                return -1;
+            }
+            cache->entries = entries;
+            cache->entryCapacity = capacity;
+        }
+
+        Image image = LoadImageFromMemory(GetFileExtension(fileName), data, size);
+        Texture2D texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        if (!texture.id)
+        {
+            UnloadFileData(data);
+            return -1;
+        }
+
+        if (index == -1)
+        {
+            index = cache->entryCount++;
+            cache->entries[index] = (CachedTexture){.contentHash = hash, .contentSize = size};
+        }
+        cache->entries[index].texture = texture;
+        cache->entries[index].vramBytes = GetPixelDataSize(texture.width, texture.height, texture.format);
+        cache->loadedBytes += cache->entries[index].vramBytes;
+    }
+    UnloadFileData(data);
+
+    // Out of memory for the name only costs a file read the next time it is asked for
+    if (GrowCachedNames(cache))
+    {
+        slot = FindCachedName(cache, fileName);
+        if (cache->names[slot].entry == -1)
+        {
+            cache->names[slot].fileName = strdup(fileName);
+            if (cache->names[slot].fileName)
+            {
+                cache->names[slot].entry = index;
+                cache->nameCount++;
+            }
+        }
+        else
+            cache->names[slot].entry = index;
+    }
+
+    cache->entries[index].refCount++;
+    cache->entries[index].lastUsed = cache->clock;
+    EvictCachedTextures(intp);
+    return index;
+}
+
+static void ReleaseCachedTexture(InterpreterContext *intp, int index)
+{
+    TextureCache *cache = &intp->textureCache;
+    if (index < 0 || index >= cache->entryCount || cache->entries[index].refCount == 0)
+        return;
+
+    cache->entries[index].lastUsed = ++cache->clock;
+    if (--cache->entries[index].refCount == 0)
+        EvictCachedTextures(intp);
+}
+
+static int CompareAtlasEntries(const void *a, const void *b)
+{
+    return strcmp(((const AtlasEntry *)a)->fileName, ((const AtlasEntry *)b)->fileName);
+}
+
+// Entries are sorted by file name once packed
+static const AtlasEntry *FindAtlasEntry(const TextureAtlas *atlas, const char *fileName)
+{
+    if (!fileName || atlas->entryCount == 0)
+        return NULL;
+
+    AtlasEntry key = {.fileName = (char *)fileName};
+    return bsearch(&key, atlas->entries, atlas->entryCount, sizeof(AtlasEntry), CompareAtlasEntries);
+}
+
+// One run of the skyline: the top edge of everything packed so far between x and x + width
+typedef struct SkylineSpan
+{
+    int x;
+    int y;
+    int width;
+} SkylineSpan;
+
+typedef struct AtlasPageLayout
+{
+    SkylineSpan *spans;
+    int spanCount;
+    int usedWidth;
+    int usedHeight;
+} AtlasPageLayout;
+
+typedef struct PackedImage
+{
+    Image image;
+    int entry;
+} PackedImage;
+
+// Lowest y a box can rest at with its left edge on span index, -1 when it sticks out of the page
+static int FitOnSkyline(const AtlasPageLayout *layout, int index, int width, int height)
+{
+    if (layout->spans[index].x + width > ATLAS_PAGE_SIZE)
+        return -1;
+
+    int y = 0;
+    for (int i = index, remaining = width; remaining > 0; i++)
+    {
+        if (layout->spans[i].y > y)
+            y = layout->spans[i].y;
+        if (y + height > ATLAS_PAGE_SIZE)
+            return -1;
+        remaining -= layout->spans[i].width;
+    }
+    return y;
+}
+
+// Bottom left rule: the spot that leaves the box's bottom edge lowest, the narrowest span on ties
+static bool PlaceOnSkyline(AtlasPageLayout *layout, int width, int height, int *x, int *y)
+{
+    int best = -1;
+    int bestBottom = ATLAS_PAGE_SIZE + 1;
+    int bestWidth = ATLAS_PAGE_SIZE + 1;
+    for (int i = 0; i < layout->spanCount; i++)
+    {
+        int fitY = FitOnSkyline(layout, i, width, height);
+        if (fitY < 0)
+            continue;
+        if (fitY + height < bestBottom || (fitY + height == bestBottom && layout->spans[i].width < bestWidth))
+        {
+            best = i;
+            bestBottom = fitY + height;
+            bestWidth = layout->spans[i].width;
+        }
+    }
+    if (best == -1)
+        return false;
+
+    *x = layout->spans[best].x;
+    *y = bestBottom - height;
+
+    SkylineSpan *spans = layout->spans;
+    memmove(&spans[best + 1], &spans[best], sizeof(SkylineSpan) * (layout->spanCount - best));
+    spans[best] = (SkylineSpan){*x, bestBottom, width};
+    layout->spanCount++;
+
+    // Spans the box now covers shrink or go
+    for (int i = best + 1; i < layout->spanCount;)
+    {
+        int overlap = *x + width - spans[i].x;
+        if (overlap <= 0)
+            break;
+        if (spans[i].width > overlap)
+        {
+            spans[i].x += overlap;
+            spans[i].width -= overlap;
+            break;
+        }
+        memmove(&spans[i], &spans[i + 1], sizeof(SkylineSpan) * (layout->spanCount - i - 1));
+        layout->spanCount--;
+    }
+    for (int i = 0; i + 1 < layout->spanCount;)
+    {
+        if (spans[i].y == spans[i + 1].y)
+        {
+            spans[i].width += spans[i + 1].width;
+            memmove(&spans[i + 1], &spans[i + 2], sizeof(SkylineSpan) * (layout->spanCount - i - 2));
+            layout->spanCount--;
+        }
+        else
+            i++;
+    }
+
+    if (*x + width > layout->usedWidth)
+        layout->usedWidth = *x + width;
+    if (bestBottom > layout->usedHeight)
+        layout->usedHeight = bestBottom;
+    return true;
+}
+
+// Tallest first, then widest, keeps the skyline flat
+static int ComparePackedImages(const void *a, const void *b)
+{
+    const PackedImage *first = a;
+    const PackedImage *second = b;
+    if (first->image.height != second->image.height)
+        return second->image.height - first->image.height;
+    if (first->image.width != second->image.width)
+        return second->image.width - first->image.width;
+    return first->entry - second->entry;
+}
+
+static void FreePackedImages(PackedImage *images, int imageCount, AtlasPageLayout *layouts, int pageCount)
+{
+    for (int i = 0; i < imageCount; i++)
+    {
+        UnloadImage(images[i].image);
+    }
+    for (int i = 0; layouts && i < pageCount; i++)
+    {
+        free(layouts[i].spans);
+    }
+    free(images);
+    free(layouts);
+}
+
+static void FailTextureAtlas(InterpreterContext *intp, AtlasEntry *entries, int entryCount)
+{
+    for (int i = 0; entries && i < entryCount; i++)
+    {
+        free(entries[i].fileName);
+    }
+    free(entries);
+    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: texture atlas, sprites load their own textures{I109}"}, LOG_LEVEL_WARNING);
+}
+
+// Packs the image of every file a Create Sprite node names into as few pages as fit, so sprites sharing a page draw in one call.
+// Images larger than a page, and all of them when memory runs out, are left for their sprites to load on their own
+static void BuildTextureAtlas(InterpreterContext *intp, RuntimeGraphContext *runtime, BuildLookup *lookup)
+{
+    int spriteCount = 0;
+    for (int i = 0; i < runtime->nodeCount; i++)
+    {
+        if (runtime->nodes[i].type == NODE_CREATE_SPRITE)
+            spriteCount++;
+    }
+    if (spriteCount == 0)
+        return;
+
+    const char **fileNames = malloc(sizeof(char *) * spriteCount);
+    if (!fileNames)
+    {
+        FailTextureAtlas(intp, NULL, 0);
+        return;
+    }
+
+    int fileCount = 0;
+    for (int i = 0; i < runtime->nodeCount; i++)
+    {
+        RuntimePin *filePin = runtime->nodes[i].type == NODE_CREATE_SPRITE ? RuntimeInputPin(runtime, &runtime->nodes[i], 1) : NULL;
+        if (!filePin || filePin->valueIndex < 0 || filePin->valueIndex >= intp->valueCount || intp->values.types[filePin->valueIndex] != VAL_STRING)
+            continue;
+        const char *fileName = intp->values.strings[filePin->valueIndex];
+        if (!fileName || !fileName[0])
+            continue;
+
+        bool isListed = false;
+        for (int j = 0; j < fileCount && !isListed; j++)
+        {
+            isListed = strcmp(fileNames[j], fileName) == 0;
+        }
+        if (!isListed)
+            fileNames[fileCount++] = fileName;
+    }
+
+    // Hot patch: the running atlas is handed over when it already holds every file
+    if (lookup->previous && lookup->previous->atlas.entryCount > 0)
+    {
+        bool hasAll = true;
+        for (int i = 0; i < fileCount && hasAll; i++)
+        {
+            hasAll = FindAtlasEntry(&lookup->previous->atlas, fileNames[i]) != NULL;
+        }
+        if (hasAll)
+        {
+            intp->atlas = lookup->previous->atlas;
+            lookup->isAtlasTaken = true;
+            free(fileNames);
+            return;
+        }
+    }
+
+    AtlasEntry *entries = calloc(fileCount + 1, sizeof(AtlasEntry));
+    PackedImage *images = malloc(sizeof(PackedImage) * (fileCount + 1));
+    if (!entries || !images)
+    {
+        free(fileNames);
+        free(images);
+        FailTextureAtlas(intp, entries, 0);
+        return;
+    }
+
+    int entryCount = 0;
+    int imageCount = 0;
+    for (int i = 0; i < fileCount; i++)
+    {
+        char path[MAX_FILE_PATH];
+        strmac(path, MAX_FILE_PATH, "%s%c%s", intp->projectPath, PATH_SEPARATOR, fileNames[i]);
+        Image image = LoadImage(path);
+        // Files that do not load are left for the sprite to report
+        if (!image.data)
+            continue;
+
+        char *fileName = strdup(fileNames[i]);
+        if (!fileName)
+        {
+            UnloadImage(image);
+            free(fileNames);
+            FreePackedImages(images, imageCount, NULL, 0);
+            FailTextureAtlas(intp, entries, entryCount);
+            return;
+        }
+        entries[entryCount] = (AtlasEntry){fileName, -1, (Rectangle){0, 0, image.width, image.height}};
+
+        if (image.width + ATLAS_PADDING <= ATLAS_PAGE_SIZE && image.height + ATLAS_PADDING <= ATLAS_PAGE_SIZE)
+            images[imageCount++] = (PackedImage){image, entryCount};
+        else
+            UnloadImage(image);
+        entryCount++;
+    }
+    free(fileNames);
+
+    qsort(images, imageCount, sizeof(PackedImage), ComparePackedImages);
+
+    // A page never has more spans than images on it plus the first one
+    AtlasPageLayout *layouts = calloc(imageCount + 1, sizeof(AtlasPageLayout));
+    int pageCount = 0;
+    if (!layouts)
+    {
+        FreePackedImages(images, imageCount, NULL, 0);
+        FailTextureAtlas(intp, entries, entryCount);
+        return;
+    }
+
+    for (int i = 0; i < imageCount; i++)
+    {
+        int width = images[i].image.width + ATLAS_PADDING;
+        int height = images[i].image.height + ATLAS_PADDING;
+        int x = 0;
+        int y = 0;
+        int page = 0;
+        while (page < pageCount && !PlaceOnSkyline(&layouts[page], width, height, &x, &y))
+        {
+            page++;
+        }
+        if (page == pageCount)
+        {
+            layouts[page].spans = malloc(sizeof(SkylineSpan) * (imageCount + 1));
+            if (!layouts[page].spans)
+            {
+                FreePackedImages(images, imageCount, layouts, pageCount);
+                FailTextureAtlas(intp, entries, entryCount);
+                return;
+            }
+            layouts[page].spans[0] = (SkylineSpan){0, 0, ATLAS_PAGE_SIZE};
+            layouts[page].spanCount = 1;
+            pageCount++;
+            PlaceOnSkyline(&layouts[page], width, height, &x, &y);
+        }
+
+        AtlasEntry *entry = &entries[images[i].entry];
+        entry->page = page;
+        entry->source.x = x;
+        entry->source.y = y;
+    }
+
+    Texture2D *pages = calloc(pageCount + 1, sizeof(Texture2D));
+    Image *pageImages = calloc(pageCount + 1, sizeof(Image));
+    bool isOutOfMemory = !pages || !pageImages;
+    for (int i = 0; i < pageCount && !isOutOfMemory; i++)
+    {
+        pageImages[i] = (Image){
+            .data = calloc((size_t)layouts[i].usedWidth * layouts[i].usedHeight, 4),
+            .width = layouts[i].usedWidth,
+            .height = layouts[i].usedHeight,
+            .mipmaps = 1,
+            .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        isOutOfMemory = !pageImages[i].data;
+    }
+    if (isOutOfMemory)
+    {
+        for (int i = 0; pageImages && i < pageCount; i++)
+        {
+            free(pageImages[i].data);
+        }
+        free(pages);
+        free(pageImages);
+        FreePackedImages(images, imageCount, layouts, pageCount);
+        FailTextureAtlas(intp, entries, entryCount);
+        return;
+    }
+
+    for (int i = 0; i < imageCount; i++)
+    {
+        AtlasEntry *entry = &entries[images[i].entry];
+        Image *page = &pageImages[entry->page];
+        ImageFormat(&images[i].image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (images[i].image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        {
+            entry->page = -1;
+            continue;
+        }
+        for (int row = 0; row < images[i].image.height; row++)
+        {
+            memcpy((unsigned char *)page->data + (((size_t)entry->source.y + row) * page->width + (size_t)entry->source.x) * 4,
+                   (unsigned char *)images[i].image.data + (size_t)row * images[i].image.width * 4,
+                   (size_t)images[i].image.width * 4);
+        }
+    }
+
+    for (int i = 0; i < pageCount; i++)
+    {
+        pages[i] = LoadTextureFromImage(pageImages[i]);
+        free(pageImages[i].data);
+    }
+    free(pageImages);
+    FreePackedImages(images, imageCount, layouts, pageCount);
+
+    // A page the GPU refused leaves its sprites on their own textures
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (entries[i].page >= 0 && pages[entries[i].page].id == 0)
+            entries[i].page = -1;
+    }
+
+    qsort(entries, entryCount, sizeof(AtlasEntry), CompareAtlasEntries);
+    intp->atlas = (TextureAtlas){pages, pageCount, entries, entryCount};
+
+    if (pageCount > 0)
+    {
+        int packedCount = 0;
+        for (int i = 0; i < entryCount; i++)
+        {
+            if (entries[i].page >= 0)
+                packedCount++;
+        }
+        char message[MAX_LOG_MESSAGE_SIZE];
+        strmac(message, MAX_LOG_MESSAGE_SIZE, "Packed %d sprite textures into %d atlas page%s{I305}", packedCount, pageCount, pageCount == 1 ? "" : "s");
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = message}, LOG_LEVEL_NORMAL);
+    }
+}
+
+#define COLLISION_EPSILON 1e-4f
+
+static float Cross2(Vector2 o, Vector2 a, Vector2 b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static bool IsPointInTriangle(Vector2 p, Vector2 a, Vector2 b, Vector2 c)
+{
+    return Cross2(a, b, p) >= 0 && Cross2(b, c, p) >= 0 && Cross2(c, a, p) >= 0;
+}
+
+static bool IsSimplePolygon(const Vector2 *v, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i + 2; j < n; j++)
+        {
+            if (i == 0 && j == n - 1)
+                continue;
+            if (CheckCollisionLines(v[i], v[(i + 1) % n], v[j], v[(j + 1) % n], NULL))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Joins two pieces over their shared edge when the result is still convex
+static bool TryMergePieces(const Vector2 *v, int *a, int *aCount, const int *b, int bCount)
+{
+    for (int i = 0; i < *aCount; i++)
+    {
+        int from = a[i];
+        int to = a[(i + 1) % *aCount];
+        for (int j = 0; j < bCount; j++)
+        {
+            if (b[j] != to || b[(j + 1) % bCount] != from)
+                continue;
+
+            int merged[MAX_POLYGON_VERTICES];
+            int count = 0;
+            for (int k = 0; k < *aCount; k++)
+            {
+                merged[count++] = a[(i + 1 + k) % *aCount];
+            }
+            for (int k = 2; k < bCount && count < MAX_POLYGON_VERTICES; k++)
+            {
+                merged[count++] = b[(j + k) % bCount];
+            }
+            if (count != *aCount + bCount - 2)
+                return false;
+
+            for (int k = 0; k < count; k++)
+            {
+                if (Cross2(v[merged[(k + count - 1) % count]], v[merged[k]], v[merged[(k + 1) % count]]) < -COLLISION_EPSILON)
+                    return false;
+            }
+
+            memcpy(a, merged, sizeof(int) * count);
+            *aCount = count;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Ear clips a simple polygon into triangles, then merges neighbours while they stay convex (Hertel-Mehlhorn).
+// Returns 0 for outlines that cross themselves or have no area
+static int DecomposeConvex(const Vector2 *v, int n, int pieces[][MAX_POLYGON_VERTICES], int *pieceSizes)
+{
+    if (n < 3 || !IsSimplePolygon(v, n))
+        return 0;
+
+    float area = 0;
+    for (int i = 0; i < n; i++)
+    {
+        area += v[i].x * v[(i + 1) % n].y - v[(i + 1) % n].x * v[i].y;
+    }
+    if (fabsf(area) < COLLISION_EPSILON)
+        return 0;
+
+    int ring[MAX_POLYGON_VERTICES];
+    int ringCount = n;
+    for (int i = 0; i < n; i++)
+    {
+        ring[i] = area > 0 ? i : n - 1 - i;
+    }
+
+    int pieceCount = 0;
+    while (ringCount > 3)
+    {
+        bool isClipped = false;
+        for (int i = 0; i < ringCount && !isClipped; i++)
+        {
+            int prev = ring[(i + ringCount - 1) % ringCount];
+            int curr = ring[i];
+            int next = ring[(i + 1) % ringCount];
+            if (Cross2(v[prev], v[curr], v[next]) <= COLLISION_EPSILON)
+                continue;
+
+            bool isEar = true;
+            for (int k = 0; k < ringCount && isEar; k++)
+            {
+                int other = ring[k];
+                if (other != prev && other != curr && other != next && IsPointInTriangle(v[other], v[prev], v[curr], v[next]))
+                    isEar = false;
+            }
+            if (!isEar)
+                continue;
+
+            pieces[pieceCount][0] = prev;
+            pieces[pieceCount][1] = curr;
+            pieces[pieceCount][2] = next;
+            pieceSizes[pieceCount++] = 3;
+
+            for (int k = i; k < ringCount - 1; k++)
+            {
+                ring[k] = ring[k + 1];
+            }
+            ringCount--;
+            isClipped = true;
+        }
+
+        if (!isClipped)
+            return 0;
+    }
+
+    if (Cross2(v[ring[0]], v[ring[1]], v[ring[2]]) > COLLISION_EPSILON)
+    {
+        memcpy(pieces[pieceCount], ring, sizeof(int) * 3);
+        pieceSizes[pieceCount++] = 3;
+    }
+
+    bool isMerged = true;
+    while (isMerged)
+    {
+        isMerged = false;
+        for (int a = 0; a < pieceCount && !isMerged; a++)
+        {
+            for (int b = a + 1; b < pieceCount && !isMerged; b++)
+            {
+                if (TryMergePieces(v, pieces[a], &pieceSizes[a], pieces[b], pieceSizes[b]))
+                {
+                    pieceCount--;
+                    memcpy(pieces[b], pieces[pieceCount], sizeof(int) * pieceSizes[pieceCount]);
+                    pieceSizes[b] = pieceSizes[pieceCount];
+                    isMerged = true;
+                }
+            }
+        }
+    }
+
+    return pieceCount;
+}
+
+#define HITBOX_FIT_TOLERANCE 0.05f
+#define HITBOX_FIT_EDGE_SAMPLES 4
+
+static float DistanceToSegment(Vector2 point, Vector2 a, Vector2 b)
+{
+    Vector2 ab = Vector2Subtract(b, a);
+    float lengthSqr = Vector2DotProduct(ab, ab);
+    float t = lengthSqr > 0 ? Clamp(Vector2DotProduct(Vector2Subtract(point, a), ab) / lengthSqr, 0, 1) : 0;
+    return Vector2Distance(point, Vector2Add(a, Vector2Scale(ab, t)));
+}
+
+// Points a fit is judged by: every vertex plus evenly spaced points along each edge
+static int SampleOutline(const Vector2 *v, int n, Vector2 *samples)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < HITBOX_FIT_EDGE_SAMPLES; k++)
+        {
+            samples[count++] = Vector2Lerp(v[i], v[(i + 1) % n], (float)k / HITBOX_FIT_EDGE_SAMPLES);
+        }
+    }
+    return count;
+}
+
+// Tries circle, rectangle and capsule in that order and takes the first one whose outline stays within
+// HITBOX_FIT_TOLERANCE of the polygon's size and whose area stays within HITBOX_FIT_TOLERANCE of its area.
+// A fit picked in the hitbox editor is taken as is, HITBOX_POLY means the polygon is collided as drawn
+FittedHitbox FitPolygonHitbox(const Polygon *polygon)
+{
+    FittedHitbox fitted = {.type = HITBOX_POLY};
+    int n = polygon->count > MAX_POLYGON_VERTICES ? MAX_POLYGON_VERTICES : polygon->count;
+    if (n < 3 || polygon->fit == HITBOX_FIT_POLYGON || polygon->fit >= HITBOX_FIT_COUNT)
+        return fitted;
+
+    const Vector2 *v = polygon->vertices;
+    bool isForced = polygon->fit != HITBOX_FIT_AUTO;
+
+    float area = 0;
+    Vector2 centroid = {0, 0};
+    Vector2 min = {INFINITY, INFINITY};
+    Vector2 max = {-INFINITY, -INFINITY};
+    for (int i = 0; i < n; i++)
+    {
+        Vector2 a = v[i];
+        Vector2 b = v[(i + 1) % n];
+        float cross = a.x * b.y - b.x * a.y;
+        area += cross;
+        centroid = Vector2Add(centroid, Vector2Scale(Vector2Add(a, b), cross));
+        min = Vector2Min(min, a);
+        max = Vector2Max(max, a);
+    }
+    if (fabsf(area) < COLLISION_EPSILON)
+        return fitted;
+    centroid = Vector2Scale(centroid, 1.0f / (3 * area));
+    area = fabsf(area) / 2;
+
+    Vector2 samples[MAX_POLYGON_VERTICES * HITBOX_FIT_EDGE_SAMPLES];
+    int sampleCount = SampleOutline(v, n, samples);
+    float tolerance = HITBOX_FIT_TOLERANCE * fmaxf(max.x - min.x, max.y - min.y);
+
+    // Circle around the centroid at the outline's average distance from it
+    if (!isForced || polygon->fit == HITBOX_FIT_CIRCLE)
+    {
+        float radius = 0;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            radius += Vector2Distance(samples[i], centroid);
+        }
+        radius /= sampleCount;
+
+        float deviation = 0;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            deviation = fmaxf(deviation, fabsf(Vector2Distance(samples[i], centroid) - radius));
+        }
+
+        if (isForced || (deviation <= tolerance && fabsf(PI * radius * radius - area) <= HITBOX_FIT_TOLERANCE * area))
+            return (FittedHitbox){.type = HITBOX_CIRCLE, .offset = centroid, .radius = radius};
+    }
+
+    // The outline always lies inside its bounds, so the area alone tells how much the rectangle adds
+    if (!isForced || polygon->fit == HITBOX_FIT_RECT)
+    {
+        Vector2 size = Vector2Subtract(max, min);
+        if (isForced || area >= (1 - HITBOX_FIT_TOLERANCE) * size.x * size.y)
+            return (FittedHitbox){.type = HITBOX_RECT, .offset = min, .rectSize = size};
+    }
+
+    // Capsule along the outline's principal axis, as thick as the outline is across it
+    if (!isForced || polygon->fit == HITBOX_FIT_CAPSULE)
+    {
+        float xx = 0, xy = 0, yy = 0;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            Vector2 d = Vector2Subtract(samples[i], centroid);
+            xx += d.x * d.x;
+            xy += d.x * d.y;
+            yy += d.y * d.y;
+        }
+        float angle = 0.5f * atan2f(2 * xy, xx - yy);
+        Vector2 along = {cosf(angle), sinf(angle)};
+        Vector2 across = {-along.y, along.x};
+
+        float minAlong = INFINITY, maxAlong = -INFINITY, minAcross = INFINITY, maxAcross = -INFINITY;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            Vector2 d = Vector2Subtract(samples[i], centroid);
+            minAlong = fminf(minAlong, Vector2DotProduct(d, along));
+            maxAlong = fmaxf(maxAlong, Vector2DotProduct(d, along));
+            minAcross = fminf(minAcross, Vector2DotProduct(d, across));
+            maxAcross = fmaxf(maxAcross, Vector2DotProduct(d, across));
+        }
+
+        float radius = (maxAcross - minAcross) / 2;
+        float halfLength = fmaxf((maxAlong - minAlong) / 2 - radius, 0);
+        Vector2 center = Vector2Add(centroid, Vector2Add(Vector2Scale(along, (minAlong + maxAlong) / 2), Vector2Scale(across, (minAcross + maxAcross) / 2)));
+        Vector2 axis = Vector2Scale(along, halfLength);
+
+        float deviation = 0;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            deviation = fmaxf(deviation, fabsf(DistanceToSegment(samples[i], Vector2Subtract(center, axis), Vector2Add(center, axis)) - radius));
+        }
+        float capsuleArea = PI * radius * radius + 4 * radius * halfLength;
+
+        if (isForced || (halfLength > tolerance && deviation <= tolerance && fabsf(capsuleArea - area) <= HITBOX_FIT_TOLERANCE * area))
+            return (FittedHitbox){.type = HITBOX_CAPSULE, .offset = center, .radius = radius, .capsuleAxis = axis};
+    }
+
+    return fitted;
+}
+
+// Allocates every component's world-space buffers and splits polygon hitboxes into convex pieces
+static bool BuildCollisionShapes(InterpreterContext *intp)
+{
+    intp->collisionShapes = ArenaAlloc(&intp->arena, sizeof(CollisionShape) * (intp->componentCount + 1));
+    if (!intp->collisionShapes)
+        return false;
+
+    static int pieces[MAX_POLYGON_VERTICES][MAX_POLYGON_VERTICES];
+    int pieceSizes[MAX_POLYGON_VERTICES];
+
+    for (int i = 0; i < intp->componentCount; i++)
+    {
+        SceneComponent *c = &intp->components[i];
+        Hitbox *hitbox = c->isSprite ? &c->sprite.hitbox : &c->prop.hitbox;
+        CollisionShape *shape = &intp->collisionShapes[i];
+
+        int pieceCount = 0;
+        if (hitbox->type == HITBOX_POLY)
+        {
+            shape->vertexCount = hitbox->polygonHitbox.count < 0 ? 0 : hitbox->polygonHitbox.count > MAX_POLYGON_VERTICES ? MAX_POLYGON_VERTICES : hitbox->polygonHitbox.count;
+            pieceCount = DecomposeConvex(hitbox->polygonHitbox.vertices, shape->vertexCount, pieces, pieceSizes);
+            shape->fitted = FitPolygonHitbox(&hitbox->polygonHitbox);
+        }
+        else if (hitbox->type == HITBOX_RECT)
+        {
+            shape->vertexCount = 4;
+            pieceCount = 1;
+            pieceSizes[0] = 4;
+            for (int k = 0; k < 4; k++)
+            {
+                pieces[0][k] = k;
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        int indexCount = 0;
+        for (int k = 0; k < pieceCount; k++)
+        {
+            indexCount += pieceSizes[k];
+        }
+
+        // Room for the corners of a fitted rectangle too
+        shape->vertices = ArenaAlloc(&intp->arena, sizeof(Vector2) * ((shape->vertexCount > 4 ? shape->vertexCount : 4) + 1));
+        shape->pieceIndexes = ArenaAlloc(&intp->arena, sizeof(int) * (indexCount + 1));
+        shape->pieces = ArenaAlloc(&intp->arena, sizeof(ConvexPiece) * (pieceCount + 1));
+        if (!shape->vertices || !shape->pieceIndexes || !shape->pieces)
+            return false;
+
+        int first = 0;
+        for (int k = 0; k < pieceCount; k++)
+        {
+            shape->pieces[k].first = first;
+            shape->pieces[k].count = pieceSizes[k];
+            memcpy(&shape->pieceIndexes[first], pieces[k], sizeof(int) * pieceSizes[k]);
+            first += pieceSizes[k];
+        }
+        shape->pieceCount = pieceCount;
+    }
+
+    return true;
+}
+
+static RuntimeGraphContext LowerGraph(GraphContext *graph, InterpreterContext *intp, BuildLookup *lookup)
+{
+    RuntimeGraphContext runtime = {0};
+
+    runtime.nodeCount = graph->nodeCount;
+    runtime.nodes = ArenaAlloc(&intp->arena, sizeof(RuntimeNode) * graph->nodeCount);
+    runtime.nodeInfos = ArenaAlloc(&intp->arena, sizeof(RuntimeNodeInfo) * (graph->nodeCount + 1));
+
+    if (!runtime.nodes || !runtime.nodeInfos)
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: nodes{I200}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+
+    runtime.pinCount = 0;
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        runtime.pinCount += graph->nodes[i].inputCount + graph->nodes[i].outputCount;
+    }
+
+    runtime.pins = ArenaAlloc(&intp->arena, sizeof(RuntimePin) * runtime.pinCount);
+    runtime.pinInfos = ArenaAlloc(&intp->arena, sizeof(RuntimePinInfo) * runtime.pinCount);
+
+    if (!runtime.pins || !runtime.pinInfos)
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: pins{I201}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+
+    int nextPin = 0;
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        Node *srcNode = &graph->nodes[i];
+        RuntimeNode *dstNode = &runtime.nodes[i];
+
+        dstNode->index = i;
+        dstNode->type = srcNode->type;
+        dstNode->firstPin = nextPin;
+        dstNode->inputCount = srcNode->inputCount;
         dstNode->outputCount = srcNode->outputCount;
 
-        for (int j = 0; j < srcNode->inputCount; j++)
+        for (int j = 0; j < srcNode->inputCount + srcNode->outputCount; j++)
+        {
+            bool isInput = j < srcNode->inputCount;
+            int pinID = isInput ? srcNode->inputPins[j] : srcNode->outputPins[j - srcNode->inputCount];
+
+            int pinIndex = IdMapGet(&lookup->pinIndexById, pinID);
+            if (pinIndex < 0)
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = isInput ? "Input pin mapping failed{I202}" : "Output pin mapping failed{I203}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+
+            Pin *src = &graph->pins[pinIndex];
+            RuntimePin *dst = &runtime.pins[nextPin];
+
+            dst->type = src->type;
+            dst->nodeIndex = i;
+            dst->isInput = src->isInput;
+            dst->valueIndex = -1;
+            dst->pickedOption = src->pickedOption;
+            dst->nextNodeIndex = -1;
+            dst->componentIndex = -1;
+
+            runtime.pinInfos[nextPin].id = src->id;
+            lookup->runtimePinByGraphPin[pinIndex] = nextPin;
+            strmac(runtime.pinInfos[nextPin].textFieldValue, sizeof(runtime.pinInfos[nextPin].textFieldValue), "%s", src->textFieldValue);
+
+            nextPin++;
+        }
+    }
+
+    ComputeNodeInfos(graph, lookup, runtime.nodeInfos);
+
+    int totalOutputPins = 0;
+    int totalComponents = 0;
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        RuntimeNode *node = &runtime.nodes[i];
+        for (int j = 0; j < node->outputCount; j++)
+        {
+            if (RuntimeOutputPin(&runtime, node, j) == NULL)
+            {
+                continue;
+            }
+            if (RuntimeOutputPin(&runtime, node, j)->type != PIN_FLOW)
+            {
+                totalOutputPins++;
+            }
+        }
+
+        if (node->type == NODE_CREATE_SPRITE || node->type == NODE_DRAW_PROP_TEXTURE || node->type == NODE_DRAW_PROP_RECTANGLE || node->type == NODE_DRAW_PROP_CIRCLE)
+        {
+            totalComponents++;
+        }
+    }
+
+    int expectedValues = totalOutputPins + SPECIAL_VALUES_COUNT;
+    if (!AllocValueStore(&intp->arena, &intp->values, expectedValues))
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: values{I204}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+
+    intp->values.types[SPECIAL_VALUE_ERROR] = VAL_STRING;
+    intp->values.strings[SPECIAL_VALUE_ERROR] = ArenaString(&intp->arena, "Error value", 11);
+    intp->values.names[SPECIAL_VALUE_ERROR] = ArenaString(&intp->arena, "Error value", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_MOUSE_X] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_MOUSE_X] = ArenaString(&intp->arena, "Mouse X", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_MOUSE_Y] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_MOUSE_Y] = ArenaString(&intp->arena, "Mouse Y", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_SCREEN_WIDTH] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_SCREEN_WIDTH] = ArenaString(&intp->arena, "Screen Width", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_SCREEN_HEIGHT] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_SCREEN_HEIGHT] = ArenaString(&intp->arena, "Screen Height", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_CAMERA_X] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_CAMERA_X] = ArenaString(&intp->arena, "Camera X", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_CAMERA_Y] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_CAMERA_Y] = ArenaString(&intp->arena, "Camera Y", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_CAMERA_ZOOM] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_CAMERA_ZOOM] = ArenaString(&intp->arena, "Camera Zoom", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_CAMERA_ROTATION] = VAL_NUMBER;
+    intp->values.names[SPECIAL_VALUE_CAMERA_ROTATION] = ArenaString(&intp->arena, "Camera Rotation", MAX_VARIABLE_NAME_SIZE);
+    intp->values.types[SPECIAL_VALUE_UNLINKED] = VAL_NUMBER;
+    intp->values.numbers[SPECIAL_VALUE_UNLINKED] = 0;
+    intp->values.booleans[SPECIAL_VALUE_UNLINKED] = false;
+    intp->values.strings[SPECIAL_VALUE_UNLINKED] = ArenaString(&intp->arena, "", 1);
+    intp->values.colors[SPECIAL_VALUE_UNLINKED] = (Color){0, 0, 0, 0};
+    intp->values.componentIndexes[SPECIAL_VALUE_UNLINKED] = -1;
+    intp->values.names[SPECIAL_VALUE_UNLINKED] = ArenaString(&intp->arena, "Unlinked input", MAX_VARIABLE_NAME_SIZE);
+    intp->valueCount = SPECIAL_VALUES_COUNT;
+
+    intp->components = ArenaAlloc(&intp->arena, sizeof(SceneComponent) * (totalComponents + 1));
+    if (!intp->components)
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: components{I205}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+    intp->componentCount = 0;
+
+    intp->varIndexes = ArenaAlloc(&intp->arena, sizeof(int) * (totalOutputPins + 1));
+    if (!intp->varIndexes)
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: varIndexes{I206}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+    intp->varCount = 0;
+
+    if (!AllocRigidBodies(&intp->arena, &intp->bodies, totalComponents + 1, graph->nodeCount))
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: rigid bodies{I207}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        RuntimeNode *node = &runtime.nodes[i];
+        Node *srcNode = &graph->nodes[i];
+
+        switch (node->type)
+        {
+        case NODE_LITERAL_NUMBER:
+            if (!RuntimeInputPin(&runtime, node, 0))
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+            intp->values.numbers[intp->valueCount] = strtof(runtime.pinInfos[node->firstPin].textFieldValue, NULL);
+            intp->values.types[intp->valueCount] = VAL_NUMBER;
+            intp->values.isVariable[intp->valueCount] = false;
+            intp->values.names[intp->valueCount] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = intp->valueCount;
+            intp->valueCount++;
+            continue;
+        case NODE_LITERAL_STRING:
+            if (!RuntimeInputPin(&runtime, node, 0))
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+            intp->values.strings[intp->valueCount] = ArenaString(&intp->arena, runtime.pinInfos[node->firstPin].textFieldValue, MAX_LITERAL_NODE_FIELD_SIZE);
+            intp->values.types[intp->valueCount] = VAL_STRING;
+            intp->values.isVariable[intp->valueCount] = false;
+            intp->values.names[intp->valueCount] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = intp->valueCount;
+            intp->valueCount++;
+            continue;
+        case NODE_LITERAL_BOOL:
+            if (!RuntimeInputPin(&runtime, node, 0))
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+            if (strcmp(runtime.pinInfos[node->firstPin].textFieldValue, "true") == 0)
+            {
+                intp->values.booleans[intp->valueCount] = true;
+            }
+            else
+            {
+                intp->values.booleans[intp->valueCount] = false;
+            }
+            intp->values.types[intp->valueCount] = VAL_BOOL;
+            intp->values.isVariable[intp->valueCount] = false;
+            intp->values.names[intp->valueCount] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = intp->valueCount;
+            intp->valueCount++;
+            continue;
+        case NODE_LITERAL_COLOR:
+            if (!RuntimeInputPin(&runtime, node, 0))
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+            unsigned int hexValue;
+            if (sscanf(runtime.pinInfos[node->firstPin].textFieldValue, "%x", &hexValue) == 1)
+            {
+                Color color = {(hexValue >> 24) & 0xFF, (hexValue >> 16) & 0xFF, (hexValue >> 8) & 0xFF, hexValue & 0xFF};
+                intp->values.colors[intp->valueCount] = color;
+                intp->values.types[intp->valueCount] = VAL_COLOR;
+                intp->values.isVariable[intp->valueCount] = false;
+                intp->values.names[intp->valueCount] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                if (RuntimeOutputPin(&runtime, node, 0)){
+                    RuntimeOutputPin(&runtime, node, 0)->valueIndex = intp->valueCount;
+                }
+                intp->valueCount++;
+            }
+            else
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Error: Invalid color{I209}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+            continue;
+        default:
+            break;
+        }
+
+        for (int j = 0; j < node->outputCount; j++)
+        {
+            RuntimePin *pin = RuntimeOutputPin(&runtime, node, j);
+            if (!pin)
+                continue;
+            if (pin->type == PIN_FLOW)
+                continue;
+
+            int idx = intp->valueCount;
+
+            bool isVariable = false;
+            if (node->type == NODE_CREATE_NUMBER || node->type == NODE_CREATE_STRING || node->type == NODE_CREATE_BOOL || node->type == NODE_CREATE_COLOR || node->type == NODE_CREATE_SPRITE)
+            {
+                isVariable = true;
+                if (RuntimeInputPin(&runtime, node, 1))
+                    RuntimeInputPin(&runtime, node, 1)->valueIndex = idx;
+            }
+
+            switch (pin->type)
+            {
+            case PIN_NUM:
+                intp->values.numbers[idx] = 0;
+                intp->values.types[idx] = VAL_NUMBER;
+                intp->values.isVariable[idx] = isVariable;
+                intp->values.names[idx] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                break;
+            case PIN_STRING:
+                intp->values.strings[idx] = ArenaString(&intp->arena, "null", MAX_VARIABLE_NAME_SIZE);
+                intp->values.types[idx] = VAL_STRING;
+                intp->values.isVariable[idx] = isVariable;
+                intp->values.names[idx] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                break;
+            case PIN_BOOL:
+                intp->values.booleans[idx] = false;
+                intp->values.types[idx] = VAL_BOOL;
+                intp->values.isVariable[idx] = isVariable;
+                intp->values.names[idx] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                break;
+            case PIN_COLOR:
+                intp->values.colors[idx] = (Color){255, 255, 255, 255};
+                intp->values.types[idx] = VAL_COLOR;
+                intp->values.isVariable[idx] = isVariable;
+                intp->values.names[idx] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                break;
+            case PIN_SPRITE:
+                intp->values.types[idx] = VAL_SPRITE;
+                intp->values.isVariable[idx] = isVariable;
+                intp->values.names[idx] = ArenaString(&intp->arena, srcNode->name, MAX_VARIABLE_NAME_SIZE);
+                break;
+            default:
+                break;
+            }
+
+            intp->values.componentIndexes[idx] = -1;
+
+            if (isVariable)
+            {
+                intp->varIndexes[intp->varCount] = idx;
+                intp->varCount++;
+            }
+
+            if (intp->valueCount > expectedValues)
+            {
+                intp->buildErrorOccured = true;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Value array overflow{I20A}"}, LOG_LEVEL_ERROR);
+                return runtime;
+            }
+
+            pin->valueIndex = idx;
+            intp->valueCount++;
+        }
+    }
+
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        RuntimeNode *node = &runtime.nodes[i];
+        Node *srcNode = &graph->nodes[i];
+
+        bool valueFound = false;
+
+        switch (graph->nodes[i].type)
+        {
+        case NODE_GET_VARIABLE:
+        {
+            RuntimePin *namePin = RuntimeInputPin(&runtime, node, 0);
+            RuntimePin *outPin = RuntimeOutputPin(&runtime, node, 0);
+            int j = namePin && namePin->pickedOption >= 0 && namePin->pickedOption < graph->variablesCount ? lookup->variableNodes[namePin->pickedOption] : -1;
+            if (j >= 0 && j != i)
+            {
+                if (RuntimeOutputPin(&runtime, &runtime.nodes[j], 1) && outPin)
+                    outPin->valueIndex = RuntimeOutputPin(&runtime, &runtime.nodes[j], 1)->valueIndex;
+                valueFound = true;
+            }
+            if (!valueFound)
+            {
+                if (outPin)
+                    outPin->valueIndex = 0;
+            }
+            continue;
+        }
+        case NODE_SET_VARIABLE:
+        {
+            RuntimePin *namePin = RuntimeInputPin(&runtime, node, 1);
+            RuntimePin *outPin = RuntimeOutputPin(&runtime, node, 1);
+            int j = namePin && namePin->pickedOption >= 0 && namePin->pickedOption < graph->variablesCount ? lookup->variableNodes[namePin->pickedOption] : -1;
+            if (j >= 0 && j != i)
+            {
+                if (RuntimeOutputPin(&runtime, &runtime.nodes[j], 1) && outPin)
+                    outPin->valueIndex = RuntimeOutputPin(&runtime, &runtime.nodes[j], 1)->valueIndex;
+                valueFound = true;
+            }
+            if (!valueFound)
+            {
+                if (outPin)
+                    outPin->valueIndex = 0;
+            }
+            continue;
+        }
+        case NODE_GET_SCREEN_WIDTH:
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = SPECIAL_VALUE_SCREEN_WIDTH;
+            continue;
+        case NODE_GET_SCREEN_HEIGHT:
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = SPECIAL_VALUE_SCREEN_HEIGHT;
+            continue;
+        case NODE_GET_MOUSE_X:
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = SPECIAL_VALUE_MOUSE_X;
+            continue;
+        case NODE_GET_MOUSE_Y:
+            if (RuntimeOutputPin(&runtime, node, 0))
+                RuntimeOutputPin(&runtime, node, 0)->valueIndex = SPECIAL_VALUE_MOUSE_Y;
+            continue;
+        case NODE_GET_CAMERA:
+            for (int k = 0; k < 4; k++)
+            {
+                if (RuntimeOutputPin(&runtime, node, k))
+                    RuntimeOutputPin(&runtime, node, k)->valueIndex = SPECIAL_VALUE_CAMERA_X + k;
+            }
+            continue;
+        default:
+            continue;
+        }
+    }
+
+    for (int i = 0; i < graph->linkCount; i++)
+    {
+        int inputIndex = IdMapGet(&lookup->pinIndexById, graph->links[i].inputPinID);
+        int outputIndex = IdMapGet(&lookup->pinIndexById, graph->links[i].outputPinID);
+        if (inputIndex != -1)
+            inputIndex = lookup->runtimePinByGraphPin[inputIndex];
+        if (outputIndex != -1)
+            outputIndex = lookup->runtimePinByGraphPin[outputIndex];
+
+        if (inputIndex == -1 || outputIndex == -1)
+        {
+            intp->buildErrorOccured = true;
+            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Link pin missing{I20B}"}, LOG_LEVEL_ERROR);
+            return runtime;
+        }
+
+        RuntimePin *inputPin = &runtime.pins[inputIndex];
+        RuntimePin *outputPin = &runtime.pins[outputIndex];
+
+        inputPin->valueIndex = outputPin->valueIndex;
+
+        if (inputPin->type == PIN_FLOW && outputPin->type == PIN_FLOW)
+        {
+            if (inputPin->nodeIndex >= 0)
+                outputPin->nextNodeIndex = inputPin->nodeIndex;
+        }
+    }
+
+    // Unlinked inputs read the shared zero/false/empty slot, so every opcode sees a valid operand in both backends
+    for (int i = 0; i < runtime.pinCount; i++)
+    {
+        RuntimePin *pin = &runtime.pins[i];
+        if (pin->isInput && pin->type != PIN_FLOW && pin->valueIndex == -1)
+            pin->valueIndex = SPECIAL_VALUE_UNLINKED;
+    }
+
+    BuildTextureAtlas(intp, &runtime, lookup);
+
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        RuntimeNode *node = &runtime.nodes[i];
+
+        switch (node->type)
+        {
+        case NODE_CREATE_SPRITE:
+            intp->components[intp->componentCount].isSprite = true;
+            intp->components[intp->componentCount].isVisible = false;
+            {
+                int fileIndex = -1;
+                int wIndex = -1;
+                int hIndex = -1;
+                int layerIndex = -1;
+
+                if (RuntimeInputPin(&runtime, node, 1))
+                    fileIndex = RuntimeInputPin(&runtime, node, 1)->valueIndex;
+                if (RuntimeInputPin(&runtime, node, 2))
+                    wIndex = RuntimeInputPin(&runtime, node, 2)->valueIndex;
+                if (RuntimeInputPin(&runtime, node, 3))
+                    hIndex = RuntimeInputPin(&runtime, node, 3)->valueIndex;
+                if (RuntimeInputPin(&runtime, node, 4))
+                    layerIndex = RuntimeInputPin(&runtime, node, 4)->valueIndex;
+
+                const AtlasEntry *entry = fileIndex != -1 && fileIndex < intp->valueCount ? FindAtlasEntry(&intp->atlas, intp->values.strings[fileIndex]) : NULL;
+                if (entry && entry->page >= 0)
+                {
+                    intp->components[intp->componentCount].sprite.texture = intp->atlas.pages[entry->page];
+                    intp->components[intp->componentCount].sprite.source = entry->source;
+                    intp->components[intp->componentCount].sprite.isInAtlas = true;
+                    intp->components[intp->componentCount].sprite.cachedTexture = -1;
+                }
+                else if (fileIndex != -1 && fileIndex < intp->valueCount && intp->values.strings[fileIndex] && intp->values.strings[fileIndex][0])
+                {
+                    int cached = AcquireCachedTexture(intp, intp->values.strings[fileIndex]);
+                    if (cached == -1)
+                    {
+                        intp->buildErrorOccured = true;
+                        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Failed to load texture{I20C}"}, LOG_LEVEL_ERROR);
+                        return runtime;
+                    }
+                    else
+                    {
+                        Texture2D tex = intp->textureCache.entries[cached].texture;
+                        intp->components[intp->componentCount].sprite.texture = tex;
+                        intp->components[intp->componentCount].sprite.source = (Rectangle){0, 0, tex.width, tex.height};
+                        intp->components[intp->componentCount].sprite.cachedTexture = cached;
+                    }
+                }
+                else
+                {
+                    intp->buildErrorOccured = true;
+                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Invalid texture input{I20D}"}, LOG_LEVEL_ERROR);
+                    return runtime;
+                }
+
+                if (wIndex != -1 && wIndex != SPECIAL_VALUE_UNLINKED && wIndex < intp->valueCount)
+                    intp->components[intp->componentCount].sprite.width = intp->values.numbers[wIndex];
+                if (hIndex != -1 && hIndex != SPECIAL_VALUE_UNLINKED && hIndex < intp->valueCount)
+                    intp->components[intp->componentCount].sprite.height = intp->values.numbers[hIndex];
+                if (layerIndex != -1 && layerIndex != SPECIAL_VALUE_UNLINKED && layerIndex < intp->valueCount)
+                {
+                    if (intp->values.numbers[layerIndex] < COMPONENT_LAYER_COUNT)
+                    {
+                        intp->components[intp->componentCount].sprite.layer = intp->values.numbers[layerIndex];
+                    }
+                    else if (intp->values.numbers[layerIndex] < 0)
+                    {
+                        intp->components[intp->componentCount].sprite.layer = 0;
+                    }
+                    else
+                    {
+                        intp->components[intp->componentCount].sprite.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
+                    }
+                }
+
+                // Hitboxes are drawn polygons, the circle, rectangle or capsule they collide as is fitted when the collision shape is built
+                intp->components[intp->componentCount].sprite.hitbox.type = HITBOX_POLY;
+
+                int hitboxPin = graph->nodes[i].inputPins[5] ? IdMapGet(&lookup->pinIndexById, graph->nodes[i].inputPins[5]) : -1;
+                if (hitboxPin != -1)
+                {
+                    intp->components[intp->componentCount].sprite.hitbox.polygonHitbox = graph->pins[hitboxPin].hitbox;
+                }
+
+                if (RuntimeOutputPin(&runtime, node, 1))
+                    RuntimeOutputPin(&runtime, node, 1)->componentIndex = intp->componentCount;
+
+                NameMapPut(&lookup->spriteComponentByName, graph->nodes[i].name, intp->componentCount, true);
+
+                intp->componentCount++;
+            }
+            break;
+        case NODE_DRAW_PROP_TEXTURE:
+            continue;
+        case NODE_DRAW_PROP_RECTANGLE:
+            intp->components[intp->componentCount].isSprite = false;
+            intp->components[intp->componentCount].isVisible = false;
+            intp->components[intp->componentCount].prop.propType = PROP_RECTANGLE;
+            if (RuntimeInputPin(&runtime, node, 3) && RuntimeInputPin(&runtime, node, 3)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.width = intp->values.numbers[RuntimeInputPin(&runtime, node, 3)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 4) && RuntimeInputPin(&runtime, node, 4)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.height = intp->values.numbers[RuntimeInputPin(&runtime, node, 4)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 1) && RuntimeInputPin(&runtime, node, 1)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.position.x = intp->values.numbers[RuntimeInputPin(&runtime, node, 1)->valueIndex] - intp->components[intp->componentCount].prop.width / 2;
+            if (RuntimeInputPin(&runtime, node, 2) && RuntimeInputPin(&runtime, node, 2)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.position.y = intp->values.numbers[RuntimeInputPin(&runtime, node, 2)->valueIndex] - intp->components[intp->componentCount].prop.height / 2;
+            if (RuntimeInputPin(&runtime, node, 5) && RuntimeInputPin(&runtime, node, 5)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.color = intp->values.colors[RuntimeInputPin(&runtime, node, 5)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 6) && RuntimeInputPin(&runtime, node, 6)->valueIndex < intp->valueCount)
+            {
+                if (intp->values.numbers[RuntimeInputPin(&runtime, node, 6)->valueIndex] < COMPONENT_LAYER_COUNT)
+                {
+                    intp->components[intp->componentCount].prop.layer = intp->values.numbers[RuntimeInputPin(&runtime, node, 6)->valueIndex];
+                }
+                else if (intp->values.numbers[RuntimeInputPin(&runtime, node, 6)->valueIndex] < 0)
+                {
+                    intp->components[intp->componentCount].prop.layer = 0;
+                }
+                else
+                {
+                    intp->components[intp->componentCount].prop.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
+                }
+            }
+
+            intp->components[intp->componentCount].prop.hitbox.type = HITBOX_RECT;
+            intp->components[intp->componentCount].prop.hitbox.rectHitboxSize = (Vector2){intp->components[intp->componentCount].prop.width, intp->components[intp->componentCount].prop.height};
+            intp->components[intp->componentCount].prop.hitbox.offset = (Vector2){0, 0};
+
+            if (RuntimeOutputPin(&runtime, node, 1))
+                RuntimeOutputPin(&runtime, node, 1)->componentIndex = intp->componentCount;
+            intp->componentCount++;
+            continue;
+        case NODE_DRAW_PROP_CIRCLE:
+            intp->components[intp->componentCount].isSprite = false;
+            intp->components[intp->componentCount].isVisible = false;
+            intp->components[intp->componentCount].prop.propType = PROP_CIRCLE;
+            if (RuntimeInputPin(&runtime, node, 1) && RuntimeInputPin(&runtime, node, 1)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.position.x = intp->values.numbers[RuntimeInputPin(&runtime, node, 1)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 2) && RuntimeInputPin(&runtime, node, 2)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.position.y = intp->values.numbers[RuntimeInputPin(&runtime, node, 2)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 3) && RuntimeInputPin(&runtime, node, 3)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.width = intp->values.numbers[RuntimeInputPin(&runtime, node, 3)->valueIndex] * 2;
+            if (RuntimeInputPin(&runtime, node, 3) && RuntimeInputPin(&runtime, node, 3)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.height = intp->values.numbers[RuntimeInputPin(&runtime, node, 3)->valueIndex] * 2;
+            if (RuntimeInputPin(&runtime, node, 4) && RuntimeInputPin(&runtime, node, 4)->valueIndex < intp->valueCount)
+                intp->components[intp->componentCount].prop.color = intp->values.colors[RuntimeInputPin(&runtime, node, 4)->valueIndex];
+            if (RuntimeInputPin(&runtime, node, 5) && RuntimeInputPin(&runtime, node, 5)->valueIndex < intp->valueCount)
+            {
+                if (intp->values.numbers[RuntimeInputPin(&runtime, node, 5)->valueIndex] < COMPONENT_LAYER_COUNT)
+                {
+                    intp->components[intp->componentCount].prop.layer = intp->values.numbers[RuntimeInputPin(&runtime, node, 5)->valueIndex];
+                }
+                else if (intp->values.numbers[RuntimeInputPin(&runtime, node, 5)->valueIndex] < 0)
+                {
+                    intp->components[intp->componentCount].prop.layer = 0;
+                }
+                else
+                {
+                    intp->components[intp->componentCount].prop.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
+                }
+            }
+
+            intp->components[intp->componentCount].prop.hitbox.type = HITBOX_CIRCLE;
+            intp->components[intp->componentCount].prop.hitbox.circleHitboxRadius = intp->components[intp->componentCount].prop.width / 2;
+            intp->components[intp->componentCount].prop.hitbox.offset = (Vector2){0, 0};
+
+            if (RuntimeOutputPin(&runtime, node, 1))
+                RuntimeOutputPin(&runtime, node, 1)->componentIndex = intp->componentCount;
+            intp->componentCount++;
+            continue;
+        default:
+            break;
+        }
+    }
+
+    // Sprite variable pins bind to the component created by the sprite node with the same name
+    for (int i = 0; i < runtime.pinCount; i++)
+    {
+        RuntimePin *pin = &runtime.pins[i];
+        if (!pin->isInput || pin->type != PIN_SPRITE_VARIABLE || pin->pickedOption == 0)
+            continue;
+
+        int picked = pin->pickedOption - 1;
+        if (picked < 0 || picked >= intp->varCount)
+            continue;
+
+        int valueIndex = intp->varIndexes[picked];
+        if (!intp->values.names[valueIndex])
+            continue;
+
+        int componentIndex = NameMapGet(&lookup->spriteComponentByName, intp->values.names[valueIndex]);
+        if (componentIndex != -1)
+        {
+            intp->values.componentIndexes[valueIndex] = componentIndex;
+            pin->valueIndex = valueIndex;
+        }
+    }
+
+    if (!BuildCollisionShapes(intp))
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: collision shapes{I216}"}, LOG_LEVEL_ERROR);
+        return runtime;
+    }
+
+    if (CompileRuntimeGraph(&runtime, intp))
+    {
+        OptimizeRuntimeGraph(&runtime, intp);
+    }
+
+    return runtime;
+}
+
+// The arena never shrinks during a run, so what it reserved is the build's peak memory
+static void LogBuildArenaStats(InterpreterContext *intp)
+{
+    char message[MAX_LOG_MESSAGE_SIZE];
+    strmac(message, MAX_LOG_MESSAGE_SIZE, "Build memory: %.1f KB used, %.1f KB peak, %d allocations in %d block%s{I304}", intp->arena.bytesUsed / 1024.0, intp->arena.bytesReserved / 1024.0, intp->arena.allocationCount, intp->arena.blockCount, intp->arena.blockCount == 1 ? "" : "s");
+    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = message}, LOG_LEVEL_NORMAL);
+}
+
+RuntimeGraphContext ConvertToRuntimeGraph(GraphContext *graph, InterpreterContext *intp)
+{
+    double startTime = GetTime();
+
+    BuildLookup lookup;
+    if (!InitBuildLookup(&lookup, graph))
+    {
+        intp->buildFailed = true;
+        intp->buildErrorOccured = true;
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: build lookup{I213}"}, LOG_LEVEL_ERROR);
+        return (RuntimeGraphContext){0};
+    }
+
+    RuntimeGraphContext runtime = LowerGraph(graph, intp, &lookup);
+    FreeBuildLookup(&lookup);
+
+    if (!intp->buildErrorOccured)
+    {
+        char message[MAX_LOG_MESSAGE_SIZE];
+        strmac(message, MAX_LOG_MESSAGE_SIZE, "Built %d nodes, %d links into %d instructions in %.1f ms{I302}", graph->nodeCount, graph->linkCount, runtime.codeCount, (GetTime() - startTime) * 1000.0);
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = message}, LOG_LEVEL_NORMAL);
+        LogBuildArenaStats(intp);
+    }
+
+    return runtime;
+}
+
+static LatentWait *AllocLatentWait(InterpreterContext *intp)
+{
+    LatentScheduler *latent = &intp->latent;
+    if (!latent->freeList)
+    {
+        LatentWait *chunk = ArenaAlloc(&intp->arena, sizeof(LatentWait) * LATENT_WAIT_POOL_CHUNK);
+        if (!chunk)
+        {
+            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: latent nodes{I215}"}, LOG_LEVEL_ERROR);
+            return NULL;
+        }
+        for (int i = LATENT_WAIT_POOL_CHUNK - 1; i >= 0; i--)
+        {
+            chunk[i].next = latent->freeList;
+            latent->freeList = &chunk[i];
+        }
+    }
+
+    LatentWait *wait = latent->freeList;
+    latent->freeList = wait->next;
+    *wait = (LatentWait){0};
+    latent->pendingCount++;
+    return wait;
+}
+
+static void ReleaseLatentWait(LatentScheduler *latent, LatentWait *wait)
+{
+    wait->next = latent->freeList;
+    latent->freeList = wait;
+    latent->pendingCount--;
+}
+
+static void AppendLatentWait(LatentWait **head, LatentWait **tail, LatentWait *wait)
+{
+    wait->next = NULL;
+    if (*tail)
+        (*tail)->next = wait;
+    else
+        *head = wait;
+    *tail = wait;
+}
+
+static void ScheduleDelay(LatentScheduler *latent, LatentWait *wait)
+{
+    // The slot of the current tick has already been processed, so the earliest wake up is the next tick
+    if (wait->dueTick <= latent->currentTick)
+        wait->dueTick = latent->currentTick + 1;
+
+    int slot = wait->dueTick & (LATENT_WHEEL_SLOTS - 1);
+    AppendLatentWait(&latent->wheel[slot], &latent->wheelTail[slot], wait);
+}
+
+static void UnscheduleDelay(LatentScheduler *latent, LatentWait *wait)
+{
+    int slot = wait->dueTick & (LATENT_WHEEL_SLOTS - 1);
+    LatentWait *previous = NULL;
+    for (LatentWait *it = latent->wheel[slot]; it; previous = it, it = it->next)
+    {
+        if (it != wait)
+            continue;
+
+        if (previous)
+            previous->next = wait->next;
+        else
+            latent->wheel[slot] = wait->next;
+        if (latent->wheelTail[slot] == wait)
+            latent->wheelTail[slot] = previous;
+        wait->next = NULL;
+        return;
+    }
+}
+
+// Returns true when the flow was parked and has to stop here, false when it should carry on right away
+static bool ParkDelay(InterpreterContext *intp, int nodeIndex, int resumePc, float seconds)
+{
+    LatentWait *wait = AllocLatentWait(intp);
+    if (!wait)
+        return false;
+
+    wait->kind = LATENT_DELAY;
+    wait->nodeIndex = nodeIndex;
+    wait->resumePc = resumePc;
+    wait->dueTick = llround((intp->latent.time + (seconds > 0 ? seconds : 0)) * LATENT_TICKS_PER_SECOND);
+    ScheduleDelay(&intp->latent, wait);
+    return true;
+}
+
+// Nodes that move, turn, resize or regroup a sprite note it, so a spatial query only re-bins what changed since the last physics step.
+// Nothing to note before the grid is built
+static void MarkSpriteMoved(InterpreterContext *intp, int componentIndex)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    if (!grid->proxies || componentIndex < 0 || componentIndex >= intp->componentCount || grid->isMoved[componentIndex])
+        return;
+
+    grid->isMoved[componentIndex] = true;
+    grid->movedSprites[grid->movedCount++] = componentIndex;
+}
+
+// Files the atlas holds swap to their spot on a page, anything else comes from the texture cache
+static void SetSpriteTexture(InterpreterContext *intp, int componentIndex, const char *fileName)
+{
+    if (componentIndex < 0 || componentIndex >= intp->componentCount)
+        return;
+
+    Sprite *sprite = &intp->components[componentIndex].sprite;
+    const AtlasEntry *entry = FindAtlasEntry(&intp->atlas, fileName);
+    if (entry && entry->page >= 0)
+    {
+        ReleaseCachedTexture(intp, sprite->cachedTexture);
+        sprite->texture = intp->atlas.pages[entry->page];
+        sprite->source = entry->source;
+        sprite->isInAtlas = true;
+        sprite->cachedTexture = -1;
+    }
+    else
+    {
+        // Taken before the old one is let go, so setting the texture a sprite already shows never evicts it
+        int cached = AcquireCachedTexture(intp, fileName);
+        ReleaseCachedTexture(intp, sprite->cachedTexture);
+        sprite->texture = cached != -1 ? intp->textureCache.entries[cached].texture : (Texture2D){0};
+        sprite->source = (Rectangle){0, 0, sprite->texture.width, sprite->texture.height};
+        sprite->isInAtlas = false;
+        sprite->cachedTexture = cached;
+    }
+    MarkSpriteMoved(intp, componentIndex);
+}
+
+// Optional sprite fields of Create and Spawn Sprite keep what the sprite has while their pin is unlinked
+static float NumberOrCurrent(const ValueStore *values, int operand, float current)
+{
+    return operand == SPECIAL_VALUE_UNLINKED ? current : values->numbers[operand];
+}
+
+static bool ParkMoveTo(InterpreterContext *intp, int nodeIndex, int resumePc, int componentIndex, Vector2 target, float seconds)
+{
+    if (componentIndex < 0 || componentIndex >= intp->componentCount)
+        return false;
+
+    if (seconds <= 0)
+    {
+        intp->components[componentIndex].sprite.position = target;
+        MarkSpriteMoved(intp, componentIndex);
+        return false;
+    }
+
+    LatentWait *wait = AllocLatentWait(intp);
+    if (!wait)
+    {
+        intp->components[componentIndex].sprite.position = target;
+        MarkSpriteMoved(intp, componentIndex);
+        return false;
+    }
+
+    wait->kind = LATENT_MOVE_TO;
+    wait->nodeIndex = nodeIndex;
+    wait->resumePc = resumePc;
+    wait->componentIndex = componentIndex;
+    wait->start = intp->components[componentIndex].sprite.position;
+    wait->target = target;
+    wait->startTime = intp->latent.time;
+    wait->duration = seconds;
+    AppendLatentWait(&intp->latent.movers, &intp->latent.moversTail, wait);
+    return true;
+}
+
+// Force nodes push their sprite at a constant velocity for a while. The push is summed into the sprite's body
+// and taken out again when its time runs out; the same node pushing again only restarts the time
+static void ApplyForce(InterpreterContext *intp, int nodeIndex, int componentIndex, float pixelsPerSecond, float angle, float seconds)
+{
+    RigidBodies *bodies = &intp->bodies;
+    if (nodeIndex < 0 || nodeIndex >= bodies->nodeCount)
+        return;
+
+    LatentWait *force = bodies->forceByNode[nodeIndex];
+    if (force)
+    {
+        UnscheduleDelay(&intp->latent, force);
+    }
+    else
+    {
+        if (componentIndex < 0 || componentIndex >= intp->componentCount || !intp->components[componentIndex].isSprite)
+            return;
+
+        force = AllocLatentWait(intp);
+        if (!force)
+            return;
+
+        float radians = angle * DEG2RAD;
+        force->kind = LATENT_FORCE;
+        force->nodeIndex = nodeIndex;
+        force->resumePc = -1;
+        force->componentIndex = componentIndex;
+        force->push = (Vector2){cosf(radians) * pixelsPerSecond, -sinf(radians) * pixelsPerSecond};
+
+        bodies->pushX[componentIndex] += force->push.x;
+        bodies->pushY[componentIndex] += force->push.y;
+        bodies->pushCount[componentIndex]++;
+        bodies->forceByNode[nodeIndex] = force;
+    }
+
+    // Bodies move after the clock has advanced, so the frame that reaches the end of the time still gets pushed
+    force->dueTick = llround((intp->latent.time + (seconds > 0 ? seconds : 0)) * LATENT_TICKS_PER_SECOND) + 1;
+    ScheduleDelay(&intp->latent, force);
+}
+
+static void EndForce(InterpreterContext *intp, LatentWait *force)
+{
+    RigidBodies *bodies = &intp->bodies;
+    int c = force->componentIndex;
+
+    // The last push out resets the sum, so rounding left over from adding and removing pushes cannot make it drift
+    if (--bodies->pushCount[c] <= 0)
+    {
+        bodies->pushCount[c] = 0;
+        bodies->pushX[c] = 0;
+        bodies->pushY[c] = 0;
+    }
+    else
+    {
+        bodies->pushX[c] -= force->push.x;
+        bodies->pushY[c] -= force->push.y;
+    }
+
+    bodies->forceByNode[force->nodeIndex] = NULL;
+    ReleaseLatentWait(&intp->latent, force);
+}
+
+// Out of range groups clamp to the first or last one, like sprite layers do
+static int ClampCollisionGroup(float group)
+{
+    if (!(group >= 0))
+        return 0;
+    if (group >= MAX_COLLISION_GROUPS)
+        return MAX_COLLISION_GROUPS - 1;
+    return (int)group;
+}
+
+// Sprites are re-binned with their new group before the next physics step or spatial query reads them
+static void SetCollisionGroup(InterpreterContext *intp, int componentIndex, float group)
+{
+    if (componentIndex < 0 || componentIndex >= intp->componentCount)
+        return;
+
+    intp->components[componentIndex].collisionGroup = ClampCollisionGroup(group);
+    MarkSpriteMoved(intp, componentIndex);
+}
+
+static void SetGroupsCollide(InterpreterContext *intp, float groupA, float groupB, bool shouldCollide)
+{
+    int a = ClampCollisionGroup(groupA);
+    int b = ClampCollisionGroup(groupB);
+
+    if (shouldCollide)
+    {
+        intp->collisionMasks[a] |= 1u << b;
+        intp->collisionMasks[b] |= 1u << a;
+    }
+    else
+    {
+        intp->collisionMasks[a] &= ~(1u << b);
+        intp->collisionMasks[b] &= ~(1u << a);
+    }
+}
+
+// Kept in the range the render queue's sort key has room for
+static void SetZOrder(InterpreterContext *intp, int componentIndex, float zOrder)
+{
+    if (componentIndex < 0 || componentIndex >= intp->componentCount)
+        return;
+
+    if (!(zOrder >= RENDER_MIN_Z_ORDER))
+        zOrder = RENDER_MIN_Z_ORDER;
+    else if (zOrder > RENDER_MAX_Z_ORDER)
+        zOrder = RENDER_MAX_Z_ORDER;
+    intp->components[componentIndex].zOrder = (int)zOrder;
+}
+
+// The graph runs before the frame is drawn, so debug lines are queued here and drawn with the components in world space.
+// A line that does not fit when memory runs out is dropped
+static void DrawDebugLine(InterpreterContext *intp, float startX, float startY, float endX, float endY, Color color)
+{
+    DebugLineQueue *queue = &intp->debugLines;
+    if (queue->count == queue->capacity)
+    {
+        int newCapacity = queue->capacity ? queue->capacity * 2 : 64;
+        DebugLine *tmp = realloc(queue->lines, sizeof(DebugLine) * newCapacity);
+        if (!tmp)
+            return;
+        queue->lines = tmp;
+        queue->capacity = newCapacity;
+    }
+
+    queue->lines[queue->count++] = (DebugLine){{startX, startY}, {endX, endY}, color};
+}
+
+// Query outputs past the first are only reachable through the node's pins, each is written by its pin type
+static void WriteQueryOutput(ValueStore *values, RuntimeGraphContext *graph, Instruction *ins, int index, float number)
+{
+    RuntimePin *pin = RuntimeOutputPin(graph, &graph->nodes[ins->nodeIndex], index);
+    if (!pin || pin->valueIndex < 0)
+        return;
+
+    switch (pin->type)
+    {
+    case PIN_BOOL:
+        values->booleans[pin->valueIndex] = number != 0;
+        break;
+    case PIN_SPRITE:
+        values->componentIndexes[pin->valueIndex] = (int)number;
+        break;
+    default:
+        values->numbers[pin->valueIndex] = number;
+        break;
+    }
+    MarkValueWritten(values, pin->valueIndex);
+}
+
+// Spatial query nodes, shared with exported events. Unlinked inputs read as 0, a raycast that hits a prop reports no sprite
+static void RunSpatialQuery(InterpreterContext *intp, RuntimeGraphContext *graph, Instruction *ins)
+{
+    ValueStore *values = &intp->values;
+    float in[MAX_INSTRUCTION_OPERANDS];
+    for (int i = 0; i < MAX_INSTRUCTION_OPERANDS; i++)
+    {
+        in[i] = ins->operands[i] != -1 ? values->numbers[ins->operands[i]] : 0;
+    }
+
+    int sprite = -1;
+    switch (ins->op)
+    {
+    case OP_RAYCAST:
+    {
+        int hit;
+        Vector2 hitPoint;
+        bool isHit = RaycastComponents(intp, (Vector2){in[1], in[2]}, (Vector2){in[3], in[4]}, ClampCollisionGroup(in[5]), &hit, &hitPoint);
+        WriteQueryOutput(values, graph, ins, 1, isHit);
+        WriteQueryOutput(values, graph, ins, 2, isHit && intp->components[hit].isSprite ? hit : -1);
+        WriteQueryOutput(values, graph, ins, 3, hitPoint.x);
+        WriteQueryOutput(values, graph, ins, 4, hitPoint.y);
+        break;
+    }
+    case OP_OVERLAP_CIRCLE:
+    {
+        int count = OverlapCircleSprites(intp, (Vector2){in[1], in[2]}, in[3], ClampCollisionGroup(in[4]), &sprite);
+        WriteQueryOutput(values, graph, ins, 1, sprite);
+        WriteQueryOutput(values, graph, ins, 2, count);
+        break;
+    }
+    case OP_OVERLAP_RECTANGLE:
+    {
+        int count = OverlapRectangleSprites(intp, (Rectangle){in[1], in[2], in[3], in[4]}, ClampCollisionGroup(in[5]), &sprite);
+        WriteQueryOutput(values, graph, ins, 1, sprite);
+        WriteQueryOutput(values, graph, ins, 2, count);
+        break;
+    }
+    case OP_NEAREST_SPRITE:
+    {
+        float distance;
+        sprite = FindNearestSprite(intp, (Vector2){in[1], in[2]}, in[3], ClampCollisionGroup(in[4]), &distance);
+        WriteQueryOutput(values, graph, ins, 1, sprite);
+        WriteQueryOutput(values, graph, ins, 2, distance);
+        break;
+    }
+    case OP_SPRITE_AT_POINT:
+        OverlapCircleSprites(intp, (Vector2){in[1], in[2]}, 0, ClampCollisionGroup(in[3]), &sprite);
+        WriteQueryOutput(values, graph, ins, 1, sprite);
+        break;
+    default:
+        break;
+    }
+}
+
+void ExecuteBytecode(InterpreterContext *intp, RuntimeGraphContext *graph, int entry)
+{
+    if (entry < 0 || entry >= graph->codeCount)
+        return;
+
+    ValueStore *values = &intp->values;
+    int pc = entry;
+
+    while (pc >= 0 && pc < graph->codeCount)
+    {
+        Instruction *ins = &graph->code[pc++];
+        int *in = ins->operands;
+
+        if (ins->pullMask)
+        {
+            PullOperands(values, graph, ins, 0);
+        }
+
+        switch (ins->op)
+        {
+        case OP_NOP:
+            break;
+
+        case OP_END:
+            return;
+
+        case OP_JUMP:
+            pc = ins->jump;
+            break;
+
+        case OP_BRANCH:
+            if (!values->booleans[in[1]])
+            {
+                pc = ins->jump;
+            }
+            break;
+
+        case OP_LOOP:
+            if (!values->booleans[in[1]])
+            {
+                ins->loopSteps = INFINITE_LOOP_PROTECTION_STEPS;
+                pc = ins->jump;
+                break;
+            }
+            if (ins->loopSteps == 0)
+            {
+                if (intp->isInfiniteLoopProtectionOn)
+                {
+                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Possible infinite loop detected and exited! You can turn off infinite loop protection in settings{I210}"}, LOG_LEVEL_ERROR);
+                    ins->loopSteps = INFINITE_LOOP_PROTECTION_STEPS;
+                    pc = ins->jump;
+                }
+                else
+                {
+                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Possible infinite loop detected! Infinite loop protection is off!{I101}"}, LOG_LEVEL_WARNING);
+                }
+            }
+            else
+            {
+                ins->loopSteps--;
+            }
+            break;
+
+        case OP_UNKNOWN_NODE:
+            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Unknown node{I20E}"}, LOG_LEVEL_ERROR);
+            break;
+
+        case OP_SET_NUMBER:
+            values->numbers[ins->result] = values->numbers[in[1]];
+            MarkValueWritten(values, ins->result);
+            break;
+
+        case OP_SET_STRING:
+            values->strings[ins->result] = values->strings[in[1]];
+            MarkValueWritten(values, ins->result);
+            break;
+
+        case OP_SET_BOOL:
+            values->booleans[ins->result] = values->booleans[in[1]];
+            MarkValueWritten(values, ins->result);
+            break;
+
+        case OP_SET_COLOR:
+            values->colors[ins->result] = values->colors[in[1]];
+            MarkValueWritten(values, ins->result);
+            break;
+
+        case OP_SET_VARIABLE:
+        {
+            int target = ins->result;
+            switch (values->types[target])
+            {
+            case VAL_NUMBER:
+                values->numbers[target] = values->numbers[in[2]];
+                break;
+            case VAL_STRING:
+                values->strings[target] = values->strings[in[2]];
+                break;
+            case VAL_BOOL:
+                values->booleans[target] = values->booleans[in[2]];
+                break;
+            case VAL_COLOR:
+                values->colors[target] = values->colors[in[2]];
+                break;
+            case VAL_SPRITE:
+                values->componentIndexes[target] = values->componentIndexes[in[2]];
+                break;
+            default:
+                break;
+            }
+            MarkValueWritten(values, target);
+            break;
+        }
+
+        case OP_SET_BACKGROUND:
+            intp->backgroundColor = values->colors[in[1]];
+            break;
+
+        case OP_SET_FPS:
+            intp->fps = values->numbers[in[1]];
+            break;
+
+        case OP_CREATE_SPRITE:
+        {
+            Sprite *sprite = &intp->components[ins->componentIndex].sprite;
+            sprite->width = NumberOrCurrent(values, in[2], sprite->width);
+            sprite->height = NumberOrCurrent(values, in[3], sprite->height);
+            sprite->layer = NumberOrCurrent(values, in[4], sprite->layer);
+            sprite->hitbox.type = HITBOX_POLY;
+            MarkSpriteMoved(intp, ins->componentIndex);
+            break;
+        }
+
+        case OP_SPAWN_SPRITE:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                Sprite *sprite = &intp->components[componentIndex].sprite;
+                intp->components[componentIndex].isVisible = true;
+                sprite->position.x = NumberOrCurrent(values, in[2], sprite->position.x);
+                sprite->position.y = NumberOrCurrent(values, in[3], sprite->position.y);
+                sprite->rotation = 360 - NumberOrCurrent(values, in[4], 360 - sprite->rotation);
+                MarkSpriteMoved(intp, componentIndex);
+            }
+            break;
+        }
+
+        case OP_DESTROY_SPRITE:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                intp->components[componentIndex].isVisible = false;
+            }
+            break;
+        }
+
+        case OP_SET_SPRITE_POSITION:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                intp->components[componentIndex].sprite.position.x = values->numbers[in[2]];
+                intp->components[componentIndex].sprite.position.y = values->numbers[in[3]];
+                MarkSpriteMoved(intp, componentIndex);
+            }
+            break;
+        }
+
+        case OP_SET_SPRITE_ROTATION:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                intp->components[componentIndex].sprite.rotation = -1 * (values->numbers[in[2]] - 360);
+                MarkSpriteMoved(intp, componentIndex);
+            }
+            break;
+        }
+
+        case OP_SET_SPRITE_TEXTURE:
+            SetSpriteTexture(intp, values->componentIndexes[in[1]], values->strings[in[2]]);
+            break;
+
+        case OP_SET_SPRITE_SIZE:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                intp->components[componentIndex].sprite.width = values->numbers[in[2]];
+                intp->components[componentIndex].sprite.height = values->numbers[in[3]];
+                MarkSpriteMoved(intp, componentIndex);
+            }
+            break;
+        }
+
+        case OP_FORCE_SPRITE:
+            ApplyForce(intp, ins->nodeIndex, values->componentIndexes[in[1]], values->numbers[in[2]], values->numbers[in[3]], values->numbers[in[4]]);
+            break;
+
+        case OP_SET_SPRITE_PHYSICS:
+        {
+            int componentIndex = values->componentIndexes[in[1]];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount)
+            {
+                intp->bodies.gravity[componentIndex] = values->numbers[in[2]];
+                intp->bodies.damping[componentIndex] = values->numbers[in[3]] > 0 ? values->numbers[in[3]] : 0;
+            }
+            break;
+        }
+
+        case OP_SET_COLLISION_GROUP:
+            SetCollisionGroup(intp, values->componentIndexes[in[1]], values->numbers[in[2]]);
+            break;
+
+        case OP_SET_GROUPS_COLLIDE:
+            SetGroupsCollide(intp, values->numbers[in[1]], values->numbers[in[2]], values->booleans[in[3]]);
+            break;
+
+        case OP_SET_Z_ORDER:
+            SetZOrder(intp, values->componentIndexes[in[1]], values->numbers[in[2]]);
+            break;
+
+        case OP_SET_CAMERA:
+            SetCamera(intp, values->numbers[in[1]], values->numbers[in[2]], values->numbers[in[3]], values->numbers[in[4]]);
+            break;
+
+        case OP_CAMERA_FOLLOW:
+            SetCameraFollow(intp, values->componentIndexes[in[1]]);
+            break;
+
+        case OP_RAYCAST:
+        case OP_OVERLAP_CIRCLE:
+        case OP_OVERLAP_RECTANGLE:
+        case OP_NEAREST_SPRITE:
+        case OP_SPRITE_AT_POINT:
+            RunSpatialQuery(intp, graph, ins);
+            break;
+
+        case OP_MOVE_TO_SPRITE:
+        {
+            Vector2 target = {values->numbers[in[2]], values->numbers[in[3]]};
+            if (ParkMoveTo(intp, ins->nodeIndex, pc, values->componentIndexes[in[1]], target, values->numbers[in[4]]))
+                return;
+            break;
+        }
+
+        case OP_DELAY:
+            if (ParkDelay(intp, ins->nodeIndex, pc, values->numbers[in[1]]))
+                return;
+            break;
+
+        case OP_SHOW_PROP:
+            intp->components[ins->componentIndex].isVisible = true;
+            break;
+
+        case OP_COMPARISON:
+        case OP_GATE:
+        case OP_ARITHMETIC:
+            EvaluatePureInstruction(values, ins);
+            break;
+
+        case OP_PRINT_TO_LOG:
+            AddToLogFromInterpreter(intp, GetValue(intp, in[1]), LOG_LEVEL_DEBUG);
+            break;
+
+        case OP_DRAW_DEBUG_LINE:
+            DrawDebugLine(intp, values->numbers[in[1]], values->numbers[in[2]], values->numbers[in[3]], values->numbers[in[4]], values->colors[in[5]]);
+            break;
+        }
+    }
+}
+
+void DrawHitbox(Hitbox *h, Vector2 centerPos, Vector2 spriteSize, Vector2 texSize, float rotation, Color color)
+{
+    float scaleX = spriteSize.x / texSize.x;
+    float scaleY = spriteSize.y / texSize.y;
+
+    switch (h->type)
+    {
+    case HITBOX_RECT:
+    {
+        Rectangle r = {
+            centerPos.x + h->offset.x * scaleX,
+            centerPos.y + h->offset.y * scaleY,
+            h->rectHitboxSize.x * scaleX,
+            h->rectHitboxSize.y * scaleY};
+        DrawRectangleLinesEx(r, 1, color);
+    }
+    break;
+
+    case HITBOX_CIRCLE:
+    {
+        Vector2 c = {
+            centerPos.x + h->offset.x * scaleX,
+            centerPos.y + h->offset.y * scaleY};
+        DrawCircleLines((int)c.x, (int)c.y, h->circleHitboxRadius * ((scaleX + scaleY) / 2), color);
+    }
+    break;
+
+    case HITBOX_POLY:
+    {
+        for (int i = 0; i < h->polygonHitbox.count; i++)
+        {
+            Vector2 p1 = {
+                h->offset.x * scaleX + h->polygonHitbox.vertices[i].x * scaleX,
+                h->offset.y * scaleY + h->polygonHitbox.vertices[i].y * scaleY};
+            Vector2 p2 = {
+                h->offset.x * scaleX + h->polygonHitbox.vertices[(i + 1) % h->polygonHitbox.count].x * scaleX,
+                h->offset.y * scaleY + h->polygonHitbox.vertices[(i + 1) % h->polygonHitbox.count].y * scaleY};
+            DrawLineV(Vector2Add(centerPos, Vector2Rotate(p1, rotation * DEG2RAD)), Vector2Add(centerPos, Vector2Rotate(p2, rotation * DEG2RAD)), color);
+        }
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+// Z order takes the top two key bytes, the texture id the four below and the primitive the lowest one
+#define RENDER_KEY_BYTES 7
+#define RENDER_CIRCLE_SEGMENTS 36
+
+static unsigned long long MakeRenderKey(int zOrder, unsigned int textureId, RenderPrimitive primitive)
+{
+    return ((unsigned long long)(zOrder - RENDER_MIN_Z_ORDER) << 40) | ((unsigned long long)textureId << 8) | (unsigned long long)primitive;
+}
+
+// Texture a component is drawn with, rectangles and circles share raylib's shapes texture; false when nothing is drawn
+static bool GetRenderTarget(InterpreterContext *intp, const SceneComponent *component, unsigned int *textureId, RenderPrimitive *primitive)
+{
+    if (component->isSprite)
+    {
+        *textureId = component->sprite.texture.id;
+        *primitive = RENDER_PRIMITIVE_SPRITE;
+        return *textureId != 0;
+    }
+
+    switch (component->prop.propType)
+    {
+    case PROP_TEXTURE:
+        return false;
+    case PROP_RECTANGLE:
+        *primitive = RENDER_PRIMITIVE_RECTANGLE;
+        break;
+    case PROP_CIRCLE:
+        *primitive = RENDER_PRIMITIVE_CIRCLE;
+        break;
+    default:
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of bounds enum{O201}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
+    *textureId = GetShapesTexture().id;
+    return true;
+}
+
+// World rectangle a component covers when drawn, a rotated sprite's grown to hold it whole
+static bool IsComponentInView(const SceneComponent *component, Rectangle view)
+{
+    Rectangle bounds;
+    if (component->isSprite)
+    {
+        float sine = fabsf(sinf(component->sprite.rotation * DEG2RAD));
+        float cosine = fabsf(cosf(component->sprite.rotation * DEG2RAD));
+        Vector2 half = {fabsf((float)component->sprite.width) / 2, fabsf((float)component->sprite.height) / 2};
+        Vector2 extent = {cosine * half.x + sine * half.y, sine * half.x + cosine * half.y};
+        bounds = (Rectangle){component->sprite.position.x - extent.x, component->sprite.position.y - extent.y, extent.x * 2, extent.y * 2};
+    }
+    else if (component->prop.propType == PROP_CIRCLE)
+    {
+        float radius = component->prop.width / 2.0f;
+        bounds = (Rectangle){component->prop.position.x - radius, component->prop.position.y - radius, radius * 2, radius * 2};
+    }
+    else
+    {
+        bounds = (Rectangle){component->prop.position.x, component->prop.position.y, component->prop.width, component->prop.height};
+    }
+
+    return bounds.x <= view.x + view.width && view.x <= bounds.x + bounds.width && bounds.y <= view.y + view.height && view.y <= bounds.y + bounds.height;
+}
+
+// Components outside the camera's view are left out before anything about their drawing is looked at
+static bool BuildRenderQueue(InterpreterContext *intp)
+{
+    RenderQueue *queue = &intp->renderQueue;
+    if (queue->capacity < intp->componentCount)
+    {
+        RenderItem *items = realloc(queue->items, sizeof(RenderItem) * intp->componentCount);
+        if (items)
+            queue->items = items;
+        RenderItem *sorted = realloc(queue->sorted, sizeof(RenderItem) * intp->componentCount);
+        if (sorted)
+            queue->sorted = sorted;
+        if (!items || !sorted)
+            return false;
+        queue->capacity = intp->componentCount;
+    }
+
+    queue->count = 0;
+    queue->culledCount = 0;
+    queue->unsortedDrawCalls = 0;
+    unsigned int lastTextureId = 0;
+    for (int i = 0; i < intp->componentCount; i++)
+    {
+        unsigned int textureId;
+        RenderPrimitive primitive;
+        if (!intp->components[i].isVisible)
+            continue;
+        if (!IsComponentInView(&intp->components[i], intp->camera.view))
         {
-            int pinIndex = -1;
-            for (int k = 0; k < graph->pinCount; k++)
-            {
-                if (graph->pins[k].id == srcNode->inputPins[j])
-                {
-                    pinIndex = k;
-                    break;
-                }
-            }
-            if (pinIndex < 0)
-            {
-                dstNode->inputPins[j] = NULL;
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Input pin mapping failed{I202}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            dstNode->inputPins[j] = &runtime.pins[pinIndex];
-            runtime.pins[pinIndex].nodeIndex = i;
+            queue->culledCount++;
+            continue;
         }
+        if (!GetRenderTarget(intp, &intp->components[i], &textureId, &primitive))
+            continue;
 
-        for (int j = 0; j < srcNode->outputCount; j++)
+        if (textureId != lastTextureId)
         {
-            int pinIndex = -1;
-            for (int k = 0; k < graph->pinCount; k++)
-            {
-                if (graph->pins[k].id == srcNode->outputPins[j])
-                {
-                    pinIndex = k;
-                    break;
-                }
-            }
-            if (pinIndex < 0)
-            {
-                dstNode->outputPins[j] = NULL;
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Output pin mapping failed{I203}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            dstNode->outputPins[j] = &runtime.pins[pinIndex];
-            runtime.pins[pinIndex].nodeIndex = i;
+            queue->unsortedDrawCalls++;
+            lastTextureId = textureId;
         }
+        queue->items[queue->count++] = (RenderItem){MakeRenderKey(intp->components[i].zOrder, textureId, primitive), i};
     }
+    return true;
+}
 
-    int totalOutputPins = 0;
-    int totalComponents = 0;
-    for (int i = 0; i < graph->nodeCount; i++)
+// Least significant byte first, so components with equal keys keep their array order. Bytes every key shares, like the
+// z order when nothing sets it, are skipped
+static void SortRenderQueue(RenderQueue *queue)
+{
+    if (queue->count < 2)
+        return;
+
+    int counts[RENDER_KEY_BYTES][256] = {0};
+    for (int i = 0; i < queue->count; i++)
     {
-        RuntimeNode *node = &runtime.nodes[i];
-        for (int j = 0; j < node->outputCount; j++)
+        unsigned long long key = queue->items[i].key;
+        for (int b = 0; b < RENDER_KEY_BYTES; b++)
         {
-            if (node->outputPins[j] == NULL)
-            {
-                continue;
-            }
-            if (node->outputPins[j]->type != PIN_FLOW)
-            {
-                totalOutputPins++;
-            }
+            counts[b][(key >> (b * 8)) & 0xFF]++;
         }
+    }
 
-        if (node->type == NODE_CREATE_SPRITE || node->type == NODE_DRAW_PROP_TEXTURE || node->type == NODE_DRAW_PROP_RECTANGLE || node->type == NODE_DRAW_PROP_CIRCLE)
+    for (int b = 0; b < RENDER_KEY_BYTES; b++)
+    {
+        int *count = counts[b];
+        if (count[(queue->items[0].key >> (b * 8)) & 0xFF] == queue->count)
+            continue;
+
+        int offset = 0;
+        for (int digit = 0; digit < 256; digit++)
         {
-            totalComponents++;
+            int digitCount = count[digit];
+            count[digit] = offset;
+            offset += digitCount;
+        }
+        for (int i = 0; i < queue->count; i++)
+        {
+            RenderItem item = queue->items[i];
+            queue->sorted[count[(item.key >> (b * 8)) & 0xFF]++] = item;
         }
-    }
 
-    int expectedValues = totalOutputPins + SPECIAL_VALUES_COUNT;
-    intp->values = calloc(expectedValues, sizeof(Value));
-    if (!intp->values)
-    {
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: values{I204}"}, LOG_LEVEL_ERROR);
-        return runtime;
+        RenderItem *swap = queue->items;
+        queue->items = queue->sorted;
+        queue->sorted = swap;
     }
+}
 
-    intp->values[SPECIAL_VALUE_ERROR] = (Value){.type = VAL_STRING, .string = strmac(NULL, 11, "Error value"), .name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "Error value")};
-    intp->values[SPECIAL_VALUE_MOUSE_X] = (Value){.type = VAL_NUMBER, .number = 0, .name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "Mouse X")};
-    intp->values[SPECIAL_VALUE_MOUSE_Y] = (Value){.type = VAL_NUMBER, .number = 0, .name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "Mouse Y")};
-    intp->values[SPECIAL_VALUE_SCREEN_WIDTH] = (Value){.type = VAL_NUMBER, .number = 0, .name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "Screen Width")};
-    intp->values[SPECIAL_VALUE_SCREEN_HEIGHT] = (Value){.type = VAL_NUMBER, .number = 0, .name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "Screen Height")};
-    intp->valueCount = SPECIAL_VALUES_COUNT;
+// The same quads DrawTexturePro, DrawRectangle and DrawCircle would emit, without each call switching the texture back
+static void SubmitComponent(const SceneComponent *component, RenderPrimitive primitive, Texture2D shapes, Rectangle shapesSource)
+{
+    Vector2 shapesMin = {shapesSource.x / shapes.width, shapesSource.y / shapes.height};
+    Vector2 shapesMax = {(shapesSource.x + shapesSource.width) / shapes.width, (shapesSource.y + shapesSource.height) / shapes.height};
 
-    intp->components = calloc(totalComponents + 1, sizeof(SceneComponent));
-    if (!intp->components)
+    rlBegin(RL_QUADS);
+    rlNormal3f(0, 0, 1);
+    switch (primitive)
     {
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: components{I205}"}, LOG_LEVEL_ERROR);
-        return runtime;
+    case RENDER_PRIMITIVE_SPRITE:
+    {
+        const Sprite *sprite = &component->sprite;
+        Vector2 center = sprite->position;
+        Vector2 half = {sprite->width / 2.0f, sprite->height / 2.0f};
+        Vector2 corners[4] = {{-half.x, -half.y}, {-half.x, half.y}, {half.x, half.y}, {half.x, -half.y}};
+        Vector2 texMin = {sprite->source.x / sprite->texture.width, sprite->source.y / sprite->texture.height};
+        Vector2 texMax = {(sprite->source.x + sprite->source.width) / sprite->texture.width, (sprite->source.y + sprite->source.height) / sprite->texture.height};
+        Vector2 texCoords[4] = {{texMin.x, texMin.y}, {texMin.x, texMax.y}, {texMax.x, texMax.y}, {texMax.x, texMin.y}};
+        float sine = sinf(sprite->rotation * DEG2RAD);
+        float cosine = cosf(sprite->rotation * DEG2RAD);
+
+        rlColor4ub(255, 255, 255, 255);
+        for (int k = 0; k < 4; k++)
+        {
+            rlTexCoord2f(texCoords[k].x, texCoords[k].y);
+            rlVertex2f(center.x + corners[k].x * cosine - corners[k].y * sine, center.y + corners[k].x * sine + corners[k].y * cosine);
+        }
     }
-    intp->componentCount = 0;
+    break;
 
-    intp->varIndexes = malloc(sizeof(int) * (totalOutputPins + 1));
-    if (!intp->varIndexes)
+    case RENDER_PRIMITIVE_RECTANGLE:
     {
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: varIndexes{I206}"}, LOG_LEVEL_ERROR);
-        return runtime;
+        const Prop *prop = &component->prop;
+        float x = (int)prop->position.x;
+        float y = (int)prop->position.y;
+
+        rlColor4ub(prop->color.r, prop->color.g, prop->color.b, prop->color.a);
+        rlTexCoord2f(shapesMin.x, shapesMin.y);
+        rlVertex2f(x, y);
+        rlTexCoord2f(shapesMin.x, shapesMax.y);
+        rlVertex2f(x, y + prop->height);
+        rlTexCoord2f(shapesMax.x, shapesMax.y);
+        rlVertex2f(x + prop->width, y + prop->height);
+        rlTexCoord2f(shapesMax.x, shapesMin.y);
+        rlVertex2f(x + prop->width, y);
     }
-    intp->varCount = 0;
+    break;
 
-    intp->forces = calloc(MAX_FORCES, sizeof(Force));
-    if (!intp->forces)
+    case RENDER_PRIMITIVE_CIRCLE:
     {
-        intp->buildFailed = true;
-        intp->buildErrorOccured = true;
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: forces{I207}"}, LOG_LEVEL_ERROR);
-        return runtime;
+        // Every quad covers two segments, fanned out from the center
+        const Prop *prop = &component->prop;
+        Vector2 center = {(int)prop->position.x, (int)prop->position.y};
+        float radius = prop->width / 2;
+        float step = 360.0f / RENDER_CIRCLE_SEGMENTS;
+
+        for (int k = 0; k < RENDER_CIRCLE_SEGMENTS / 2; k++)
+        {
+            float angle = step * 2 * k;
+            rlColor4ub(prop->color.r, prop->color.g, prop->color.b, prop->color.a);
+            rlTexCoord2f(shapesMin.x, shapesMin.y);
+            rlVertex2f(center.x, center.y);
+            rlTexCoord2f(shapesMax.x, shapesMin.y);
+            rlVertex2f(center.x + cosf(DEG2RAD * (angle + step * 2)) * radius, center.y + sinf(DEG2RAD * (angle + step * 2)) * radius);
+            rlTexCoord2f(shapesMax.x, shapesMax.y);
+            rlVertex2f(center.x + cosf(DEG2RAD * (angle + step)) * radius, center.y + sinf(DEG2RAD * (angle + step)) * radius);
+            rlTexCoord2f(shapesMin.x, shapesMax.y);
+            rlVertex2f(center.x + cosf(DEG2RAD * angle) * radius, center.y + sinf(DEG2RAD * angle) * radius);
+        }
     }
-    intp->forcesCount = 0;
+    break;
+    }
+    rlEnd();
+}
 
-    for (int i = 0; i < graph->nodeCount; i++)
+// rlgl merges consecutive quads on one texture into one draw call, and only flushes a batch when its vertex buffer or
+// its draw call slots run out, so the sorted queue costs one draw call per texture run. Both are counted the way rlgl
+// splits them for the overlay
+static void SubmitRenderQueue(InterpreterContext *intp)
+{
+    RenderQueue *queue = &intp->renderQueue;
+    Texture2D shapes = GetShapesTexture();
+    Rectangle shapesSource = GetShapesTextureRectangle();
+    unsigned int currentTextureId = 0;
+    int runVertexCount = 0;
+    int batchDrawCalls = 0;
+
+    queue->drawCalls = 0;
+    queue->batches = queue->count > 0 ? 1 : 0;
+    for (int i = 0; i < queue->count; i++)
     {
-        RuntimeNode *node = &runtime.nodes[i];
-        Node *srcNode = &graph->nodes[i];
+        unsigned int textureId = (unsigned int)(queue->items[i].key >> 8);
+        RenderPrimitive primitive = (RenderPrimitive)(queue->items[i].key & 0xFF);
+        int vertexCount = primitive == RENDER_PRIMITIVE_CIRCLE ? RENDER_CIRCLE_SEGMENTS * 2 : 4;
 
-        switch (node->type)
+        if (textureId != currentTextureId)
         {
-        case NODE_LITERAL_NUMBER:
-            if (!node->inputPins[0])
-            {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            intp->values[intp->valueCount].number = strtof(node->inputPins[0]->textFieldValue, NULL);
-            intp->values[intp->valueCount].type = VAL_NUMBER;
-            intp->values[intp->valueCount].isVariable = false;
-            intp->values[intp->valueCount].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = intp->valueCount;
-            intp->valueCount++;
-            continue;
-        case NODE_LITERAL_STRING:
-            if (!node->inputPins[0])
-            {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            intp->values[intp->valueCount].string = strmac(NULL, MAX_LITERAL_NODE_FIELD_SIZE, node->inputPins[0]->textFieldValue);
-            intp->values[intp->valueCount].type = VAL_STRING;
-            intp->values[intp->valueCount].isVariable = false;
-            intp->values[intp->valueCount].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = intp->valueCount;
-            intp->valueCount++;
-            continue;
-        case NODE_LITERAL_BOOL:
-            if (!node->inputPins[0])
-            {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            if (strcmp(node->inputPins[0]->textFieldValue, "true") == 0)
-            {
-                intp->values[intp->valueCount].boolean = true;
-            }
-            else
-            {
-                intp->values[intp->valueCount].boolean = false;
-            }
-            intp->values[intp->valueCount].type = VAL_BOOL;
-            intp->values[intp->valueCount].isVariable = false;
-            intp->values[intp->valueCount].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = intp->valueCount;
-            intp->valueCount++;
-            continue;
-        case NODE_LITERAL_COLOR:
-            if (!node->inputPins[0])
-            {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Missing input for literal node{I208}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
-            unsigned int hexValue;
-            if (sscanf(node->inputPins[0]->textFieldValue, "%x", &hexValue) == 1)
-            {
-                Color color = {(hexValue >> 24) & 0xFF, (hexValue >> 16) & 0xFF, (hexValue >> 8) & 0xFF, hexValue & 0xFF};
-                intp->values[intp->valueCount].color = color;
-                intp->values[intp->valueCount].type = VAL_COLOR;
-                intp->values[intp->valueCount].isVariable = false;
-                intp->values[intp->valueCount].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                if (node->outputPins[0]){
-                    node->outputPins[0]->valueIndex = intp->valueCount;
-                }
-                intp->valueCount++;
-            }
-            else
+            if (batchDrawCalls >= RL_DEFAULT_BATCH_DRAWCALLS)
             {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Error: Invalid color{I209}"}, LOG_LEVEL_ERROR);
-                return runtime;
+                queue->batches++;
+                batchDrawCalls = 0;
             }
+            rlSetTexture(textureId);
+            currentTextureId = textureId;
+            runVertexCount = 0;
+            queue->drawCalls++;
+            batchDrawCalls++;
+        }
+
+        if (rlCheckRenderBatchLimit(vertexCount))
+        {
+            queue->batches++;
+            batchDrawCalls = 1;
+            if (runVertexCount > 0)
+                queue->drawCalls++;
+            runVertexCount = 0;
+        }
+
+        SubmitComponent(&intp->components[queue->items[i].componentIndex], primitive, shapes, shapesSource);
+        runVertexCount += vertexCount;
+    }
+    rlSetTexture(0);
+}
+
+static void DrawComponentHitboxes(InterpreterContext *intp)
+{
+    for (int i = 0; i < intp->componentCount; i++)
+    {
+        SceneComponent *component = &intp->components[i];
+        if (!component->isVisible || !IsComponentInView(component, intp->camera.view))
             continue;
-        default:
-            break;
+
+        if (component->isSprite)
+        {
+            DrawHitbox(
+                &component->sprite.hitbox,
+                component->sprite.position,
+                (Vector2){component->sprite.width, component->sprite.height},
+                (Vector2){component->sprite.source.width, component->sprite.source.height},
+                component->sprite.rotation,
+                RED);
         }
+        else
+        {
+            DrawHitbox(
+                &component->prop.hitbox,
+                component->prop.position,
+                (Vector2){component->prop.width, component->prop.height},
+                (Vector2){component->prop.width, component->prop.height},
+                0,
+                RED);
+        }
+    }
+}
 
-        for (int j = 0; j < node->outputCount; j++)
+// Components are drawn by z order and, within one z order, grouped by texture, so overlapping components on the same
+// z order and different textures may not stack in the order they were created. Debug lines go over the components, hitboxes
+// over everything
+void DrawComponents(InterpreterContext *intp)
+{
+    ClearBackground(intp->backgroundColor);
+
+    if (!intp->camera.isPlaced)
+        intp->camera.position = GetGameScreenCenter(&intp->camera);
+    intp->camera.view = GetCameraView(&intp->camera);
+    BeginMode2D(ToCamera2D(&intp->camera));
+
+    RenderQueue *queue = &intp->renderQueue;
+    if (BuildRenderQueue(intp))
+    {
+        SortRenderQueue(queue);
+        SubmitRenderQueue(intp);
+    }
+    else
+    {
+        // No room for the queue, components are drawn unsorted in array order
+        for (int i = 0; i < intp->componentCount; i++)
         {
-            RuntimePin *pin = node->outputPins[j];
-            if (!pin)
-                continue;
-            if (pin->type == PIN_FLOW)
+            unsigned int textureId;
+            RenderPrimitive primitive;
+            if (!intp->components[i].isVisible || !IsComponentInView(&intp->components[i], intp->camera.view) || !GetRenderTarget(intp, &intp->components[i], &textureId, &primitive))
                 continue;
 
-            int idx = intp->valueCount;
+            rlSetTexture(textureId);
+            SubmitComponent(&intp->components[i], primitive, GetShapesTexture(), GetShapesTextureRectangle());
+        }
+        rlSetTexture(0);
+    }
 
-            bool isVariable = false;
-            if (node->type == NODE_CREATE_NUMBER || node->type == NODE_CREATE_STRING || node->type == NODE_CREATE_BOOL || node->type == NODE_CREATE_COLOR || node->type == NODE_CREATE_SPRITE)
-            {
-                isVariable = true;
-                if (node->inputPins[1])
-                    node->inputPins[1]->valueIndex = idx;
-            }
+    for (int i = 0; i < intp->debugLines.count; i++)
+    {
+        DrawLineV(intp->debugLines.lines[i].start, intp->debugLines.lines[i].end, intp->debugLines.lines[i].color);
+    }
 
-            switch (pin->type)
-            {
-            case PIN_NUM:
-                intp->values[idx].number = 0;
-                intp->values[idx].type = VAL_NUMBER;
-                intp->values[idx].isVariable = isVariable;
-                intp->values[idx].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                break;
-            case PIN_STRING:
-                intp->values[idx].string = strmac(NULL, MAX_VARIABLE_NAME_SIZE, "null");
-                intp->values[idx].type = VAL_STRING;
-                intp->values[idx].isVariable = isVariable;
-                intp->values[idx].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                break;
-            case PIN_BOOL:
-                intp->values[idx].boolean = false;
-                intp->values[idx].type = VAL_BOOL;
-                intp->values[idx].isVariable = isVariable;
-                intp->values[idx].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                break;
-            case PIN_COLOR:
-                intp->values[idx].color = (Color){255, 255, 255, 255};
-                intp->values[idx].type = VAL_COLOR;
-                intp->values[idx].isVariable = isVariable;
-                intp->values[idx].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                break;
-            case PIN_SPRITE:
-                intp->values[idx].sprite = (Sprite){0};
-                intp->values[idx].type = VAL_SPRITE;
-                intp->values[idx].isVariable = isVariable;
-                intp->values[idx].name = strmac(NULL, MAX_VARIABLE_NAME_SIZE, srcNode->name);
-                break;
-            default:
-                break;
-            }
+    if (intp->shouldShowHitboxes)
+    {
+        DrawComponentHitboxes(intp);
+    }
 
-            intp->values[idx].componentIndex = -1;
+    EndMode2D();
 
-            if (isVariable)
-            {
-                intp->varIndexes[intp->varCount] = idx;
-                intp->varCount++;
-            }
+    if (intp->shouldShowDrawCalls)
+    {
+        DrawText(TextFormat("%d draw calls, %d batches, %d in component order, %d culled", queue->drawCalls, queue->batches, queue->unsortedDrawCalls, queue->culledCount),
+                 intp->camera.screen.x + 10, intp->camera.screen.y + 10, 20, RED);
+        TextureCache *cache = &intp->textureCache;
+        DrawText(TextFormat("Textures: %d hits, %d misses, %d evicted, %.1f of %d MB loaded", cache->hits, cache->misses, cache->evictions, cache->loadedBytes / (1024.0 * 1024.0), intp->textureBudgetMB),
+                 intp->camera.screen.x + 10, intp->camera.screen.y + 35, 20, RED);
+    }
+}
 
-            if (intp->valueCount > expectedValues)
-            {
-                intp->buildErrorOccured = true;
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Value array overflow{I20A}"}, LOG_LEVEL_ERROR);
-                return runtime;
-            }
+static bool HasCollisionShape(const CollisionShape *shape)
+{
+    return shape && (shape->type == HITBOX_CIRCLE || shape->type == HITBOX_CAPSULE || ((shape->type == HITBOX_POLY || shape->type == HITBOX_RECT) && shape->vertices && shape->vertexCount > 0));
+}
 
-            pin->valueIndex = idx;
-            intp->valueCount++;
-        }
+// A fitted circle or capsule stays true only while the sprite is scaled evenly, a fitted rectangle only while it stays axis aligned
+static HitboxType GetFittedShapeType(const CollisionShape *shape, float scaleX, float scaleY, float rotation)
+{
+    switch (shape->fitted.type)
+    {
+    case HITBOX_CIRCLE:
+    case HITBOX_CAPSULE:
+        return fabsf(fabsf(scaleX) - fabsf(scaleY)) <= HITBOX_FIT_TOLERANCE * fmaxf(fabsf(scaleX), fabsf(scaleY)) ? shape->fitted.type : HITBOX_POLY;
+    case HITBOX_RECT:
+        return fmodf(rotation, 90) == 0 && shape->vertices ? HITBOX_RECT : HITBOX_POLY;
+    default:
+        return HITBOX_POLY;
+    }
+}
+
+// Places the fitted primitive the same way as the polygon it stands in for; offset is its anchor in texture space
+static void PlaceFittedShape(CollisionShape *shape, Vector2 offset, Vector2 pos, Vector2 scale, float rotation)
+{
+    float angle = rotation * DEG2RAD;
+    Vector2 anchor = Vector2Add(pos, Vector2Rotate(Vector2Multiply(offset, scale), angle));
+    float radius = shape->fitted.radius * (fabsf(scale.x) + fabsf(scale.y)) / 2;
+
+    switch (shape->type)
+    {
+    case HITBOX_CIRCLE:
+        shape->center = anchor;
+        shape->radius = radius;
+        shape->bounds = (Rectangle){anchor.x - radius, anchor.y - radius, radius * 2, radius * 2};
+        break;
+    case HITBOX_CAPSULE:
+    {
+        shape->center = anchor;
+        shape->radius = radius;
+        shape->axis = Vector2Rotate(Vector2Multiply(shape->fitted.capsuleAxis, scale), angle);
+        Vector2 extent = {fabsf(shape->axis.x) + radius, fabsf(shape->axis.y) + radius};
+        shape->bounds = (Rectangle){anchor.x - extent.x, anchor.y - extent.y, extent.x * 2, extent.y * 2};
+        break;
+    }
+    case HITBOX_RECT:
+    {
+        // Quarter turns keep the rectangle axis aligned, so its rotated corners span the same bounds
+        Vector2 opposite = Vector2Add(pos, Vector2Rotate(Vector2Multiply(Vector2Add(offset, shape->fitted.rectSize), scale), angle));
+        Vector2 min = Vector2Min(anchor, opposite);
+        Vector2 max = Vector2Max(anchor, opposite);
+        shape->bounds = (Rectangle){min.x, min.y, max.x - min.x, max.y - min.y};
+        shape->vertexCount = 4;
+        shape->vertices[0] = (Vector2){min.x, min.y};
+        shape->vertices[1] = (Vector2){max.x, min.y};
+        shape->vertices[2] = (Vector2){max.x, max.y};
+        shape->vertices[3] = (Vector2){min.x, max.y};
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Polygons are placed around the sprite center like the sprite itself: offset and texture scale first, then its rotation.
+// Components without a texture keep a scale of 1
+static CollisionShape *GetCollisionShape(InterpreterContext *intp, int index)
+{
+    if (!intp->collisionShapes)
+        return NULL;
+
+    SceneComponent *c = &intp->components[index];
+    CollisionShape *shape = &intp->collisionShapes[index];
+    Hitbox *hitbox = c->isSprite ? &c->sprite.hitbox : &c->prop.hitbox;
+    Vector2 pos = c->isSprite ? c->sprite.position : c->prop.position;
+    Vector2 size = c->isSprite ? (Vector2){c->sprite.width, c->sprite.height} : (Vector2){c->prop.width, c->prop.height};
+    Vector2 tex = c->isSprite ? (Vector2){c->sprite.source.width, c->sprite.source.height} : (Vector2){c->prop.texture.width, c->prop.texture.height};
+    float rotation = c->isSprite ? c->sprite.rotation : 0;
+
+    if (shape->isBuilt && shape->hitboxType == hitbox->type && shape->rotation == rotation &&
+        shape->position.x == pos.x && shape->position.y == pos.y && shape->size.x == size.x && shape->size.y == size.y &&
+        shape->textureSize.x == tex.x && shape->textureSize.y == tex.y)
+    {
+        return shape;
     }
 
-    if (intp->varCount > 0)
+    shape->isBuilt = true;
+    shape->hitboxType = hitbox->type;
+    shape->position = pos;
+    shape->size = size;
+    shape->textureSize = tex;
+    shape->rotation = rotation;
+
+    float scaleX = tex.x != 0 ? size.x / tex.x : 1.0f;
+    float scaleY = tex.y != 0 ? size.y / tex.y : 1.0f;
+
+    shape->type = hitbox->type == HITBOX_POLY ? GetFittedShapeType(shape, scaleX, scaleY, rotation) : hitbox->type;
+    if (shape->type != hitbox->type)
     {
-        int *tmp = realloc(intp->varIndexes, sizeof(int) * intp->varCount);
-        if (tmp)
-            intp->varIndexes = tmp;
+        PlaceFittedShape(shape, Vector2Add(shape->fitted.offset, hitbox->offset), pos, (Vector2){scaleX, scaleY}, rotation);
+        return shape;
     }
 
-    for (int i = 0; i < graph->nodeCount; i++)
+    switch (hitbox->type)
     {
-        RuntimeNode *node = &runtime.nodes[i];
-        Node *srcNode = &graph->nodes[i];
+    case HITBOX_POLY:
+    {
+        if (!shape->vertices)
+            break;
 
-        bool valueFound = false;
+        float angle = rotation * DEG2RAD;
+        Vector2 min = {INFINITY, INFINITY};
+        Vector2 max = {-INFINITY, -INFINITY};
+        shape->vertexCount = hitbox->polygonHitbox.count < 0 ? 0 : hitbox->polygonHitbox.count > MAX_POLYGON_VERTICES ? MAX_POLYGON_VERTICES : hitbox->polygonHitbox.count;
+        for (int i = 0; i < shape->vertexCount; i++)
+        {
+            Vector2 local = {(hitbox->polygonHitbox.vertices[i].x + hitbox->offset.x) * scaleX, (hitbox->polygonHitbox.vertices[i].y + hitbox->offset.y) * scaleY};
+            shape->vertices[i] = Vector2Add(pos, angle != 0 ? Vector2Rotate(local, angle) : local);
+            min = Vector2Min(min, shape->vertices[i]);
+            max = Vector2Max(max, shape->vertices[i]);
+        }
+        shape->bounds = (Rectangle){min.x, min.y, max.x - min.x, max.y - min.y};
+        break;
+    }
+    case HITBOX_RECT:
+    {
+        if (!shape->vertices)
+            break;
 
-        switch (graph->nodes[i].type)
+        Vector2 corner = {pos.x + hitbox->offset.x * scaleX, pos.y + hitbox->offset.y * scaleY};
+        Vector2 extent = {hitbox->rectHitboxSize.x * scaleX, hitbox->rectHitboxSize.y * scaleY};
+        shape->bounds = (Rectangle){fminf(corner.x, corner.x + extent.x), fminf(corner.y, corner.y + extent.y), fabsf(extent.x), fabsf(extent.y)};
+        shape->vertices[0] = (Vector2){shape->bounds.x, shape->bounds.y};
+        shape->vertices[1] = (Vector2){shape->bounds.x + shape->bounds.width, shape->bounds.y};
+        shape->vertices[2] = (Vector2){shape->bounds.x + shape->bounds.width, shape->bounds.y + shape->bounds.height};
+        shape->vertices[3] = (Vector2){shape->bounds.x, shape->bounds.y + shape->bounds.height};
+        break;
+    }
+    case HITBOX_CIRCLE:
+        shape->center = (Vector2){pos.x + hitbox->offset.x * scaleX, pos.y + hitbox->offset.y * scaleY};
+        shape->radius = fabsf(hitbox->circleHitboxRadius * ((scaleX + scaleY) / 2));
+        shape->bounds = (Rectangle){shape->center.x - shape->radius, shape->center.y - shape->radius, shape->radius * 2, shape->radius * 2};
+        break;
+    default:
+        break;
+    }
+
+    for (int k = 0; k < shape->pieceCount && shape->vertices; k++)
+    {
+        ConvexPiece *piece = &shape->pieces[k];
+        Vector2 min = {INFINITY, INFINITY};
+        Vector2 max = {-INFINITY, -INFINITY};
+        for (int i = 0; i < piece->count; i++)
         {
-        case NODE_GET_VARIABLE:
-            for (int j = 0; j < graph->nodeCount; j++)
-            {
-                if (j != i && runtime.nodes[i].inputPins[0] && runtime.nodes[i].inputPins[0]->pickedOption < 256 && strcmp(graph->variables[runtime.nodes[i].inputPins[0]->pickedOption], graph->nodes[j].name) == 0)
-                {
-                    if (runtime.nodes[j].outputPins[1])
-                        node->outputPins[0]->valueIndex = runtime.nodes[j].outputPins[1]->valueIndex;
-                    valueFound = true;
-                    break;
-                }
-            }
-            if (!valueFound)
-            {
-                if (node->outputPins[0])
-                    node->outputPins[0]->valueIndex = 0;
-            }
-            continue;
-        case NODE_SET_VARIABLE:
-            for (int j = 0; j < graph->nodeCount; j++)
-            {
-                if (j != i && runtime.nodes[i].inputPins[1] && runtime.nodes[i].inputPins[1]->pickedOption < 256 && strcmp(graph->variables[runtime.nodes[i].inputPins[1]->pickedOption], graph->nodes[j].name) == 0)
-                {
-                    if (runtime.nodes[j].outputPins[1])
-                        node->outputPins[1]->valueIndex = runtime.nodes[j].outputPins[1]->valueIndex;
-                    valueFound = true;
-                    break;
-                }
-            }
-            if (!valueFound)
-            {
-                if (node->outputPins[1])
-                    node->outputPins[1]->valueIndex = 0;
-            }
-            continue;
-        case NODE_GET_SCREEN_WIDTH:
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = SPECIAL_VALUE_SCREEN_WIDTH;
-            continue;
-        case NODE_GET_SCREEN_HEIGHT:
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = SPECIAL_VALUE_SCREEN_HEIGHT;
-            continue;
-        case NODE_GET_MOUSE_X:
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = SPECIAL_VALUE_MOUSE_X;
-            continue;
-        case NODE_GET_MOUSE_Y:
-            if (node->outputPins[0])
-                node->outputPins[0]->valueIndex = SPECIAL_VALUE_MOUSE_Y;
-            continue;
-        default:
-            continue;
+            min = Vector2Min(min, shape->vertices[shape->pieceIndexes[piece->first + i]]);
+            max = Vector2Max(max, shape->vertices[shape->pieceIndexes[piece->first + i]]);
         }
+        piece->bounds = (Rectangle){min.x, min.y, max.x - min.x, max.y - min.y};
     }
 
-    for (int i = 0; i < graph->linkCount; i++)
+    return shape;
+}
+
+static bool DoBoundsOverlap(Rectangle a, Rectangle b)
+{
+    return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+static bool HasSeparatingEdge(const Vector2 *aVertices, const int *aIndexes, int aCount, const Vector2 *bVertices, const int *bIndexes, int bCount)
+{
+    for (int i = 0; i < aCount; i++)
     {
-        int inputIndex = -1;
-        int outputIndex = -1;
+        Vector2 p = aVertices[aIndexes[i]];
+        Vector2 q = aVertices[aIndexes[(i + 1) % aCount]];
+        Vector2 axis = {q.y - p.y, p.x - q.x};
+        if (axis.x == 0 && axis.y == 0)
+            continue;
 
-        for (int j = 0; j < graph->pinCount && (inputIndex == -1 || outputIndex == -1); j++)
+        float aMin = INFINITY, aMax = -INFINITY;
+        for (int k = 0; k < aCount; k++)
         {
-            if (graph->pins[j].id == graph->links[i].inputPinID)
-                inputIndex = j;
-            if (graph->pins[j].id == graph->links[i].outputPinID)
-                outputIndex = j;
+            float d = Vector2DotProduct(aVertices[aIndexes[k]], axis);
+            aMin = fminf(aMin, d);
+            aMax = fmaxf(aMax, d);
         }
 
-        if (inputIndex == -1 || outputIndex == -1)
+        float bMin = INFINITY, bMax = -INFINITY;
+        for (int k = 0; k < bCount; k++)
         {
-            intp->buildErrorOccured = true;
-            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Link pin missing{I20B}"}, LOG_LEVEL_ERROR);
-            return runtime;
+            float d = Vector2DotProduct(bVertices[bIndexes[k]], axis);
+            bMin = fminf(bMin, d);
+            bMax = fmaxf(bMax, d);
         }
 
-        RuntimePin *inputPin = &runtime.pins[inputIndex];
-        RuntimePin *outputPin = &runtime.pins[outputIndex];
-
-        inputPin->valueIndex = outputPin->valueIndex;
+        if (aMax < bMin || bMax < aMin)
+            return true;
+    }
+    return false;
+}
 
-        if (inputPin->type == PIN_FLOW && outputPin->type == PIN_FLOW)
+// Outlines that could not be split into convex pieces fall back to edge crossings plus containment
+static bool CheckCollisionOutlines(const CollisionShape *a, const CollisionShape *b)
+{
+    for (int i = 0; i < a->vertexCount; i++)
+    {
+        Vector2 a1 = a->vertices[i];
+        Vector2 a2 = a->vertices[(i + 1) % a->vertexCount];
+        for (int j = 0; j < b->vertexCount; j++)
         {
-            if (inputPin->nodeIndex >= 0)
-                outputPin->nextNodeIndex = inputPin->nodeIndex;
+            if (CheckCollisionLines(a1, a2, b->vertices[j], b->vertices[(j + 1) % b->vertexCount], NULL))
+                return true;
         }
     }
 
-    for (int i = 0; i < graph->nodeCount; i++)
+    return CheckCollisionPointPoly(a->vertices[0], b->vertices, b->vertexCount) || CheckCollisionPointPoly(b->vertices[0], a->vertices, a->vertexCount);
+}
+
+// Separating axis test between every pair of convex pieces whose bounds touch
+static bool CheckCollisionPieces(const CollisionShape *a, const CollisionShape *b)
+{
+    if (a->pieceCount == 0 || b->pieceCount == 0)
+        return CheckCollisionOutlines(a, b);
+
+    for (int i = 0; i < a->pieceCount; i++)
     {
-        RuntimeNode *node = &runtime.nodes[i];
+        const ConvexPiece *pa = &a->pieces[i];
+        if (!DoBoundsOverlap(pa->bounds, b->bounds))
+            continue;
 
-        switch (node->type)
+        for (int j = 0; j < b->pieceCount; j++)
         {
-        case NODE_CREATE_SPRITE:
-            intp->components[intp->componentCount].isSprite = true;
-            intp->components[intp->componentCount].isVisible = false;
-            {
-                int fileIndex = -1;
-                int wIndex = -1;
-                int hIndex = -1;
-                int layerIndex = -1;
+            const ConvexPiece *pb = &b->pieces[j];
+            if (!DoBoundsOverlap(pa->bounds, pb->bounds))
+                continue;
 
-                if (node->inputPins[1])
-                    fileIndex = node->inputPins[1]->valueIndex;
-                if (node->inputPins[2])
-                    wIndex = node->inputPins[2]->valueIndex;
-                if (node->inputPins[3])
-                    hIndex = node->inputPins[3]->valueIndex;
-                if (node->inputPins[4])
-                    layerIndex = node->inputPins[4]->valueIndex;
+            const int *ia = &a->pieceIndexes[pa->first];
+            const int *ib = &b->pieceIndexes[pb->first];
+            if (!HasSeparatingEdge(a->vertices, ia, pa->count, b->vertices, ib, pb->count) &&
+                !HasSeparatingEdge(b->vertices, ib, pb->count, a->vertices, ia, pa->count))
+                return true;
+        }
+    }
+    return false;
+}
 
-                if (fileIndex != -1 && fileIndex < intp->valueCount && intp->values[fileIndex].string && intp->values[fileIndex].string[0])
-                {
-                    char path[MAX_FILE_PATH];
-                    strmac(path, MAX_FILE_PATH, "%s%c%s", intp->projectPath, PATH_SEPARATOR, intp->values[fileIndex].string);
-                    Texture2D tex = LoadTexture(path);
-                    if (tex.id == 0)
-                    {
-                        intp->buildErrorOccured = true;
-                        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Failed to load texture{I20C}"}, LOG_LEVEL_ERROR);
-                        return runtime;
-                    }
-                    else
-                    {
-                        intp->components[intp->componentCount].sprite.texture = tex;
-                    }
-                }
-                else
-                {
-                    intp->buildErrorOccured = true;
-                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Invalid texture input{I20D}"}, LOG_LEVEL_ERROR);
-                    return runtime;
-                }
+static bool CheckCollisionOutlineCircle(const CollisionShape *poly, Vector2 center, float radius)
+{
+    if (CheckCollisionPointPoly(center, poly->vertices, poly->vertexCount))
+        return true;
 
-                if (wIndex != -1 && wIndex < intp->valueCount)
-                    intp->components[intp->componentCount].sprite.width = intp->values[wIndex].number;
-                if (hIndex != -1 && hIndex < intp->valueCount)
-                    intp->components[intp->componentCount].sprite.height = intp->values[hIndex].number;
-                if (layerIndex != -1 && layerIndex < intp->valueCount)
-                {
-                    if (intp->values[layerIndex].number < COMPONENT_LAYER_COUNT)
-                    {
-                        intp->components[intp->componentCount].sprite.layer = intp->values[layerIndex].number;
-                    }
-                    else if (intp->values[layerIndex].number < 0)
-                    {
-                        intp->components[intp->componentCount].sprite.layer = 0;
-                    }
-                    else
-                    {
-                        intp->components[intp->componentCount].sprite.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
-                    }
-                }
+    for (int i = 0; i < poly->vertexCount; i++)
+    {
+        if (CheckCollisionCircleLine(center, radius, poly->vertices[i], poly->vertices[(i + 1) % poly->vertexCount]))
+            return true;
+    }
+    return false;
+}
 
-                intp->components[intp->componentCount].sprite.hitbox.type = HITBOX_POLY; // should support all types
+// Segments closer than distance anywhere along them
+static bool AreSegmentsWithin(Vector2 a1, Vector2 a2, Vector2 b1, Vector2 b2, float distance)
+{
+    return CheckCollisionLines(a1, a2, b1, b2, NULL) ||
+           CheckCollisionCircleLine(a1, distance, b1, b2) || CheckCollisionCircleLine(a2, distance, b1, b2) ||
+           CheckCollisionCircleLine(b1, distance, a1, a2) || CheckCollisionCircleLine(b2, distance, a1, a2);
+}
 
-                for (int j = 0; j < graph->pinCount; j++)
-                {
-                    if (graph->nodes[i].inputPins[5] && graph->pins[j].id == graph->nodes[i].inputPins[5])
-                    {
-                        intp->components[intp->componentCount].sprite.hitbox.polygonHitbox = graph->pins[j].hitbox;
-                    }
-                }
+static bool CheckCollisionOutlineCapsule(const CollisionShape *poly, const CollisionShape *capsule)
+{
+    Vector2 start = Vector2Subtract(capsule->center, capsule->axis);
+    Vector2 end = Vector2Add(capsule->center, capsule->axis);
+    if (CheckCollisionPointPoly(start, poly->vertices, poly->vertexCount))
+        return true;
 
-                if (node->outputPins[1])
-                    node->outputPins[1]->componentIndex = intp->componentCount;
+    for (int i = 0; i < poly->vertexCount; i++)
+    {
+        if (AreSegmentsWithin(start, end, poly->vertices[i], poly->vertices[(i + 1) % poly->vertexCount], capsule->radius))
+            return true;
+    }
+    return false;
+}
 
-                for (int j = 0; j < runtime.nodeCount; j++)
-                {
-                    for (int k = 0; k < runtime.nodes[j].inputCount; k++)
-                    {
-                        if (!runtime.nodes[j].inputPins[k])
-                            continue;
-                        if (runtime.nodes[j].inputPins[k]->type == PIN_SPRITE_VARIABLE && runtime.nodes[j].inputPins[k]->pickedOption != 0)
-                        {
-                            const char *varPtr = graph->nodes[i].name;
-                            int picked = runtime.nodes[j].inputPins[k]->pickedOption - 1;
-                            if (picked < 0 || picked >= intp->varCount)
-                                continue;
-                            const char *valPtr = intp->values[intp->varIndexes[picked]].name;
-
-                            if (varPtr && valPtr)
-                            {
-                                char varName[MAX_VARIABLE_NAME_SIZE];
-                                char valName[MAX_VARIABLE_NAME_SIZE];
-                                strmac(varName, MAX_VARIABLE_NAME_SIZE, "%s", varPtr);
-                                strmac(valName, MAX_VARIABLE_NAME_SIZE, "%s", valPtr);
-
-                                if (strcmp(varName, valName) == 0)
-                                {
-                                    intp->values[intp->varIndexes[picked]].componentIndex = intp->componentCount;
-                                    runtime.nodes[j].inputPins[k]->valueIndex = intp->varIndexes[picked];
-                                }
-                            }
-                        }
-                    }
-                }
+// Axis-aligned rectangle against a polygon's convex pieces; the rectangle's own axes are the bounds tests
+static bool CheckCollisionRectPieces(const CollisionShape *rect, const CollisionShape *poly)
+{
+    static const int corners[4] = {0, 1, 2, 3};
 
-                intp->componentCount++;
-            }
-            break;
-        case NODE_DRAW_PROP_TEXTURE:
-            continue;
-        case NODE_DRAW_PROP_RECTANGLE:
-            intp->components[intp->componentCount].isSprite = false;
-            intp->components[intp->componentCount].isVisible = false;
-            intp->components[intp->componentCount].prop.propType = PROP_RECTANGLE;
-            if (node->inputPins[3] && node->inputPins[3]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.width = intp->values[node->inputPins[3]->valueIndex].number;
-            if (node->inputPins[4] && node->inputPins[4]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.height = intp->values[node->inputPins[4]->valueIndex].number;
-            if (node->inputPins[1] && node->inputPins[1]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.position.x = intp->values[node->inputPins[1]->valueIndex].number - intp->components[intp->componentCount].prop.width / 2;
-            if (node->inputPins[2] && node->inputPins[2]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.position.y = intp->values[node->inputPins[2]->valueIndex].number - intp->components[intp->componentCount].prop.height / 2;
-            if (node->inputPins[5] && node->inputPins[5]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.color = intp->values[node->inputPins[5]->valueIndex].color;
-            if (node->inputPins[6] && node->inputPins[6]->valueIndex < intp->valueCount)
-            {
-                if (intp->values[node->inputPins[6]->valueIndex].number < COMPONENT_LAYER_COUNT)
-                {
-                    intp->components[intp->componentCount].prop.layer = intp->values[node->inputPins[6]->valueIndex].number;
-                }
-                else if (intp->values[node->inputPins[6]->valueIndex].number < 0)
-                {
-                    intp->components[intp->componentCount].prop.layer = 0;
-                }
-                else
-                {
-                    intp->components[intp->componentCount].prop.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
-                }
-            }
+    if (poly->pieceCount == 0)
+        return CheckCollisionOutlines(rect, poly);
 
-            intp->components[intp->componentCount].prop.hitbox.type = HITBOX_RECT;
-            intp->components[intp->componentCount].prop.hitbox.rectHitboxSize = (Vector2){intp->components[intp->componentCount].prop.width, intp->components[intp->componentCount].prop.height};
-            intp->components[intp->componentCount].prop.hitbox.offset = (Vector2){0, 0};
+    for (int i = 0; i < poly->pieceCount; i++)
+    {
+        const ConvexPiece *piece = &poly->pieces[i];
+        if (DoBoundsOverlap(piece->bounds, rect->bounds) &&
+            !HasSeparatingEdge(poly->vertices, &poly->pieceIndexes[piece->first], piece->count, rect->vertices, corners, 4))
+            return true;
+    }
+    return false;
+}
 
-            if (node->outputPins[1])
-                node->outputPins[1]->componentIndex = intp->componentCount;
-            intp->componentCount++;
-            continue;
-        case NODE_DRAW_PROP_CIRCLE:
-            intp->components[intp->componentCount].isSprite = false;
-            intp->components[intp->componentCount].isVisible = false;
-            intp->components[intp->componentCount].prop.propType = PROP_CIRCLE;
-            if (node->inputPins[1] && node->inputPins[1]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.position.x = intp->values[node->inputPins[1]->valueIndex].number;
-            if (node->inputPins[2] && node->inputPins[2]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.position.y = intp->values[node->inputPins[2]->valueIndex].number;
-            if (node->inputPins[3] && node->inputPins[3]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.width = intp->values[node->inputPins[3]->valueIndex].number * 2;
-            if (node->inputPins[3] && node->inputPins[3]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.height = intp->values[node->inputPins[3]->valueIndex].number * 2;
-            if (node->inputPins[4] && node->inputPins[4]->valueIndex < intp->valueCount)
-                intp->components[intp->componentCount].prop.color = intp->values[node->inputPins[4]->valueIndex].color;
-            if (node->inputPins[5] && node->inputPins[5]->valueIndex < intp->valueCount)
-            {
-                if (intp->values[node->inputPins[5]->valueIndex].number < COMPONENT_LAYER_COUNT)
-                {
-                    intp->components[intp->componentCount].prop.layer = intp->values[node->inputPins[5]->valueIndex].number;
-                }
-                else if (intp->values[node->inputPins[5]->valueIndex].number < 0)
-                {
-                    intp->components[intp->componentCount].prop.layer = 0;
-                }
-                else
-                {
-                    intp->components[intp->componentCount].prop.layer = COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
-                }
-            }
+// Cheapest shapes first, so each pair of types has one place it is tested in
+static int GetShapeTestOrder(HitboxType type)
+{
+    switch (type)
+    {
+    case HITBOX_CIRCLE:
+        return 0;
+    case HITBOX_CAPSULE:
+        return 1;
+    case HITBOX_RECT:
+        return 2;
+    default:
+        return 3;
+    }
+}
 
-            intp->components[intp->componentCount].prop.hitbox.type = HITBOX_CIRCLE;
-            intp->components[intp->componentCount].prop.hitbox.circleHitboxRadius = intp->components[intp->componentCount].prop.width / 2;
-            intp->components[intp->componentCount].prop.hitbox.offset = (Vector2){0, 0};
+static bool CheckCollisionShapes(const CollisionShape *a, const CollisionShape *b)
+{
+    if (!HasCollisionShape(a) || !HasCollisionShape(b) || !DoBoundsOverlap(a->bounds, b->bounds))
+        return false;
 
-            if (node->outputPins[1])
-                node->outputPins[1]->componentIndex = intp->componentCount;
-            intp->componentCount++;
-            continue;
-        default:
-            break;
-        }
+    if (GetShapeTestOrder(a->type) > GetShapeTestOrder(b->type))
+    {
+        const CollisionShape *swap = a;
+        a = b;
+        b = swap;
     }
 
-    return runtime;
+    switch (a->type)
+    {
+    case HITBOX_CIRCLE:
+        if (b->type == HITBOX_CIRCLE)
+            return CheckCollisionCircles(a->center, a->radius, b->center, b->radius);
+        if (b->type == HITBOX_CAPSULE)
+            return CheckCollisionCircleLine(a->center, a->radius + b->radius, Vector2Subtract(b->center, b->axis), Vector2Add(b->center, b->axis));
+        if (b->type == HITBOX_RECT)
+            return CheckCollisionCircleRec(a->center, a->radius, b->bounds);
+        return CheckCollisionOutlineCircle(b, a->center, a->radius);
+    case HITBOX_CAPSULE:
+        if (b->type == HITBOX_CAPSULE)
+            return AreSegmentsWithin(Vector2Subtract(a->center, a->axis), Vector2Add(a->center, a->axis), Vector2Subtract(b->center, b->axis), Vector2Add(b->center, b->axis), a->radius + b->radius);
+        return CheckCollisionOutlineCapsule(b, a);
+    case HITBOX_RECT:
+        // Two axis-aligned rectangles overlap exactly when their bounds do
+        if (b->type == HITBOX_RECT)
+            return true;
+        return CheckCollisionRectPieces(a, b);
+    default:
+        return CheckCollisionPieces(a, b);
+    }
+}
+
+static bool DoCollisionGroupsMeet(InterpreterContext *intp, int groupA, int groupB)
+{
+    return (intp->collisionMasks[groupA] >> groupB) & 1u;
+}
+
+static bool IsBlockingLayer(int layer)
+{
+    return layer == COMPONENT_LAYER_BLOCKING || layer == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING;
+}
+
+static CollisionResult CheckCollisionPair(InterpreterContext *intp, int index, int j)
+{
+    SceneComponent *a = &intp->components[index];
+    SceneComponent *b = &intp->components[j];
+    if (!DoCollisionGroupsMeet(intp, a->collisionGroup, b->collisionGroup))
+    {
+        return COLLISION_RESULT_NONE;
+    }
+
+    int layerA = a->isSprite ? a->sprite.layer : a->prop.layer;
+    int layerB = b->isSprite ? b->sprite.layer : b->prop.layer;
+
+    bool aBlocks = IsBlockingLayer(layerA);
+    bool aEvents = (layerA == COMPONENT_LAYER_COLLISION_EVENTS || layerA == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
+
+    bool bBlocks = IsBlockingLayer(layerB);
+    bool bEvents = (layerB == COMPONENT_LAYER_COLLISION_EVENTS || layerB == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
+
+    if (!aBlocks && !aEvents && !bBlocks && !bEvents)
+    {
+        return COLLISION_RESULT_NONE;
+    }
+
+    if (!CheckCollisionShapes(GetCollisionShape(intp, index), GetCollisionShape(intp, j)))
+    {
+        return COLLISION_RESULT_NONE;
+    }
+
+    bool triggerEvent = aEvents || bEvents;
+    bool triggerBlock = aBlocks && bBlocks;
+
+    if (triggerEvent && triggerBlock)
+        return COLLISION_RESULT_EVENT_AND_BLOCKING;
+    if (triggerEvent)
+        return COLLISION_RESULT_EVENT;
+    if (triggerBlock)
+        return COLLISION_RESULT_BLOCKING;
+
+    return COLLISION_RESULT_NONE;
 }
 
-int DoesForceExist(InterpreterContext *intp, int id)
+#define COLLISION_GRID_MAX_COORDINATE 1.0e7f
+#define COLLISION_GRID_ENTRY_CHUNK 256
+#define COLLISION_BOUNDS_MARGIN 1.0f
+
+// Shape bounds with a small margin, false when the component can't collide
+static bool GetCollisionBounds(InterpreterContext *intp, int index, Rectangle *bounds)
 {
-    for (int i = 0; i < intp->forcesCount; i++)
-    {
-        if (intp->forces[i].id == id)
-            return i;
-    }
-    return -1;
+    CollisionShape *shape = GetCollisionShape(intp, index);
+    if (!HasCollisionShape(shape))
+        return false;
+
+    *bounds = shape->bounds;
+    bounds->x -= COLLISION_BOUNDS_MARGIN;
+    bounds->y -= COLLISION_BOUNDS_MARGIN;
+    bounds->width += COLLISION_BOUNDS_MARGIN * 2;
+    bounds->height += COLLISION_BOUNDS_MARGIN * 2;
+    return true;
 }
 
-void InterpretStringOfNodes(int lastNodeIndex, InterpreterContext *intp, RuntimeGraphContext *graph, int outFlowPinIndexInNode)
+static unsigned int CollisionBucketIndex(int cellX, int cellY)
 {
-    if (lastNodeIndex < 0 || lastNodeIndex >= graph->nodeCount)
-        return;
+    return ((unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u) & (COLLISION_GRID_BUCKETS - 1);
+}
 
-    if (graph->nodes[lastNodeIndex].outputCount == 0)
-        return;
+// False when the bounds are too large or too far out to bin
+static bool GetCellRange(Rectangle bounds, CollisionProxy *proxy)
+{
+    if (!isfinite(bounds.x) || !isfinite(bounds.y) || !isfinite(bounds.width) || !isfinite(bounds.height))
+        return false;
+    if (fabsf(bounds.x) > COLLISION_GRID_MAX_COORDINATE || fabsf(bounds.y) > COLLISION_GRID_MAX_COORDINATE || bounds.width > COLLISION_GRID_MAX_COORDINATE || bounds.height > COLLISION_GRID_MAX_COORDINATE)
+        return false;
 
-    if (graph->nodes[lastNodeIndex].outputPins[outFlowPinIndexInNode]->nextNodeIndex == -1)
-        return;
-    int currNodeIndex = graph->nodes[lastNodeIndex].outputPins[outFlowPinIndexInNode]->nextNodeIndex;
-    if (currNodeIndex < 0 || currNodeIndex >= graph->nodeCount)
-        return;
+    int minX = (int)floorf(bounds.x / COLLISION_GRID_CELL_SIZE);
+    int minY = (int)floorf(bounds.y / COLLISION_GRID_CELL_SIZE);
+    int maxX = (int)floorf((bounds.x + bounds.width) / COLLISION_GRID_CELL_SIZE);
+    int maxY = (int)floorf((bounds.y + bounds.height) / COLLISION_GRID_CELL_SIZE);
+    if ((maxX - minX + 1) * (maxY - minY + 1) > COLLISION_GRID_MAX_CELLS)
+        return false;
 
-    RuntimeNode *node = &graph->nodes[currNodeIndex];
+    proxy->minCellX = minX;
+    proxy->minCellY = minY;
+    proxy->maxCellX = maxX;
+    proxy->maxCellY = maxY;
+    return true;
+}
 
-    switch (node->type)
-    {
-    case NODE_UNKNOWN:
-    {
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Unknown node{I20E}"}, LOG_LEVEL_ERROR);
-        break;
-    }
+static void RemoveCollisionProxy(CollisionGrid *grid, int index)
+{
+    CollisionProxy *proxy = &grid->proxies[index];
+    if (!proxy->isInGrid)
+        return;
 
-    case NODE_CREATE_NUMBER:
+    if (proxy->isOversized)
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        for (int i = 0; i < grid->oversizedCount; i++)
         {
-            float *numToSet = &intp->values[node->outputPins[1]->valueIndex].number;
-            float newNum = intp->values[node->inputPins[1]->valueIndex].number;
-            *numToSet = newNum;
+            if (grid->oversized[i] == index)
+            {
+                grid->oversized[i] = grid->oversized[--grid->oversizedCount];
+                break;
+            }
         }
-        break;
     }
-
-    case NODE_CREATE_STRING:
+    else
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        for (int y = proxy->minCellY; y <= proxy->maxCellY; y++)
         {
-            char **strToSet = &intp->values[node->outputPins[1]->valueIndex].string;
-            char *newStr = intp->values[node->inputPins[1]->valueIndex].string;
-            *strToSet = newStr;
+            for (int x = proxy->minCellX; x <= proxy->maxCellX; x++)
+            {
+                CollisionGridEntry **link = &grid->buckets[CollisionBucketIndex(x, y)];
+                while (*link && (*link)->componentIndex != index)
+                {
+                    link = &(*link)->next;
+                }
+                if (*link)
+                {
+                    CollisionGridEntry *entry = *link;
+                    *link = entry->next;
+                    entry->next = grid->freeList;
+                    grid->freeList = entry;
+                }
+            }
         }
-        break;
     }
 
-    case NODE_CREATE_BOOL:
+    proxy->isInGrid = false;
+    proxy->isOversized = false;
+}
+
+static bool InsertCollisionProxy(InterpreterContext *intp, int index)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    CollisionProxy *proxy = &grid->proxies[index];
+
+    int cellCount = (proxy->maxCellX - proxy->minCellX + 1) * (proxy->maxCellY - proxy->minCellY + 1);
+    int available = 0;
+    for (CollisionGridEntry *entry = grid->freeList; entry && available < cellCount; entry = entry->next)
+    {
+        available++;
+    }
+    while (available < cellCount)
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        CollisionGridEntry *chunk = ArenaAlloc(&intp->arena, sizeof(CollisionGridEntry) * COLLISION_GRID_ENTRY_CHUNK);
+        if (!chunk)
+            return false;
+        for (int i = 0; i < COLLISION_GRID_ENTRY_CHUNK; i++)
         {
-            bool *boolToSet = &intp->values[node->outputPins[1]->valueIndex].boolean;
-            bool newBool = intp->values[node->inputPins[1]->valueIndex].boolean;
-            *boolToSet = newBool;
+            chunk[i].next = grid->freeList;
+            grid->freeList = &chunk[i];
         }
-        break;
+        available += COLLISION_GRID_ENTRY_CHUNK;
     }
 
-    case NODE_CREATE_COLOR:
+    for (int y = proxy->minCellY; y <= proxy->maxCellY; y++)
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        for (int x = proxy->minCellX; x <= proxy->maxCellX; x++)
         {
-            Color *colorToSet = &intp->values[node->outputPins[1]->valueIndex].color;
-            Color newColor = intp->values[node->inputPins[1]->valueIndex].color;
-            *colorToSet = intp->values[node->inputPins[1]->valueIndex].color;
+            unsigned int bucket = CollisionBucketIndex(x, y);
+            CollisionGridEntry *entry = grid->freeList;
+            grid->freeList = entry->next;
+            entry->componentIndex = index;
+            entry->next = grid->buckets[bucket];
+            grid->buckets[bucket] = entry;
         }
-        break;
     }
 
-    case NODE_EVENT_START:
+    proxy->isInGrid = true;
+    return true;
+}
+
+// Re-bins a component after it moved, cells are only touched when its cell range changed
+static void UpdateCollisionProxy(InterpreterContext *intp, int index)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    CollisionProxy *proxy = &grid->proxies[index];
+
+    Rectangle bounds;
+    if (!GetCollisionBounds(intp, index, &bounds))
     {
-        break;
+        RemoveCollisionProxy(grid, index);
+        return;
     }
+    proxy->collisionGroup = intp->components[index].collisionGroup;
 
-    case NODE_EVENT_TICK:
+    CollisionProxy range = *proxy;
+    bool isBinnable = GetCellRange(bounds, &range);
+    if (proxy->isInGrid && !proxy->isOversized && isBinnable &&
+        range.minCellX == proxy->minCellX && range.minCellY == proxy->minCellY && range.maxCellX == proxy->maxCellX && range.maxCellY == proxy->maxCellY)
     {
-        break;
+        proxy->bounds = bounds;
+        return;
     }
 
-    case NODE_EVENT_ON_BUTTON:
+    RemoveCollisionProxy(grid, index);
+    *proxy = range;
+    proxy->bounds = bounds;
+
+    if (isBinnable && InsertCollisionProxy(intp, index))
+        return;
+
+    proxy->isInGrid = true;
+    proxy->isOversized = true;
+    grid->oversized[grid->oversizedCount++] = index;
+}
+
+// Re-bins the sprites flow nodes moved since the grid last looked at them
+static void FlushMovedSprites(InterpreterContext *intp)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    for (int i = 0; i < grid->movedCount; i++)
     {
-        break;
+        int index = grid->movedSprites[i];
+        grid->isMoved[index] = false;
+        UpdateCollisionProxy(intp, index);
     }
+    grid->movedCount = 0;
+}
+
+static bool InitCollisionGrid(InterpreterContext *intp)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    *grid = (CollisionGrid){0};
+
+    if (intp->componentCount == 0)
+        return true;
 
-    case NODE_CREATE_CUSTOM_EVENT:
+    grid->buckets = ArenaAlloc(&intp->arena, sizeof(CollisionGridEntry *) * COLLISION_GRID_BUCKETS);
+    grid->proxies = ArenaAlloc(&intp->arena, sizeof(CollisionProxy) * intp->componentCount);
+    grid->oversized = ArenaAlloc(&intp->arena, sizeof(int) * intp->componentCount);
+    grid->scratch.candidates = ArenaAlloc(&intp->arena, sizeof(int) * intp->componentCount);
+    grid->scratch.visitStamp = ArenaAlloc(&intp->arena, sizeof(unsigned int) * intp->componentCount);
+    grid->movedSprites = ArenaAlloc(&intp->arena, sizeof(int) * intp->componentCount);
+    grid->isMoved = ArenaAlloc(&intp->arena, sizeof(bool) * intp->componentCount);
+    if (!grid->buckets || !grid->proxies || !grid->oversized || !grid->scratch.candidates || !grid->scratch.visitStamp || !grid->movedSprites || !grid->isMoved)
     {
-        break;
+        *grid = (CollisionGrid){0};
+        return false;
     }
 
-    case NODE_CALL_CUSTOM_EVENT:
+    for (int i = 0; i < intp->componentCount; i++)
     {
-        break;
+        UpdateCollisionProxy(intp, i);
     }
 
-    case NODE_GET_RANDOM_NUMBER:
+    return true;
+}
+
+static void NextScratchStamp(InterpreterContext *intp, CollisionScratch *scratch)
+{
+    if (++scratch->stamp == 0)
     {
-        break;
+        memset(scratch->visitStamp, 0, sizeof(unsigned int) * intp->componentCount);
+        scratch->stamp = 1;
     }
+}
 
-    case NODE_SET_VARIABLE:
+// Binned components in the cells of range whose bounds touch it and whose group is in collisionMask, sorted so results
+// match a scan in component order. Only reads the grid, so workers with their own scratch can query at the same time
+static int CollectGridCandidates(InterpreterContext *intp, const CollisionProxy *range, unsigned int collisionMask, CollisionScratch *scratch)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+
+    int count = 0;
+    for (int y = range->minCellY; y <= range->maxCellY; y++)
     {
-        if (node->outputPins[1]->valueIndex == -1)
+        for (int x = range->minCellX; x <= range->maxCellX; x++)
         {
-            break;
+            for (CollisionGridEntry *entry = grid->buckets[CollisionBucketIndex(x, y)]; entry; entry = entry->next)
+            {
+                int j = entry->componentIndex;
+                if (scratch->visitStamp[j] == scratch->stamp)
+                    continue;
+                scratch->visitStamp[j] = scratch->stamp;
+                if (((collisionMask >> grid->proxies[j].collisionGroup) & 1u) && DoBoundsOverlap(range->bounds, grid->proxies[j].bounds))
+                    scratch->candidates[count++] = j;
+            }
         }
-        Value *valToSet = &intp->values[node->outputPins[1]->valueIndex];
-        Value newValue = intp->values[node->inputPins[2]->valueIndex];
-        switch (valToSet->type)
+    }
+
+    for (int i = 0; i < grid->oversizedCount; i++)
+    {
+        int j = grid->oversized[i];
+        if (scratch->visitStamp[j] == scratch->stamp)
+            continue;
+        scratch->visitStamp[j] = scratch->stamp;
+        if ((collisionMask >> grid->proxies[j].collisionGroup) & 1u)
+            scratch->candidates[count++] = j;
+    }
+
+    for (int i = 1; i < count; i++)
+    {
+        int candidate = scratch->candidates[i];
+        int k = i - 1;
+        while (k >= 0 && scratch->candidates[k] > candidate)
         {
-        case VAL_NUMBER:
-            valToSet->number = newValue.number;
-            break;
-        case VAL_STRING:
-            valToSet->string = newValue.string;
-            break;
-        case VAL_BOOL:
-            valToSet->boolean = newValue.boolean;
-            break;
-        case VAL_COLOR:
-            valToSet->color = newValue.color;
-            break;
-        case VAL_SPRITE:
-            valToSet->sprite = newValue.sprite;
-            break;
-        default:
-            break;
+            scratch->candidates[k + 1] = scratch->candidates[k];
+            k--;
         }
-        break;
+        scratch->candidates[k + 1] = candidate;
     }
 
-    case NODE_SET_BACKGROUND:
+    return count;
+}
+
+// Components whose bounds touch the bounds of index and whose group it collides with
+static int QueryCollisionGrid(InterpreterContext *intp, int index, CollisionScratch *scratch)
+{
+    CollisionProxy *proxy = &intp->collisionGrid.proxies[index];
+    unsigned int collisionMask = intp->collisionMasks[proxy->collisionGroup];
+    if (collisionMask == 0)
+        return 0;
+
+    NextScratchStamp(intp, scratch);
+    scratch->visitStamp[index] = scratch->stamp;
+
+    return CollectGridCandidates(intp, proxy, collisionMask, scratch);
+}
+
+// First collision of index where it stands now. The component has to be binned already and every collision shape
+// up to date, then nothing is written but the scratch
+static CollisionResult FindCollision(InterpreterContext *intp, int index, CollisionScratch *scratch)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+
+    if (grid->proxies)
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        if (!grid->proxies[index].isInGrid)
+            return COLLISION_RESULT_NONE;
+
+        if (!grid->proxies[index].isOversized)
         {
-            intp->backgroundColor = intp->values[node->inputPins[1]->valueIndex].color;
+            int candidateCount = QueryCollisionGrid(intp, index, scratch);
+            for (int i = 0; i < candidateCount; i++)
+            {
+                CollisionResult result = CheckCollisionPair(intp, index, scratch->candidates[i]);
+                if (result != COLLISION_RESULT_NONE)
+                    return result;
+            }
+            return COLLISION_RESULT_NONE;
         }
-        break;
     }
 
-    case NODE_SET_FPS:
+    for (int j = 0; j < intp->componentCount; j++)
     {
-        intp->fps = intp->values[node->inputPins[1]->valueIndex].number;
-        break;
+        if (j == index)
+            continue;
+
+        CollisionResult result = CheckCollisionPair(intp, index, j);
+        if (result != COLLISION_RESULT_NONE)
+            return result;
     }
 
-    case NODE_BRANCH:
+    return COLLISION_RESULT_NONE;
+}
+
+// Candidates come from the grid, components too large to bin fall back to scanning everything
+CollisionResult CheckCollisions(InterpreterContext *intp, int index)
+{
+    if (index < 0 || index >= intp->componentCount)
+        return false;
+
+    if (intp->collisionGrid.proxies)
+        UpdateCollisionProxy(intp, index);
+
+    return FindCollision(intp, index, &intp->collisionGrid.scratch);
+}
+
+// Spatial queries only report shown components of the asked group, overlap and nearest queries only sprites
+static bool IsQueryTarget(InterpreterContext *intp, int index, int group, bool isSpriteOnly)
+{
+    SceneComponent *c = &intp->components[index];
+    return c->isVisible && c->collisionGroup == group && (c->isSprite || !isSpriteOnly);
+}
+
+// Grid candidates of group whose bounds touch area. -1 when there is no grid yet or the area spans too many cells,
+// then the caller scans every component instead
+static int GatherQueryCandidates(InterpreterContext *intp, Rectangle area, int group)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    if (!grid->proxies)
+        return -1;
+
+    FlushMovedSprites(intp);
+
+    CollisionProxy range = {.bounds = area};
+    if (!GetCellRange(area, &range))
+        return -1;
+
+    NextScratchStamp(intp, &grid->scratch);
+    return CollectGridCandidates(intp, &range, 1u << group, &grid->scratch);
+}
+
+static bool IntersectSegmentCircle(Vector2 center, float radius, Vector2 start, Vector2 delta, float *t)
+{
+    Vector2 offset = Vector2Subtract(start, center);
+    float lengthSqr = Vector2DotProduct(delta, delta);
+    float b = Vector2DotProduct(offset, delta);
+    float c = Vector2DotProduct(offset, offset) - radius * radius;
+    float discriminant = b * b - lengthSqr * c;
+    if (c <= 0 || discriminant < 0)
+        return false;
+
+    float hit = (-b - sqrtf(discriminant)) / lengthSqr;
+    if (hit < 0 || hit > 1)
+        return false;
+    *t = hit;
+    return true;
+}
+
+// Where the segment first enters the shape, as a fraction of its length. A segment starting inside a shape does not hit it
+static bool IntersectSegmentShape(const CollisionShape *shape, Vector2 start, Vector2 end, float *t)
+{
+    Vector2 delta = Vector2Subtract(end, start);
+    float lengthSqr = Vector2DotProduct(delta, delta);
+    if (!HasCollisionShape(shape) || lengthSqr == 0)
+        return false;
+
+    if (shape->type == HITBOX_CIRCLE)
+        return IntersectSegmentCircle(shape->center, shape->radius, start, delta, t);
+
+    // The segment enters the capsule where it first enters one of its end circles or crosses one of its sides
+    if (shape->type == HITBOX_CAPSULE)
     {
-        bool *condition = &intp->values[node->inputPins[1]->valueIndex].boolean;
-        if (*condition)
+        Vector2 capStart = Vector2Subtract(shape->center, shape->axis);
+        Vector2 capEnd = Vector2Add(shape->center, shape->axis);
+        if (DistanceToSegment(start, capStart, capEnd) <= shape->radius)
+            return false;
+
+        Vector2 side = Vector2Scale(Vector2Normalize((Vector2){-shape->axis.y, shape->axis.x}), shape->radius);
+        bool isHit = false;
+        float hit;
+        if (IntersectSegmentCircle(capStart, shape->radius, start, delta, &hit))
         {
-            InterpretStringOfNodes(currNodeIndex, intp, graph, 0);
+            *t = hit;
+            isHit = true;
         }
-        else
+        if (IntersectSegmentCircle(capEnd, shape->radius, start, delta, &hit) && (!isHit || hit < *t))
         {
-            InterpretStringOfNodes(currNodeIndex, intp, graph, 1);
+            *t = hit;
+            isHit = true;
         }
-        return;
-        break;
-    }
-
-    case NODE_LOOP:
-    {
-        int steps = 1000;
-        bool *condition = &intp->values[node->inputPins[1]->valueIndex].boolean;
-        while (*condition)
+        for (int k = -1; k <= 1; k += 2)
         {
-            if (steps == 0)
-            {
-                if (intp->isInfiniteLoopProtectionOn)
-                {
-                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Possible infinite loop detected and exited! You can turn off infinite loop protection in settings{I210}"}, LOG_LEVEL_ERROR);
-                    break;
-                }
-                else
-                {
-                    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Possible infinite loop detected! Infinite loop protection is off!{I101}"}, LOG_LEVEL_WARNING);
-                }
-            }
-            else
+            Vector2 point;
+            Vector2 offset = Vector2Scale(side, k);
+            if (!CheckCollisionLines(start, end, Vector2Add(capStart, offset), Vector2Add(capEnd, offset), &point))
+                continue;
+
+            hit = Vector2DotProduct(Vector2Subtract(point, start), delta) / lengthSqr;
+            if (!isHit || hit < *t)
             {
-                steps--;
+                *t = hit;
+                isHit = true;
             }
-            InterpretStringOfNodes(currNodeIndex, intp, graph, 1);
         }
-        break;
+        return isHit;
     }
 
-    case NODE_CREATE_SPRITE:
+    if (CheckCollisionPointPoly(start, shape->vertices, shape->vertexCount))
+        return false;
+
+    bool isHit = false;
+    for (int i = 0; i < shape->vertexCount; i++)
     {
-        Sprite *sprite = &intp->values[node->outputPins[1]->valueIndex].sprite;
-        if (node->inputPins[2]->valueIndex != -1)
+        Vector2 point;
+        if (!CheckCollisionLines(start, end, shape->vertices[i], shape->vertices[(i + 1) % shape->vertexCount], &point))
+            continue;
+
+        float hit = Vector2DotProduct(Vector2Subtract(point, start), delta) / lengthSqr;
+        if (!isHit || hit < *t)
         {
-            sprite->width = intp->values[node->inputPins[2]->valueIndex].number;
+            *t = hit;
+            isHit = true;
         }
-        if (node->inputPins[3]->valueIndex != -1)
+    }
+    return isHit;
+}
+
+// Keeps the closest hit, equally close hits go to the lower component index whatever order they were visited in
+static void TestRaycastTarget(InterpreterContext *intp, int index, Vector2 start, Vector2 end, int group, float *bestT, int *best)
+{
+    float t;
+    if (!IsQueryTarget(intp, index, group, false) || !IntersectSegmentShape(GetCollisionShape(intp, index), start, end, &t))
+        return;
+
+    if (t < *bestT || (t == *bestT && index < *best))
+    {
+        *bestT = t;
+        *best = index;
+    }
+}
+
+// Walks the grid cells along the segment and stops at the first cell that ends past the closest hit so far.
+// Segments crossing more cells than there are components are cheaper to check against every component
+bool RaycastComponents(InterpreterContext *intp, Vector2 start, Vector2 end, int group, int *componentIndex, Vector2 *hitPoint)
+{
+    *componentIndex = -1;
+    *hitPoint = end;
+    if (group < 0 || group >= MAX_COLLISION_GROUPS)
+        return false;
+
+    CollisionGrid *grid = &intp->collisionGrid;
+    float bestT = INFINITY;
+    int best = -1;
+
+    bool isWalkable = grid->proxies != NULL;
+    float coordinates[] = {start.x, start.y, end.x, end.y};
+    for (int i = 0; i < 4; i++)
+    {
+        isWalkable = isWalkable && isfinite(coordinates[i]) && fabsf(coordinates[i]) <= COLLISION_GRID_MAX_COORDINATE;
+    }
+
+    int cellX = 0, cellY = 0, steps = 0;
+    if (isWalkable)
+    {
+        cellX = (int)floorf(start.x / COLLISION_GRID_CELL_SIZE);
+        cellY = (int)floorf(start.y / COLLISION_GRID_CELL_SIZE);
+        steps = abs((int)floorf(end.x / COLLISION_GRID_CELL_SIZE) - cellX) + abs((int)floorf(end.y / COLLISION_GRID_CELL_SIZE) - cellY);
+        isWalkable = steps < intp->componentCount;
+    }
+
+    if (!isWalkable)
+    {
+        for (int j = 0; j < intp->componentCount; j++)
         {
-            sprite->height = intp->values[node->inputPins[3]->valueIndex].number;
+            TestRaycastTarget(intp, j, start, end, group, &bestT, &best);
         }
-        if (node->inputPins[4]->valueIndex != -1)
+    }
+    else
+    {
+        FlushMovedSprites(intp);
+
+        CollisionScratch *scratch = &grid->scratch;
+        NextScratchStamp(intp, scratch);
+        Rectangle area = {fminf(start.x, end.x), fminf(start.y, end.y), fabsf(end.x - start.x), fabsf(end.y - start.y)};
+
+        for (int i = 0; i < grid->oversizedCount; i++)
         {
-            sprite->layer = intp->values[node->inputPins[4]->valueIndex].number;
+            int j = grid->oversized[i];
+            scratch->visitStamp[j] = scratch->stamp;
+            TestRaycastTarget(intp, j, start, end, group, &bestT, &best);
         }
-        Texture2D tempTex = intp->components[node->outputPins[1]->componentIndex].sprite.texture;
-        Polygon tempHitbox = intp->components[node->outputPins[1]->componentIndex].sprite.hitbox.polygonHitbox;
-        intp->components[node->outputPins[1]->componentIndex].sprite = *sprite;
-        intp->components[node->outputPins[1]->componentIndex].sprite.texture = tempTex;
-        intp->components[node->outputPins[1]->componentIndex].sprite.hitbox.type = HITBOX_POLY;
-        intp->components[node->outputPins[1]->componentIndex].sprite.hitbox.polygonHitbox = tempHitbox;
-        break;
-    }
 
-    case NODE_SPAWN_SPRITE:
-    {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+        Vector2 delta = Vector2Subtract(end, start);
+        int stepX = delta.x > 0 ? 1 : -1;
+        int stepY = delta.y > 0 ? 1 : -1;
+        float tDeltaX = delta.x != 0 ? COLLISION_GRID_CELL_SIZE / fabsf(delta.x) : INFINITY;
+        float tDeltaY = delta.y != 0 ? COLLISION_GRID_CELL_SIZE / fabsf(delta.y) : INFINITY;
+        float tMaxX = delta.x != 0 ? ((cellX + (delta.x > 0)) * (float)COLLISION_GRID_CELL_SIZE - start.x) / delta.x : INFINITY;
+        float tMaxY = delta.y != 0 ? ((cellY + (delta.y > 0)) * (float)COLLISION_GRID_CELL_SIZE - start.y) / delta.y : INFINITY;
+
+        while (true)
         {
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].isVisible = true;
-            if (node->inputPins[2]->valueIndex != -1)
+            for (CollisionGridEntry *entry = grid->buckets[CollisionBucketIndex(cellX, cellY)]; entry; entry = entry->next)
             {
-                intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.position.x = intp->values[node->inputPins[2]->valueIndex].number;
+                int j = entry->componentIndex;
+                if (scratch->visitStamp[j] == scratch->stamp)
+                    continue;
+                scratch->visitStamp[j] = scratch->stamp;
+                if (grid->proxies[j].collisionGroup == group && DoBoundsOverlap(area, grid->proxies[j].bounds))
+                    TestRaycastTarget(intp, j, start, end, group, &bestT, &best);
             }
-            if (node->inputPins[3]->valueIndex != -1)
+
+            if (steps-- == 0 || bestT < fminf(tMaxX, tMaxY))
+                break;
+
+            if (tMaxX < tMaxY)
             {
-                intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.position.y = intp->values[node->inputPins[3]->valueIndex].number;
+                cellX += stepX;
+                tMaxX += tDeltaX;
             }
-            if (node->inputPins[4]->valueIndex != -1)
+            else
             {
-                intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.rotation = -1 * (intp->values[node->inputPins[4]->valueIndex].number - 360);
+                cellY += stepY;
+                tMaxY += tDeltaY;
             }
         }
-        break;
     }
 
-    case NODE_DESTROY_SPRITE:
+    if (best == -1)
+        return false;
+
+    *componentIndex = best;
+    *hitPoint = Vector2Lerp(start, end, bestT);
+    return true;
+}
+
+// Sprites overlapping area, the lowest component index is reported first
+static int OverlapSprites(InterpreterContext *intp, const CollisionShape *area, int group, int *firstSprite)
+{
+    *firstSprite = -1;
+    if (group < 0 || group >= MAX_COLLISION_GROUPS)
+        return 0;
+
+    int candidateCount = GatherQueryCandidates(intp, area->bounds, group);
+    int scanCount = candidateCount < 0 ? intp->componentCount : candidateCount;
+
+    int count = 0;
+    for (int i = 0; i < scanCount; i++)
+    {
+        int j = candidateCount < 0 ? i : intp->collisionGrid.scratch.candidates[i];
+        if (!IsQueryTarget(intp, j, group, true) || !CheckCollisionShapes(area, GetCollisionShape(intp, j)))
+            continue;
+
+        if (count++ == 0)
+            *firstSprite = j;
+    }
+    return count;
+}
+
+int OverlapCircleSprites(InterpreterContext *intp, Vector2 center, float radius, int group, int *firstSprite)
+{
+    radius = fmaxf(radius, 0);
+    CollisionShape area = {.type = HITBOX_CIRCLE, .center = center, .radius = radius, .bounds = {center.x - radius, center.y - radius, radius * 2, radius * 2}};
+    return OverlapSprites(intp, &area, group, firstSprite);
+}
+
+int OverlapRectangleSprites(InterpreterContext *intp, Rectangle rect, int group, int *firstSprite)
+{
+    Rectangle bounds = {fminf(rect.x, rect.x + rect.width), fminf(rect.y, rect.y + rect.height), fabsf(rect.width), fabsf(rect.height)};
+    Vector2 vertices[4] = {
+        {bounds.x, bounds.y},
+        {bounds.x + bounds.width, bounds.y},
+        {bounds.x + bounds.width, bounds.y + bounds.height},
+        {bounds.x, bounds.y + bounds.height}};
+    CollisionShape area = {.type = HITBOX_RECT, .bounds = bounds, .vertices = vertices, .vertexCount = 4};
+    return OverlapSprites(intp, &area, group, firstSprite);
+}
+
+// Distance is measured to the center of the hitbox bounds, -1 when no sprite is that close
+int FindNearestSprite(InterpreterContext *intp, Vector2 point, float radius, int group, float *distance)
+{
+    *distance = 0;
+    if (group < 0 || group >= MAX_COLLISION_GROUPS || !(radius >= 0))
+        return -1;
+
+    Rectangle area = {point.x - radius, point.y - radius, radius * 2, radius * 2};
+    int candidateCount = GatherQueryCandidates(intp, area, group);
+    int scanCount = candidateCount < 0 ? intp->componentCount : candidateCount;
+
+    int nearest = -1;
+    float nearestDistance = radius;
+    for (int i = 0; i < scanCount; i++)
+    {
+        int j = candidateCount < 0 ? i : intp->collisionGrid.scratch.candidates[i];
+        CollisionShape *shape = GetCollisionShape(intp, j);
+        if (!IsQueryTarget(intp, j, group, true) || !HasCollisionShape(shape))
+            continue;
+
+        Vector2 center = {shape->bounds.x + shape->bounds.width / 2, shape->bounds.y + shape->bounds.height / 2};
+        float d = Vector2Distance(point, center);
+        if (d < nearestDistance || (d == nearestDistance && nearest == -1))
+        {
+            nearest = j;
+            nearestDistance = d;
+        }
+    }
+
+    if (nearest != -1)
+        *distance = nearestDistance;
+    return nearest;
+}
+
+// Starts, resizes or stops the worker threads to match physicsWorkerCount and makes room in their grid scratch
+static void PreparePhysicsPool(InterpreterContext *intp)
+{
+    int workerCount = intp->physicsWorkerCount;
+    if (workerCount > MAX_PHYSICS_WORKERS)
+        workerCount = MAX_PHYSICS_WORKERS;
+
+    if (intp->physicsPool && intp->physicsPool->workerCount != workerCount)
+    {
+        StopPhysicsPool(intp->physicsPool);
+        intp->physicsPool = NULL;
+    }
+
+    if (workerCount < 2)
+        return;
+
+    if (!intp->physicsPool)
     {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+        intp->physicsPool = StartPhysicsPool(workerCount);
+        if (!intp->physicsPool)
         {
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].isVisible = false;
+            intp->physicsWorkerCount = 1;
+            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Could not start physics threads, physics runs on the game thread{I107}"}, LOG_LEVEL_WARNING);
+            return;
         }
-        break;
     }
 
-    case NODE_SET_SPRITE_POSITION:
+    struct PhysicsPool *pool = intp->physicsPool;
+    if (pool->scratchCapacity < intp->componentCount)
     {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+        for (int i = 1; i < workerCount; i++)
         {
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.position.x = intp->values[node->inputPins[2]->valueIndex].number;
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.position.y = intp->values[node->inputPins[3]->valueIndex].number;
+            free(pool->scratch[i].candidates);
+            free(pool->scratch[i].visitStamp);
+            pool->scratch[i].candidates = malloc(sizeof(int) * intp->componentCount);
+            pool->scratch[i].visitStamp = calloc(intp->componentCount, sizeof(unsigned int));
+            pool->scratch[i].stamp = 0;
+            if (!pool->scratch[i].candidates || !pool->scratch[i].visitStamp)
+            {
+                StopPhysicsPool(pool);
+                intp->physicsPool = NULL;
+                intp->physicsWorkerCount = 1;
+                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: physics threads, physics runs on the game thread{I107}"}, LOG_LEVEL_WARNING);
+                return;
+            }
         }
-        break;
+        pool->scratchCapacity = intp->componentCount;
     }
+}
 
-    case NODE_SET_SPRITE_ROTATION:
+static CollisionScratch *GetPhysicsScratch(InterpreterContext *intp, int worker)
+{
+    return worker == 0 ? &intp->collisionGrid.scratch : &intp->physicsPool->scratch[worker];
+}
+
+static void IntegrateBodiesJob(InterpreterContext *intp, int worker, int first, int last)
+{
+    RigidBodies *bodies = &intp->bodies;
+    float deltaTime = GetFrameTime();
+
+    float *velocityX = bodies->velocityX;
+    float *velocityY = bodies->velocityY;
+    const float *gravity = bodies->gravity;
+    const float *damping = bodies->damping;
+    const float *pushX = bodies->pushX;
+    const float *pushY = bodies->pushY;
+    float *stepX = bodies->stepX;
+    float *stepY = bodies->stepY;
+
+    for (int i = first; i < last; i++)
     {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
-        {
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.rotation = -1 * (intp->values[node->inputPins[2]->valueIndex].number - 360);
-        }
-        break;
+        float keep = 1.0f / (1.0f + damping[i] * deltaTime);
+        velocityX[i] = velocityX[i] * keep;
+        velocityY[i] = (velocityY[i] + gravity[i] * deltaTime) * keep;
+        stepX[i] = (velocityX[i] + pushX[i]) * deltaTime;
+        stepY[i] = (velocityY[i] + pushY[i]) * deltaTime;
     }
+}
 
-    case NODE_SET_SPRITE_TEXTURE:
+// Moves every sprite by its step and brings every collision shape up to date, the narrow phase only reads them after this
+static void MoveBodiesJob(InterpreterContext *intp, int worker, int first, int last)
+{
+    RigidBodies *bodies = &intp->bodies;
+
+    for (int i = first; i < last; i++)
     {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+        SceneComponent *c = &intp->components[i];
+        bodies->isBlocked[i] = false;
+        if (c->isSprite && (bodies->stepX[i] != 0 || bodies->stepY[i] != 0))
         {
-            UnloadTexture(intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.texture);
-            char path[MAX_FILE_PATH];
-            strmac(path, MAX_FILE_PATH, "%s%c%s", intp->projectPath, PATH_SEPARATOR, intp->values[node->inputPins[2]->valueIndex].string);
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.texture = LoadTexture(path);
+            bodies->previousX[i] = c->sprite.position.x;
+            bodies->previousY[i] = c->sprite.position.y;
+            c->sprite.position.x += bodies->stepX[i];
+            c->sprite.position.y += bodies->stepY[i];
         }
-        break;
+        GetCollisionShape(intp, i);
     }
+}
 
-    case NODE_SET_SPRITE_SIZE:
+// A step longer than this share of the body's smaller side could carry it past something thin, so it is swept
+#define SWEEP_STEP_FRACTION 0.5f
+#define SWEEP_MAX_SUBSTEPS 64
+#define SWEEP_BISECTION_STEPS 10
+
+// A body's shape moved back along its step, kept on the worker's stack so positions the body only passes through
+// can be tested without touching the shared shape cache
+typedef struct SweptShape
+{
+    CollisionShape shape;
+    Vector2 vertices[MAX_POLYGON_VERTICES];
+    ConvexPiece pieces[MAX_POLYGON_VERTICES];
+} SweptShape;
+
+static void PlaceSweptShape(SweptShape *swept, const CollisionShape *shape, Vector2 offset)
+{
+    swept->shape = *shape;
+    swept->shape.bounds.x += offset.x;
+    swept->shape.bounds.y += offset.y;
+    swept->shape.center = Vector2Add(shape->center, offset);
+
+    if (shape->vertices)
     {
-        if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+        for (int i = 0; i < shape->vertexCount; i++)
         {
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.width = intp->values[node->inputPins[2]->valueIndex].number;
-            intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex].sprite.height = intp->values[node->inputPins[3]->valueIndex].number;
+            swept->vertices[i] = Vector2Add(shape->vertices[i], offset);
         }
-        break;
+        swept->shape.vertices = swept->vertices;
     }
 
-    case NODE_MOVE_TO_SPRITE:
+    for (int i = 0; i < shape->pieceCount; i++)
     {
-        break;
+        swept->pieces[i] = shape->pieces[i];
+        swept->pieces[i].bounds.x += offset.x;
+        swept->pieces[i].bounds.y += offset.y;
     }
+    swept->shape.pieces = swept->pieces;
+}
 
-    case NODE_FORCE_SPRITE:
+// Components the body could meet anywhere along its step, -1 when it has to be tested against every component
+static int GatherSweepCandidates(InterpreterContext *intp, int index, Rectangle sweep, CollisionScratch *scratch)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    if (!grid->proxies)
+        return -1;
+
+    CollisionProxy range = {.bounds = sweep};
+    if (!GetCellRange(sweep, &range))
+        return -1;
+
+    NextScratchStamp(intp, scratch);
+    scratch->visitStamp[index] = scratch->stamp;
+    return CollectGridCandidates(intp, &range, intp->collisionMasks[intp->components[index].collisionGroup], scratch);
+}
+
+static bool IsSweptBodyBlocked(InterpreterContext *intp, int index, const CollisionShape *moved, const int *candidates, int candidateCount)
+{
+    SceneComponent *body = &intp->components[index];
+    int count = candidateCount < 0 ? intp->componentCount : candidateCount;
+    for (int k = 0; k < count; k++)
+    {
+        int j = candidateCount < 0 ? k : candidates[k];
+        SceneComponent *other = &intp->components[j];
+        if (j == index || !DoCollisionGroupsMeet(intp, body->collisionGroup, other->collisionGroup) || !IsBlockingLayer(other->isSprite ? other->sprite.layer : other->prop.layer))
+            continue;
+
+        if (CheckCollisionShapes(moved, GetCollisionShape(intp, j)))
+            return true;
+    }
+    return false;
+}
+
+// Share of the step during which the body's bounds, moved back along its step, overlap other; false when they never do
+static bool FindSweptBoundsWindow(Rectangle end, Vector2 step, Rectangle other, float *enter, float *exit)
+{
+    float from = 0;
+    float to = 1;
+    float ends[2] = {end.x, end.y};
+    float sizes[2] = {end.width, end.height};
+    float steps[2] = {step.x, step.y};
+    float starts[2] = {other.x, other.y};
+    float extents[2] = {other.width, other.height};
+    for (int axis = 0; axis < 2; axis++)
     {
-        SceneComponent *component = &intp->components[intp->values[node->inputPins[1]->valueIndex].componentIndex];
-        int forceIndex = DoesForceExist(intp, node->index);
-        if (forceIndex != -1)
+        float low = starts[axis] - sizes[axis];
+        float high = starts[axis] + extents[axis];
+        if (steps[axis] == 0)
         {
-            intp->forces[forceIndex].duration = intp->values[node->inputPins[4]->valueIndex].number;
+            if (ends[axis] < low || ends[axis] > high)
+                return false;
+            continue;
         }
-        else if (intp->values[node->inputPins[1]->valueIndex].componentIndex >= 0 && intp->values[node->inputPins[1]->valueIndex].componentIndex < intp->componentCount)
+
+        float a = (low - ends[axis]) / steps[axis] + 1;
+        float b = (high - ends[axis]) / steps[axis] + 1;
+        from = fmaxf(from, fminf(a, b));
+        to = fminf(to, fmaxf(a, b));
+    }
+
+    *enter = from;
+    *exit = to;
+    return from <= to;
+}
+
+// Share of its step a body takes before something blocks it, and where it first touches it. Fast bodies are sampled
+// along the stretch of the step where their bounds overlap each blocker's, in pieces no longer than half their smaller
+// side, so they can't pass through thin props however fast they go. The piece they first touch in is then halved down
+// to the contact. The body stops just short of the contact so it can still slide away along the blocker next frame
+static float FindImpactTime(InterpreterContext *intp, int index, bool isBlockedAtEnd, CollisionScratch *scratch, float *touchTime)
+{
+    RigidBodies *bodies = &intp->bodies;
+    CollisionShape *shape = GetCollisionShape(intp, index);
+    Vector2 step = {bodies->stepX[index], bodies->stepY[index]};
+    *touchTime = 1;
+    if (!HasCollisionShape(shape) || shape->vertexCount > MAX_POLYGON_VERTICES || shape->pieceCount > MAX_POLYGON_VERTICES)
+        return isBlockedAtEnd ? 0 : 1;
+
+    float length = Vector2Length(step);
+    float piece = fminf(shape->bounds.width, shape->bounds.height) * SWEEP_STEP_FRACTION;
+    bool isFast = length > piece;
+    if (!isFast && !isBlockedAtEnd)
+        return 1;
+
+    Rectangle end = shape->bounds;
+    Rectangle sweep = {fminf(end.x, end.x - step.x), fminf(end.y, end.y - step.y), end.width + fabsf(step.x), end.height + fabsf(step.y)};
+    sweep.x -= COLLISION_BOUNDS_MARGIN;
+    sweep.y -= COLLISION_BOUNDS_MARGIN;
+    sweep.width += COLLISION_BOUNDS_MARGIN * 2;
+    sweep.height += COLLISION_BOUNDS_MARGIN * 2;
+    int candidateCount = GatherSweepCandidates(intp, index, sweep, scratch);
+
+    SweptShape swept;
+    float hit = isBlockedAtEnd ? 1 : -1;
+    float spacing = piece > 0 ? piece / length : 1;
+    int count = candidateCount < 0 ? intp->componentCount : candidateCount;
+    for (int k = 0; k < count && isFast; k++)
+    {
+        int j = candidateCount < 0 ? k : scratch->candidates[k];
+        SceneComponent *other = &intp->components[j];
+        CollisionShape *otherShape = GetCollisionShape(intp, j);
+        float enter, exit;
+        if (j == index || !DoCollisionGroupsMeet(intp, intp->components[index].collisionGroup, other->collisionGroup) ||
+            !IsBlockingLayer(other->isSprite ? other->sprite.layer : other->prop.layer) || !HasCollisionShape(otherShape) ||
+            !FindSweptBoundsWindow(end, step, otherShape->bounds, &enter, &exit))
+            continue;
+
+        int samples = 0;
+        for (float t = enter; t <= exit && t < 1 && (hit < 0 || t < hit) && samples < SWEEP_MAX_SUBSTEPS; t += spacing, samples++)
         {
-            intp->forces[intp->forcesCount].id = node->index;
-            intp->forces[intp->forcesCount].componentIndex = intp->values[node->inputPins[1]->valueIndex].componentIndex;
-            intp->forces[intp->forcesCount].pixelsPerSecond = intp->values[node->inputPins[2]->valueIndex].number;
-            intp->forces[intp->forcesCount].angle = intp->values[node->inputPins[3]->valueIndex].number;
-            intp->forces[intp->forcesCount].duration = intp->values[node->inputPins[4]->valueIndex].number;
-            intp->forcesCount++;
+            PlaceSweptShape(&swept, shape, Vector2Scale(step, t - 1));
+            if (CheckCollisionShapes(&swept.shape, otherShape))
+            {
+                hit = t;
+                break;
+            }
         }
-        break;
     }
+    if (hit < 0)
+        return 1;
 
-    case NODE_DRAW_PROP_TEXTURE:
+    // Back off a piece at a time until the body is clear of every blocker, which it is at the latest where the step starts
+    float free = hit;
+    do
     {
-        break;
+        free = fmaxf(free - spacing, 0);
+        PlaceSweptShape(&swept, shape, Vector2Scale(step, free - 1));
+        if (!IsSweptBodyBlocked(intp, index, &swept.shape, scratch->candidates, candidateCount))
+            break;
+        hit = free;
+    } while (free > 0);
+    if (hit == free)
+        return 0;
+
+    bool isTouchingAtEnd = hit == 1;
+
+    for (int k = 0; k < SWEEP_BISECTION_STEPS; k++)
+    {
+        float middle = (free + hit) / 2;
+        PlaceSweptShape(&swept, shape, Vector2Scale(step, middle - 1));
+        if (IsSweptBodyBlocked(intp, index, &swept.shape, scratch->candidates, candidateCount))
+            hit = middle;
+        else
+            free = middle;
     }
 
-    case NODE_DRAW_PROP_RECTANGLE:
+    if (!isTouchingAtEnd)
+        *touchTime = hit;
+    return free;
+}
+
+static void CheckBodiesJob(InterpreterContext *intp, int worker, int first, int last)
+{
+    RigidBodies *bodies = &intp->bodies;
+    CollisionScratch *scratch = GetPhysicsScratch(intp, worker);
+
+    for (int i = first; i < last; i++)
     {
-        intp->components[node->outputPins[1]->componentIndex].isVisible = true;
-        break;
+        if (!intp->components[i].isSprite || (bodies->stepX[i] == 0 && bodies->stepY[i] == 0))
+            continue;
+
+        CollisionResult result = FindCollision(intp, i, scratch);
+        bool isBlockedAtEnd = result == COLLISION_RESULT_BLOCKING || result == COLLISION_RESULT_EVENT_AND_BLOCKING;
+        bool isBlocking = IsBlockingLayer(intp->components[i].sprite.layer);
+
+        bodies->touchTime[i] = 1;
+        bodies->impactTime[i] = isBlocking ? FindImpactTime(intp, i, isBlockedAtEnd, scratch, &bodies->touchTime[i]) : 1;
+        bodies->isBlocked[i] = isBlockedAtEnd || bodies->impactTime[i] < 1;
     }
+}
 
-    case NODE_DRAW_PROP_CIRCLE:
+static void PushContact(ContactList *list, int a, int b, ContactState state)
+{
+    if (list->count == list->capacity)
     {
-        intp->components[node->outputPins[1]->componentIndex].isVisible = true;
-        break;
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        ContactPair *pairs = realloc(list->pairs, sizeof(ContactPair) * capacity);
+        if (!pairs)
+        {
+            list->outOfMemory = true;
+            return;
+        }
+        list->pairs = pairs;
+        list->capacity = capacity;
     }
+    list->pairs[list->count++] = (ContactPair){a, b, state};
+}
 
-    case NODE_COMPARISON:
+static void AddContactIfTouching(InterpreterContext *intp, ContactList *found, int index, int j)
+{
+    // Two sprites are only checked from the lower index, props never look for contacts themselves
+    if (j == index || (intp->components[j].isSprite && j < index))
+        return;
+
+    CollisionResult result = CheckCollisionPair(intp, index, j);
+    if (result == COLLISION_RESULT_EVENT || result == COLLISION_RESULT_EVENT_AND_BLOCKING)
+        PushContact(found, index < j ? index : j, index < j ? j : index, CONTACT_BEGIN);
+}
+
+static void FindContactsJob(InterpreterContext *intp, int worker, int first, int last)
+{
+    CollisionGrid *grid = &intp->collisionGrid;
+    CollisionScratch *scratch = GetPhysicsScratch(intp, worker);
+    ContactList *found = &intp->contacts.found[worker];
+
+    for (int i = first; i < last; i++)
     {
-        float numA = intp->values[node->inputPins[2]->valueIndex].number;
-        float numB = intp->values[node->inputPins[3]->valueIndex].number;
-        bool *result = &intp->values[node->outputPins[1]->valueIndex].boolean;
-        switch (node->inputPins[1]->pickedOption)
+        if (!intp->components[i].isSprite)
+            continue;
+
+        if (grid->proxies && !grid->proxies[i].isInGrid)
+            continue;
+
+        if (grid->proxies && !grid->proxies[i].isOversized)
         {
-        case EQUAL_TO:
-            *result = numA == numB;
-            break;
-        case GREATER_THAN:
-            *result = numA > numB;
-            break;
-        case LESS_THAN:
-            *result = numA < numB;
-            break;
-        default:
-            break;
+            int candidateCount = QueryCollisionGrid(intp, i, scratch);
+            for (int k = 0; k < candidateCount; k++)
+            {
+                AddContactIfTouching(intp, found, i, scratch->candidates[k]);
+            }
+            continue;
+        }
+
+        for (int j = 0; j < intp->componentCount; j++)
+        {
+            AddContactIfTouching(intp, found, i, j);
         }
-        break;
     }
+}
 
-    case NODE_GATE:
+static int CompareContactPairs(const void *a, const void *b)
+{
+    const ContactPair *x = a;
+    const ContactPair *y = b;
+    if (x->a != y->a)
+        return x->a < y->a ? -1 : 1;
+    return (x->b > y->b) - (x->b < y->b);
+}
+
+// Every touching pair once, then a merge against the last pass sorts them into begun, staying and ended.
+// Returns false when a pair list could not grow
+static bool FindContacts(InterpreterContext *intp)
+{
+    ContactCache *contacts = &intp->contacts;
+    for (int w = 0; w < MAX_PHYSICS_WORKERS; w++)
+    {
+        contacts->found[w].count = 0;
+    }
+
+    RunPhysicsJob(intp, FindContactsJob, intp->componentCount);
+
+    ContactList previous = contacts->touching;
+    ContactList touching = contacts->previous;
+    touching.count = 0;
+    contacts->ended.count = 0;
+
+    bool outOfMemory = false;
+    for (int w = 0; w < MAX_PHYSICS_WORKERS; w++)
     {
-        bool boolA = intp->values[node->inputPins[2]->valueIndex].boolean;
-        bool boolB = intp->values[node->inputPins[3]->valueIndex].boolean;
-        bool *result = &intp->values[node->outputPins[1]->valueIndex].boolean;
-        switch (node->inputPins[1]->pickedOption)
+        ContactList *found = &contacts->found[w];
+        outOfMemory = outOfMemory || found->outOfMemory;
+        for (int i = 0; i < found->count; i++)
         {
-        case AND:
-            *result = boolA && boolB;
-            break;
-        case OR:
-            *result = boolA || boolB;
-            break;
-        case NOT:
-            *result = !boolA;
-            break;
-        case XOR:
-            *result = boolA != boolB;
-            break;
-        case NAND:
-            *result = !(boolA && boolB);
-            break;
-        case NOR:
-            *result = !(boolA || boolB);
-            break;
-        default:
-            break;
+            PushContact(&touching, found->pairs[i].a, found->pairs[i].b, CONTACT_BEGIN);
         }
-        break;
     }
+    if (touching.count > 1)
+        qsort(touching.pairs, touching.count, sizeof(ContactPair), CompareContactPairs);
 
-    case NODE_ARITHMETIC:
+    int p = 0;
+    for (int i = 0; i < touching.count; i++)
     {
-        float numA = intp->values[node->inputPins[2]->valueIndex].number;
-        float numB = intp->values[node->inputPins[3]->valueIndex].number;
-        float *result = &intp->values[node->outputPins[1]->valueIndex].number;
-        switch (node->inputPins[1]->pickedOption)
+        ContactPair *pair = &touching.pairs[i];
+        while (p < previous.count && CompareContactPairs(&previous.pairs[p], pair) < 0)
         {
-        case ADD:
-            *result = numA + numB;
-            break;
-        case SUBTRACT:
-            *result = numA - numB;
-            break;
-        case MULTIPLY:
-            *result = numA * numB;
-            break;
-        case DIVIDE:
-            *result = numA / numB;
-            break;
-        case MODULO:
-            *result = (int)numA % (int)numB;
-            break;
-        default:
-            break;
+            PushContact(&contacts->ended, previous.pairs[p].a, previous.pairs[p].b, CONTACT_END);
+            p++;
         }
-        break;
+        if (p < previous.count && CompareContactPairs(&previous.pairs[p], pair) == 0)
+        {
+            pair->state = CONTACT_STAY;
+            p++;
+        }
+    }
+    for (; p < previous.count; p++)
+    {
+        PushContact(&contacts->ended, previous.pairs[p].a, previous.pairs[p].b, CONTACT_END);
     }
 
-    case NODE_PRINT_TO_LOG:
+    contacts->touching = touching;
+    contacts->previous = previous;
+    return !outOfMemory && !touching.outOfMemory && !contacts->ended.outOfMemory;
+}
+
+// Integrates the bodies, moves every sprite that got a step and takes the step back when it ran into a blocking component.
+// Each phase runs across the physics workers and only writes data of its own components, and every sprite is checked
+// against where the others moved to, so the outcome is the same for any worker count.
+// Contacts are collected before blocked sprites step back, so running into a wall counts as touching it
+void HandleRigidBodies(InterpreterContext *intp)
+{
+    RigidBodies *bodies = &intp->bodies;
+    int count = intp->componentCount;
+    bool hasContactEvents = intp->contacts.beginHandlerCount + intp->contacts.endHandlerCount > 0;
+
+    PreparePhysicsPool(intp);
+
+    RunPhysicsJob(intp, IntegrateBodiesJob, count);
+
+    bool isAnyMoving = false;
+    for (int i = 0; i < count && !isAnyMoving; i++)
+    {
+        isAnyMoving = bodies->stepX[i] != 0 || bodies->stepY[i] != 0;
+    }
+    if (!isAnyMoving && !hasContactEvents)
+        return;
+
+    RunPhysicsJob(intp, MoveBodiesJob, count);
+
+    // Broadphase: flow nodes and this step moved sprites, the grid is re-binned on the game thread
+    if (intp->collisionGrid.proxies)
     {
-        if (node->inputPins[1]->valueIndex != -1)
+        FlushMovedSprites(intp);
+        for (int j = 0; j < count; j++)
         {
-            AddToLogFromInterpreter(intp, intp->values[node->inputPins[1]->valueIndex], LOG_LEVEL_DEBUG);
+            if (intp->components[j].isSprite)
+                UpdateCollisionProxy(intp, j);
         }
-        break;
     }
 
-    case NODE_DRAW_DEBUG_LINE:
+    RunPhysicsJob(intp, CheckBodiesJob, count);
+
+    // A swept body stopped before a blocker it would have passed through is put where it touches it, so contacts see the hit
+    for (int i = 0; i < count; i++)
     {
-        DrawLine(
-            intp->values[node->inputPins[1]->valueIndex].number,
-            intp->values[node->inputPins[2]->valueIndex].number,
-            intp->values[node->inputPins[3]->valueIndex].number,
-            intp->values[node->inputPins[4]->valueIndex].number,
-            intp->values[node->inputPins[5]->valueIndex].color);
-        break;
+        if (!hasContactEvents || !bodies->isBlocked[i] || bodies->touchTime[i] >= 1)
+            continue;
+
+        intp->components[i].sprite.position = (Vector2){bodies->previousX[i] + bodies->stepX[i] * bodies->touchTime[i], bodies->previousY[i] + bodies->stepY[i] * bodies->touchTime[i]};
+        GetCollisionShape(intp, i);
+        if (intp->collisionGrid.proxies)
+            UpdateCollisionProxy(intp, i);
     }
+
+    if (hasContactEvents && !FindContacts(intp))
+    {
+        FreeContactCache(&intp->contacts);
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: collision contacts, On Collision events are off{I108}"}, LOG_LEVEL_WARNING);
     }
 
-    if (currNodeIndex != lastNodeIndex)
+    // Merged in component order
+    for (int i = 0; i < count; i++)
     {
-        InterpretStringOfNodes(currNodeIndex, intp, graph, 0);
+        if (!bodies->isBlocked[i])
+            continue;
+
+        intp->components[i].sprite.position = (Vector2){bodies->previousX[i] + bodies->stepX[i] * bodies->impactTime[i], bodies->previousY[i] + bodies->stepY[i] * bodies->impactTime[i]};
+        bodies->velocityX[i] = 0;
+        bodies->velocityY[i] = 0;
+        if (intp->collisionGrid.proxies)
+            UpdateCollisionProxy(intp, i);
     }
 }
 
-void DrawHitbox(Hitbox *h, Vector2 centerPos, Vector2 spriteSize, Vector2 texSize, Color color)
+// Slides Move To sprites, ends the forces that ran out and wakes every flow whose wait is over, in the order they were parked.
+// Only the wheel slots the clock advanced over are visited, pending delays further out cost nothing
+static void UpdateLatentFlows(InterpreterContext *intp, RuntimeGraphContext *graph)
 {
-    float scaleX = spriteSize.x / texSize.x;
-    float scaleY = spriteSize.y / texSize.y;
+    LatentScheduler *latent = &intp->latent;
+    latent->time += GetFrameTime();
 
-    switch (h->type)
-    {
-    case HITBOX_RECT:
+    if (latent->pendingCount == 0)
     {
-        Rectangle r = {
-            centerPos.x + h->offset.x * scaleX,
-            centerPos.y + h->offset.y * scaleY,
-            h->rectHitboxSize.x * scaleX,
-            h->rectHitboxSize.y * scaleY};
-        DrawRectangleLinesEx(r, 1, color);
+        latent->currentTick = llround(latent->time * LATENT_TICKS_PER_SECOND);
+        return;
     }
-    break;
 
-    case HITBOX_CIRCLE:
+    LatentWait *due = NULL;
+    LatentWait *dueTail = NULL;
+
+    LatentWait *mover = latent->movers;
+    latent->movers = NULL;
+    latent->moversTail = NULL;
+    while (mover)
     {
-        Vector2 c = {
-            centerPos.x + h->offset.x * scaleX,
-            centerPos.y + h->offset.y * scaleY};
-        DrawCircleLines((int)c.x, (int)c.y, h->circleHitboxRadius * ((scaleX + scaleY) / 2), color);
+        LatentWait *next = mover->next;
+        float t = (latent->time - mover->startTime) / mover->duration;
+        if (t > 1)
+            t = 1;
+
+        if (mover->componentIndex >= 0 && mover->componentIndex < intp->componentCount)
+        {
+            intp->components[mover->componentIndex].sprite.position = Vector2Lerp(mover->start, mover->target, t);
+            MarkSpriteMoved(intp, mover->componentIndex);
+        }
+
+        if (t >= 1)
+            AppendLatentWait(&due, &dueTail, mover);
+        else
+            AppendLatentWait(&latent->movers, &latent->moversTail, mover);
+        mover = next;
     }
-    break;
 
-    case HITBOX_POLY:
+    long long nowTick = llround(latent->time * LATENT_TICKS_PER_SECOND);
+    long long steps = nowTick - latent->currentTick;
+    if (steps > LATENT_WHEEL_SLOTS)
+        steps = LATENT_WHEEL_SLOTS;
+
+    for (long long tick = latent->currentTick + 1; tick <= latent->currentTick + steps; tick++)
     {
-        for (int i = 0; i < h->polygonHitbox.count; i++)
+        int slot = tick & (LATENT_WHEEL_SLOTS - 1);
+        LatentWait *wait = latent->wheel[slot];
+        latent->wheel[slot] = NULL;
+        latent->wheelTail[slot] = NULL;
+
+        while (wait)
         {
-            Vector2 p1 = {
-                centerPos.x + h->offset.x * scaleX + h->polygonHitbox.vertices[i].x * scaleX,
-                centerPos.y + h->offset.y * scaleY + h->polygonHitbox.vertices[i].y * scaleY};
-            Vector2 p2 = {
-                centerPos.x + h->offset.x * scaleX + h->polygonHitbox.vertices[(i + 1) % h->polygonHitbox.count].x * scaleX,
-                centerPos.y + h->offset.y * scaleY + h->polygonHitbox.vertices[(i + 1) % h->polygonHitbox.count].y * scaleY};
-            DrawLineV(p1, p2, color);
+            LatentWait *next = wait->next;
+            // Forces run out before any flow resumes, so a resumed flow can start the same Force node again
+            if (wait->dueTick <= nowTick && wait->kind == LATENT_FORCE)
+                EndForce(intp, wait);
+            else if (wait->dueTick <= nowTick)
+                AppendLatentWait(&due, &dueTail, wait);
+            else
+                AppendLatentWait(&latent->wheel[slot], &latent->wheelTail[slot], wait);
+            wait = next;
         }
     }
-    break;
+    if (nowTick > latent->currentTick)
+        latent->currentTick = nowTick;
 
-    default:
-        break;
+    while (due)
+    {
+        LatentWait *next = due->next;
+        int resumePc = due->resumePc;
+        ReleaseLatentWait(latent, due);
+        ExecuteBytecode(intp, graph, resumePc);
+        due = next;
     }
 }
 
-void DrawComponents(InterpreterContext *intp)
+// Events exported through the transpiler run as native functions, everything else goes through the bytecode
+void RunEvent(InterpreterContext *intp, RuntimeGraphContext *graph, int nodeIndex)
 {
-    ClearBackground(intp->backgroundColor);
-
-    /*if(IsKeyPressed(KEY_M)){
-        intp->cameraOffset.x += 100;
-    }
-    if(IsKeyPressed(KEY_N)){
-        intp->cameraOffset.x -= 100;
+    if (graph->compiledEvents && graph->compiledEvents[nodeIndex])
+    {
+        graph->compiledEvents[nodeIndex](intp);
+        return;
     }
 
-    if(IsKeyPressed(KEY_G)){
-        intp->cameraOffset.y -= 100;
+    ExecuteBytecode(intp, graph, graph->entryPoints[nodeIndex]);
+}
+
+static int CompareNodeIndexes(const void *left, const void *right)
+{
+    return CompareInt(*(const int *)left, *(const int *)right);
+}
+
+static bool BuildKeyDispatchTable(InterpreterContext *intp, RuntimeGraphContext *graph)
+{
+    KeyDispatchTable *table = &intp->keyHandlers;
+    int bucketCount = MAX_KEY_CODES * KEY_ACTION_COUNT;
+
+    table->start = ArenaAlloc(&intp->arena, sizeof(int) * (bucketCount + 1));
+    table->nodes = ArenaAlloc(&intp->arena, sizeof(int) * (graph->nodeCount + 1));
+    table->triggered = ArenaAlloc(&intp->arena, sizeof(int) * (graph->nodeCount + 1));
+    table->notDownKeys = ArenaAlloc(&intp->arena, sizeof(int) * MAX_KEY_CODES);
+    int *filled = calloc(bucketCount, sizeof(int));
+    if (!table->start || !table->nodes || !table->triggered || !table->notDownKeys || !filled)
+    {
+        free(filled);
+        *table = (KeyDispatchTable){0};
+        return false;
     }
-    if(IsKeyPressed(KEY_B)){
-        intp->cameraOffset.y += 100;
-    }*/
 
-    for (int i = 0; i < intp->componentCount; i++)
+    // Counting sort by bucket keeps graph order inside every bucket
+    for (int pass = 0; pass < 2; pass++)
     {
-        SceneComponent component = intp->components[i];
-        if (!component.isVisible)
-        {
-            continue;
-        }
-        if (component.isSprite)
+        for (int i = 0; i < graph->nodeCount; i++)
         {
-            DrawTexturePro(
-                component.sprite.texture,
-                (Rectangle){0, 0, (float)component.sprite.texture.width, (float)component.sprite.texture.height},
-                (Rectangle){
-                    component.sprite.position.x + intp->cameraOffset.x,
-                    component.sprite.position.y + intp->cameraOffset.y,
-                    (float)component.sprite.width,
-                    (float)component.sprite.height},
-                (Vector2){component.sprite.width / 2.0f, component.sprite.height / 2.0f},
-                component.sprite.rotation,
-                WHITE);
-            if (intp->shouldShowHitboxes)
-            {
-                DrawHitbox(
-                    &component.sprite.hitbox,
-                    Vector2Add(component.sprite.position, intp->cameraOffset),
-                    (Vector2){component.sprite.width, component.sprite.height},
-                    (Vector2){component.sprite.texture.width, component.sprite.texture.height},
-                    RED);
-            }
-            continue;
+            if (graph->nodes[i].type != NODE_EVENT_ON_BUTTON)
+                continue;
+
+            RuntimePin *keyPin = RuntimeInputPin(graph, &graph->nodes[i], 0);
+            RuntimePin *actionPin = RuntimeInputPin(graph, &graph->nodes[i], 1);
+            if (!keyPin || !actionPin || keyPin->pickedOption < 0 || keyPin->pickedOption >= MAX_KEY_CODES || actionPin->pickedOption < 0 || actionPin->pickedOption >= KEY_ACTION_COUNT)
+                continue;
+
+            int bucket = keyPin->pickedOption * KEY_ACTION_COUNT + actionPin->pickedOption;
+            if (pass == 0)
+                table->start[bucket + 1]++;
+            else
+                table->nodes[table->start[bucket] + filled[bucket]++] = i;
         }
-        else
+
+        if (pass == 0)
         {
-            switch (component.prop.propType)
-            {
-            case PROP_TEXTURE:
-                break; //
-            case PROP_RECTANGLE:
-                DrawRectangle(component.prop.position.x + intp->cameraOffset.x, component.prop.position.y + intp->cameraOffset.y, component.prop.width, component.prop.height, component.prop.color);
-                break;
-            case PROP_CIRCLE:
-                DrawCircle(component.prop.position.x + intp->cameraOffset.x, component.prop.position.y + intp->cameraOffset.y, component.prop.width / 2, component.prop.color);
-                break;
-            default:
-                AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of bounds enum{O201}"}, LOG_LEVEL_ERROR);
-            }
-            if (intp->shouldShowHitboxes)
+            for (int bucket = 0; bucket < bucketCount; bucket++)
             {
-                DrawHitbox(
-                    &component.prop.hitbox,
-                    Vector2Add(component.prop.position, intp->cameraOffset),
-                    (Vector2){component.prop.width, component.prop.height},
-                    (Vector2){component.prop.width, component.prop.height},
-                    RED);
+                table->start[bucket + 1] += table->start[bucket];
             }
+            table->count = table->start[bucketCount];
         }
     }
-}
-
-bool CheckCollisionPolyPoly(Polygon *a, Vector2 aPos, Vector2 aSize, Vector2 aTexSize, Polygon *b, Vector2 bPos, Vector2 bSize, Vector2 bTexSize)
-{
-    float scaleAX = aSize.x / aTexSize.x;
-    float scaleAY = aSize.y / aTexSize.y;
-    float scaleBX = bSize.x / bTexSize.x;
-    float scaleBY = bSize.y / bTexSize.y;
+    free(filled);
 
-    for (int i = 0; i < a->count; i++)
+    for (int key = 0; key < MAX_KEY_CODES; key++)
     {
-        Vector2 a1 = {aPos.x + a->vertices[i].x * scaleAX,
-                      aPos.y + a->vertices[i].y * scaleAY};
-        Vector2 a2 = {aPos.x + a->vertices[(i + 1) % a->count].x * scaleAX,
-                      aPos.y + a->vertices[(i + 1) % a->count].y * scaleAY};
+        int bucket = key * KEY_ACTION_COUNT;
+        if (table->start[bucket + KEY_ACTION_NOT_DOWN + 1] > table->start[bucket + KEY_ACTION_NOT_DOWN])
+            table->notDownKeys[table->notDownKeyCount++] = key;
 
-        for (int j = 0; j < b->count; j++)
+        // Keys already held when the game starts never come through the key queue
+        bool hasHandlers = table->start[bucket + KEY_ACTION_COUNT] > table->start[bucket];
+        if (key != KEY_NULL && hasHandlers && IsKeyDown(key) && !IsKeyPressed(key))
         {
-            Vector2 b1 = {bPos.x + b->vertices[j].x * scaleBX,
-                          bPos.y + b->vertices[j].y * scaleBY};
-            Vector2 b2 = {bPos.x + b->vertices[(j + 1) % b->count].x * scaleBX,
-                          bPos.y + b->vertices[(j + 1) % b->count].y * scaleBY};
-
-            if (CheckCollisionLines(a1, a2, b1, b2, NULL))
-            {
-                return true;
-            }
+            table->isHeld[key] = true;
+            table->heldKeys[table->heldCount++] = key;
         }
     }
-    return false;
+
+    return true;
 }
 
-bool CheckCollisionPolyCircle(Hitbox *h, Vector2 centerPos, Vector2 spriteSize, Vector2 texSize,
-                              Vector2 circlePos, float circleRadius)
+static void QueueKeyHandlers(KeyDispatchTable *table, int key, KeyAction action, int *triggeredCount)
 {
-    float scaleX = spriteSize.x / texSize.x;
-    float scaleY = spriteSize.y / texSize.y;
+    int bucket = key * KEY_ACTION_COUNT + action;
+    for (int i = table->start[bucket]; i < table->start[bucket + 1]; i++)
+    {
+        table->triggered[(*triggeredCount)++] = table->nodes[i];
+    }
+}
 
-    Vector2 transformed[64];
-    for (int i = 0; i < h->polygonHitbox.count; i++)
+// Presses come from raylib's key queue and releases are only checked for held keys, so a frame where nothing
+// changed costs one pass over the held keys and the Not Down keys. Triggered handlers run in graph order
+static void DispatchKeyEvents(InterpreterContext *intp, RuntimeGraphContext *graph)
+{
+    KeyDispatchTable *table = &intp->keyHandlers;
+    int triggeredCount = 0;
+
+    for (int i = 0; i < table->heldCount;)
     {
-        transformed[i].x = centerPos.x + h->offset.x * scaleX + h->polygonHitbox.vertices[i].x * scaleX;
-        transformed[i].y = centerPos.y + h->offset.y * scaleY + h->polygonHitbox.vertices[i].y * scaleY;
+        int key = table->heldKeys[i];
+        if (IsKeyDown(key))
+        {
+            i++;
+            continue;
+        }
+
+        table->isHeld[key] = false;
+        table->heldKeys[i] = table->heldKeys[--table->heldCount];
+        QueueKeyHandlers(table, key, KEY_ACTION_RELEASED, &triggeredCount);
     }
 
-    if (CheckCollisionPointPoly(circlePos, transformed, h->polygonHitbox.count)){
-        return true;
+    for (int key = GetKeyPressed(); key != KEY_NULL; key = GetKeyPressed())
+    {
+        if (key < 0 || key >= MAX_KEY_CODES || table->isHeld[key])
+            continue;
+
+        table->isHeld[key] = true;
+        table->heldKeys[table->heldCount++] = key;
+        QueueKeyHandlers(table, key, KEY_ACTION_PRESSED, &triggeredCount);
     }
 
-    for (int i = 0; i < h->polygonHitbox.count; i++)
+    if (table->count == 0)
+        return;
+
+    for (int i = 0; i < table->heldCount; i++)
     {
-        if (CheckCollisionPointCircle(transformed[i], circlePos, circleRadius)){
-            return true;
-        }
+        QueueKeyHandlers(table, table->heldKeys[i], KEY_ACTION_DOWN, &triggeredCount);
     }
 
-    for (int i = 0; i < h->polygonHitbox.count; i++)
+    for (int i = 0; i < table->notDownKeyCount; i++)
     {
-        Vector2 a = transformed[i];
-        Vector2 b = transformed[(i + 1) % h->polygonHitbox.count];
-        if (CheckCollisionCircleLine(circlePos, circleRadius, a, b)){
-            return true;
-        }
+        if (!table->isHeld[table->notDownKeys[i]])
+            QueueKeyHandlers(table, table->notDownKeys[i], KEY_ACTION_NOT_DOWN, &triggeredCount);
     }
 
-    return false;
+    qsort(table->triggered, triggeredCount, sizeof(int), CompareNodeIndexes);
+    for (int i = 0; i < triggeredCount; i++)
+    {
+        RunEvent(intp, graph, table->triggered[i]);
+    }
 }
 
-bool CheckCollisionPolyRect(Polygon *poly, Vector2 polyPos, Vector2 polySize, Vector2 polyTexSize,
-                            Vector2 rectPos, Vector2 rectSize)
+// A pin left on NONE matches any component, a picked sprite only the component its variable holds right now
+static bool DoesContactFilterMatch(InterpreterContext *intp, RuntimeGraphContext *graph, int nodeIndex, int pinIndex, int componentIndex)
 {
-    float scaleX = polySize.x / polyTexSize.x;
-    float scaleY = polySize.y / polyTexSize.y;
-    Rectangle rect = {rectPos.x, rectPos.y, rectSize.x, rectSize.y};
+    RuntimePin *pin = RuntimeInputPin(graph, &graph->nodes[nodeIndex], pinIndex);
+    if (!pin || pin->pickedOption == 0)
+        return true;
 
-    for (int i = 0; i < poly->count; i++)
+    return pin->valueIndex >= 0 && intp->values.componentIndexes[pin->valueIndex] == componentIndex;
+}
+
+static void RunContactHandlers(InterpreterContext *intp, RuntimeGraphContext *graph, const int *handlers, int handlerCount, ContactPair pair)
+{
+    for (int h = 0; h < handlerCount; h++)
     {
-        Vector2 p = {
-            polyPos.x + poly->vertices[i].x * scaleX,
-            polyPos.y + poly->vertices[i].y * scaleY};
-        if (CheckCollisionPointRec(p, rect))
-            return true;
+        int nodeIndex = handlers[h];
+        bool isMatch = (DoesContactFilterMatch(intp, graph, nodeIndex, 0, pair.a) && DoesContactFilterMatch(intp, graph, nodeIndex, 1, pair.b)) ||
+                       (DoesContactFilterMatch(intp, graph, nodeIndex, 0, pair.b) && DoesContactFilterMatch(intp, graph, nodeIndex, 1, pair.a));
+        if (isMatch)
+            RunEvent(intp, graph, nodeIndex);
     }
+}
 
-    Vector2 corners[4] = {
-        {rect.x, rect.y},
-        {rect.x + rect.width, rect.y},
-        {rect.x + rect.width, rect.y + rect.height},
-        {rect.x, rect.y + rect.height}};
+// Runs the On Collision nodes for the contacts the physics step found, ended pairs first, each in pair order and then graph order
+static void DispatchContactEvents(InterpreterContext *intp, RuntimeGraphContext *graph)
+{
+    ContactCache *contacts = &intp->contacts;
 
-    Vector2 transformed[64];
-    for (int i = 0; i < poly->count; i++)
+    for (int i = 0; i < contacts->ended.count && contacts->endHandlerCount > 0; i++)
     {
-        transformed[i].x = polyPos.x + poly->vertices[i].x * scaleX;
-        transformed[i].y = polyPos.y + poly->vertices[i].y * scaleY;
+        RunContactHandlers(intp, graph, contacts->endHandlers, contacts->endHandlerCount, contacts->ended.pairs[i]);
     }
+    contacts->ended.count = 0;
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < contacts->touching.count && contacts->beginHandlerCount > 0; i++)
     {
-        if (CheckCollisionPointPoly(corners[i], transformed, poly->count))
-            return true;
+        if (contacts->touching.pairs[i].state != CONTACT_BEGIN)
+            continue;
+        RunContactHandlers(intp, graph, contacts->beginHandlers, contacts->beginHandlerCount, contacts->touching.pairs[i]);
+        contacts->touching.pairs[i].state = CONTACT_STAY;
     }
+}
+
+static bool BuildContactHandlers(InterpreterContext *intp, RuntimeGraphContext *graph)
+{
+    ContactCache *contacts = &intp->contacts;
+    contacts->beginHandlerCount = 0;
+    contacts->endHandlerCount = 0;
 
-    for (int i = 0; i < poly->count; i++)
+    int beginCount = 0;
+    int endCount = 0;
+    for (int i = 0; i < graph->nodeCount; i++)
     {
-        Vector2 a = transformed[i];
-        Vector2 b = transformed[(i + 1) % poly->count];
+        beginCount += graph->nodes[i].type == NODE_EVENT_ON_COLLISION_BEGIN;
+        endCount += graph->nodes[i].type == NODE_EVENT_ON_COLLISION_END;
+    }
+    if (beginCount == 0 && endCount == 0)
+        return true;
+
+    contacts->beginHandlers = ArenaAlloc(&intp->arena, sizeof(int) * beginCount);
+    contacts->endHandlers = ArenaAlloc(&intp->arena, sizeof(int) * endCount);
+    if (!contacts->beginHandlers || !contacts->endHandlers)
+        return false;
 
-        Vector2 r[4][2] = {
-            {{rect.x, rect.y}, {rect.x + rect.width, rect.y}},
-            {{rect.x + rect.width, rect.y}, {rect.x + rect.width, rect.y + rect.height}},
-            {{rect.x + rect.width, rect.y + rect.height}, {rect.x, rect.y + rect.height}},
-            {{rect.x, rect.y + rect.height}, {rect.x, rect.y}}};
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        if (graph->nodes[i].type == NODE_EVENT_ON_COLLISION_BEGIN)
+            contacts->beginHandlers[contacts->beginHandlerCount++] = i;
+        else if (graph->nodes[i].type == NODE_EVENT_ON_COLLISION_END)
+            contacts->endHandlers[contacts->endHandlerCount++] = i;
+    }
+    return true;
+}
 
-        for (int j = 0; j < 4; j++)
+// Start events only run on a fresh run, a hot patch just picks up the new tick, On Button and On Collision nodes
+static void CollectEventNodes(InterpreterContext *intp, RuntimeGraphContext *graph, bool runStartEvents)
+{
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        switch (graph->nodes[i].type)
         {
-            if (CheckCollisionLines(a, b, r[j][0], r[j][1], NULL))
-                return true;
+        case NODE_EVENT_START:
+            if (runStartEvents)
+                RunEvent(intp, graph, i);
+            break;
+        case NODE_EVENT_TICK:
+            if (intp->loopNodeIndex == -1)
+            {
+                intp->loopNodeIndex = i;
+            }
+            break;
+        default:
+            break;
         }
     }
 
-    return false;
+    if (!BuildKeyDispatchTable(intp, graph))
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: key handlers{I214}"}, LOG_LEVEL_ERROR);
+    }
+
+    if (!BuildContactHandlers(intp, graph))
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: collision handlers{I217}"}, LOG_LEVEL_ERROR);
+    }
+
+    if (!InitCollisionGrid(intp))
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: collision grid, falling back to checking every component{I106}"}, LOG_LEVEL_WARNING);
+    }
 }
 
-CollisionResult CheckCollisions(InterpreterContext *intp, int index)
+bool HandleGameScreen(InterpreterContext *intp, RuntimeGraphContext *graph, Vector2 mousePos, Rectangle screenBoundary)
 {
-    if (index < 0 || index >= intp->componentCount)
-        return false;
+    if (intp->isPaused)
+    {
+        DrawComponents(intp);
+        DrawRectangleRec(screenBoundary, (Color){80, 80, 80, 50});
+        return true;
+    }
 
-    SceneComponent *a = &intp->components[index];
-    int layerA = a->isSprite ? a->sprite.layer : a->prop.layer;
+    UpdateSpecialValues(intp, mousePos, screenBoundary);
 
-    Hitbox *hitA = a->isSprite ? &a->sprite.hitbox : &a->prop.hitbox;
-    Vector2 posA = a->isSprite ? a->sprite.position : a->prop.position;
-    Vector2 sizeA = a->isSprite ? (Vector2){a->sprite.width, a->sprite.height} : (Vector2){a->prop.width, a->prop.height};
-    Vector2 texA = a->isSprite ? (Vector2){a->sprite.texture.width, a->sprite.texture.height} : (Vector2){a->prop.texture.width, a->prop.texture.height};
+    // Debug lines from the last frame stay on screen while the game is paused
+    intp->debugLines.count = 0;
 
-    for (int j = 0; j < intp->componentCount; j++)
+    if (intp->isFirstFrame)
     {
-        if (j == index)
-            continue;
+        CollectEventNodes(intp, graph, true);
 
-        SceneComponent *b = &intp->components[j];
-        int layerB = b->isSprite ? b->sprite.layer : b->prop.layer;
+        intp->isFirstFrame = false;
+    }
+    else
+    {
+        intp->newLogMessage = false;
+    }
 
-        bool aBlocks = (layerA == COMPONENT_LAYER_BLOCKING || layerA == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
-        bool aEvents = (layerA == COMPONENT_LAYER_COLLISION_EVENTS || layerA == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
+    DispatchKeyEvents(intp, graph);
 
-        bool bBlocks = (layerB == COMPONENT_LAYER_BLOCKING || layerB == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
-        bool bEvents = (layerB == COMPONENT_LAYER_COLLISION_EVENTS || layerB == COMPONENT_LAYER_COLLISION_EVENTS_AND_BLOCKING);
+    if (intp->loopNodeIndex == -1)
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "No loop node found{I211}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
+    else
+    {
+        RunEvent(intp, graph, intp->loopNodeIndex);
+    }
 
-        if (!aBlocks && !aEvents && !bBlocks && !bEvents)
-        {
-            continue;
-        }
+    UpdateLatentFlows(intp, graph);
 
-        Hitbox *hitB = b->isSprite ? &b->sprite.hitbox : &b->prop.hitbox;
-        Vector2 posB = b->isSprite ? b->sprite.position : b->prop.position;
-        Vector2 sizeB = b->isSprite ? (Vector2){b->sprite.width, b->sprite.height} : (Vector2){b->prop.width, b->prop.height};
-        Vector2 texB = b->isSprite ? (Vector2){b->sprite.texture.width, b->sprite.texture.height} : (Vector2){b->prop.texture.width, b->prop.texture.height};
+    HandleRigidBodies(intp);
 
-        bool collided = false;
+    DispatchContactEvents(intp, graph);
 
-        if (hitA->type == HITBOX_RECT && hitB->type == HITBOX_RECT)
-        {
-            Rectangle rA = {posA.x + hitA->offset.x, posA.y + hitA->offset.y,
-                            hitA->rectHitboxSize.x * (sizeA.x / texA.x),
-                            hitA->rectHitboxSize.y * (sizeA.y / texA.y)};
-            Rectangle rB = {posB.x + hitB->offset.x, posB.y + hitB->offset.y,
-                            hitB->rectHitboxSize.x * (sizeB.x / texB.x),
-                            hitB->rectHitboxSize.y * (sizeB.y / texB.y)};
-            collided = CheckCollisionRecs(rA, rB);
-        }
-        else if (hitA->type == HITBOX_CIRCLE && hitB->type == HITBOX_CIRCLE)
-        {
-            Vector2 cA = {posA.x + hitA->offset.x * (sizeA.x / texA.x),
-                          posA.y + hitA->offset.y * (sizeA.y / texA.y)};
-            Vector2 cB = {posB.x + hitB->offset.x * (sizeB.x / texB.x),
-                          posB.y + hitB->offset.y * (sizeB.y / texB.y)};
-            collided = CheckCollisionCircles(cA, hitA->circleHitboxRadius * ((sizeA.x / texA.x + sizeA.y / texA.y) / 2),
-                                             cB, hitB->circleHitboxRadius * ((sizeB.x / texB.x + sizeB.y / texB.y) / 2));
-        }
-        else if (hitA->type == HITBOX_POLY && hitB->type == HITBOX_POLY)
-        {
-            collided = CheckCollisionPolyPoly(&hitA->polygonHitbox, posA, sizeA, texA,
-                                              &hitB->polygonHitbox, posB, sizeB, texB);
-        }
-        else if (hitA->type == HITBOX_RECT && hitB->type == HITBOX_CIRCLE)
-        {
-            Rectangle rA = {posA.x + hitA->offset.x, posA.y + hitA->offset.y,
-                            hitA->rectHitboxSize.x * (sizeA.x / texA.x),
-                            hitA->rectHitboxSize.y * (sizeA.y / texA.y)};
-            Vector2 cB = {posB.x + hitB->offset.x * (sizeB.x / texB.x),
-                          posB.y + hitB->offset.y * (sizeB.y / texB.y)};
-            collided = CheckCollisionCircleRec(cB,
-                                               hitB->circleHitboxRadius * ((sizeB.x / texB.x + sizeB.y / texB.y) / 2), rA);
-        }
-        else if (hitA->type == HITBOX_CIRCLE && hitB->type == HITBOX_RECT)
-        {
-            Rectangle rB = {posB.x + hitB->offset.x, posB.y + hitB->offset.y,
-                            hitB->rectHitboxSize.x * (sizeB.x / texB.x),
-                            hitB->rectHitboxSize.y * (sizeB.y / texB.y)};
-            Vector2 cA = {posA.x + hitA->offset.x * (sizeA.x / texA.x),
-                          posA.y + hitA->offset.y * (sizeA.y / texA.y)};
-            collided = CheckCollisionCircleRec(cA,
-                                               hitA->circleHitboxRadius * ((sizeA.x / texA.x + sizeA.y / texA.y) / 2), rB);
-        }
-        else if (hitA->type == HITBOX_POLY && hitB->type == HITBOX_CIRCLE)
-        {
-            float scaleX = texB.x != 0 ? sizeB.x / texB.x : 1.0f;
-            float scaleY = texB.y != 0 ? sizeB.y / texB.y : 1.0f;
+    UpdateGameCamera(intp);
 
-            Vector2 cB = {
-                posB.x + hitB->offset.x * scaleX,
-                posB.y + hitB->offset.y * scaleY};
+    DrawComponents(intp);
 
-            collided = CheckCollisionPolyCircle(hitA, posA, sizeA, texA, cB, hitB->circleHitboxRadius * ((scaleX + scaleY) / 2));
-        }
-        else if (hitA->type == HITBOX_CIRCLE && hitB->type == HITBOX_POLY)
-        {
-            float scaleX = sizeA.x / texA.x;
-            float scaleY = sizeA.y / texA.y;
+    return true;
+}
 
-            Vector2 cA = {
-                posA.x + hitA->offset.x * scaleX,
-                posA.y + hitA->offset.y * scaleY};
+// Pending waits and running forces follow their node into the patched bytecode, the ones on removed or retyped nodes are dropped
+static void CarryLatentWaits(InterpreterContext *from, InterpreterContext *to, RuntimeGraphContext *patched, const int *nodeRemap, int nodeCount, const int *componentRemap)
+{
+    if (from->latent.pendingCount == 0)
+        return;
 
-            float radius = hitA->circleHitboxRadius * ((scaleX + scaleY) / 2);
+    int *latentPc = malloc(sizeof(int) * (patched->nodeCount + 1));
+    if (!latentPc)
+        return;
 
-            collided = CheckCollisionPolyCircle(hitB, posB, sizeB, texB, cA, radius);
-        }
-        else if (hitA->type == HITBOX_POLY && hitB->type == HITBOX_RECT)
-        {
-            collided = CheckCollisionPolyRect(&hitA->polygonHitbox, posA, sizeA, texA,
-                                              posB, hitB->rectHitboxSize);
-        }
-        else if (hitA->type == HITBOX_RECT && hitB->type == HITBOX_POLY)
-        {
-            collided = CheckCollisionPolyRect(&hitB->polygonHitbox, posB, sizeB, texB,
-                                              posA, hitA->rectHitboxSize);
-        }
+    for (int i = 0; i < patched->nodeCount; i++)
+    {
+        latentPc[i] = -1;
+    }
+    for (int pc = patched->codeCount - 1; pc >= 0; pc--)
+    {
+        OpCode op = patched->code[pc].op;
+        if (op == OP_DELAY || op == OP_MOVE_TO_SPRITE || op == OP_FORCE_SPRITE)
+            latentPc[patched->code[pc].nodeIndex] = pc;
+    }
 
-        if (collided)
+    to->latent.time = from->latent.time;
+    to->latent.currentTick = from->latent.currentTick;
+
+    for (int slot = 0; slot <= LATENT_WHEEL_SLOTS; slot++)
+    {
+        LatentWait *wait = slot < LATENT_WHEEL_SLOTS ? from->latent.wheel[slot] : from->latent.movers;
+        for (; wait; wait = wait->next)
         {
-            bool triggerEvent = aEvents || bEvents;
-            bool triggerBlock = aBlocks && bBlocks;
+            OpCode op = wait->kind == LATENT_MOVE_TO ? OP_MOVE_TO_SPRITE : wait->kind == LATENT_FORCE ? OP_FORCE_SPRITE : OP_DELAY;
+            int nodeIndex = wait->nodeIndex >= 0 && wait->nodeIndex < nodeCount ? nodeRemap[wait->nodeIndex] : -1;
+            if (nodeIndex == -1 || latentPc[nodeIndex] == -1 || patched->code[latentPc[nodeIndex]].op != op)
+                continue;
+
+            int componentIndex = -1;
+            if (wait->kind != LATENT_DELAY)
+            {
+                if (wait->componentIndex < 0 || wait->componentIndex >= from->componentCount || componentRemap[wait->componentIndex] == -1)
+                    continue;
+                componentIndex = componentRemap[wait->componentIndex];
+            }
+
+            LatentWait *copy = AllocLatentWait(to);
+            if (!copy)
+                break;
+
+            *copy = *wait;
+            copy->nodeIndex = nodeIndex;
+            copy->resumePc = latentPc[nodeIndex] + 1;
+            copy->componentIndex = componentIndex;
+            if (wait->kind == LATENT_MOVE_TO)
+            {
+                AppendLatentWait(&to->latent.movers, &to->latent.moversTail, copy);
+                continue;
+            }
 
-            if (triggerEvent && triggerBlock)
-                return COLLISION_RESULT_EVENT_AND_BLOCKING;
-            if (triggerEvent)
-                return COLLISION_RESULT_EVENT;
-            if (triggerBlock)
-                return COLLISION_RESULT_BLOCKING;
+            if (wait->kind == LATENT_FORCE)
+            {
+                copy->resumePc = -1;
+                to->bodies.pushX[componentIndex] += copy->push.x;
+                to->bodies.pushY[componentIndex] += copy->push.y;
+                to->bodies.pushCount[componentIndex]++;
+                to->bodies.forceByNode[nodeIndex] = copy;
+            }
+            ScheduleDelay(&to->latent, copy);
         }
     }
 
-    return COLLISION_RESULT_NONE;
+    free(latentPc);
 }
 
-void HandleForces(InterpreterContext *intp)
+// Touching pairs follow their components so they do not begin again, pairs with a removed component are dropped
+static void CarryContacts(InterpreterContext *from, InterpreterContext *to, const int *componentRemap)
 {
-    int i = 0;
-    while (i < intp->forcesCount)
+    ContactCache *contacts = &to->contacts;
+    *contacts = from->contacts;
+    from->contacts = (ContactCache){0};
+
+    contacts->beginHandlers = NULL;
+    contacts->beginHandlerCount = 0;
+    contacts->endHandlers = NULL;
+    contacts->endHandlerCount = 0;
+    contacts->ended.count = 0;
+
+    ContactList *touching = &contacts->touching;
+    int kept = 0;
+    for (int i = 0; i < touching->count; i++)
     {
-        Force *f = &intp->forces[i];
-        Vector2 *pos = &intp->components[f->componentIndex].sprite.position;
+        int a = componentRemap[touching->pairs[i].a];
+        int b = componentRemap[touching->pairs[i].b];
+        if (a == -1 || b == -1)
+            continue;
+        touching->pairs[kept++] = (ContactPair){a < b ? a : b, a < b ? b : a, touching->pairs[i].state};
+    }
+    touching->count = kept;
+    if (touching->count > 1)
+        qsort(touching->pairs, touching->count, sizeof(ContactPair), CompareContactPairs);
+}
 
-        float speed = f->pixelsPerSecond;
-        float angle = f->angle * (PI / 180.0f);
-        float vx = cosf(angle) * speed;
-        float vy = -sinf(angle) * speed;
-        float deltaTime = GetFrameTime();
+// Rebuilds the edited graph next to the running one and carries the running state over by node id: variable values,
+// sprite placement, textures and motion, active forces, pending Delay and Move To waits and the settings the game changed.
+// Start events do not run again
+bool HotPatchRuntimeGraph(GraphContext *graph, InterpreterContext *intp, RuntimeGraphContext *runtime)
+{
+    double startTime = GetTime();
 
-        Vector2 prevPos = *pos;
+    if (!runtime->nodeInfos)
+        return false;
 
-        pos->x += vx * deltaTime;
-        pos->y += vy * deltaTime;
+    BuildLookup lookup;
+    if (!InitBuildLookup(&lookup, graph))
+    {
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: build lookup{I213}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
 
-        f->duration -= deltaTime;
+    RuntimeNodeInfo *infos = malloc(sizeof(RuntimeNodeInfo) * (graph->nodeCount + 1));
+    int *nodeRemap = malloc(sizeof(int) * (runtime->nodeCount + 1));
+    int *componentRemap = malloc(sizeof(int) * (intp->componentCount + 1));
+    if (!infos || !nodeRemap || !componentRemap || !InitIdMap(&lookup.previousNodeById, runtime->nodeCount))
+    {
+        free(infos);
+        free(nodeRemap);
+        free(componentRemap);
+        FreeBuildLookup(&lookup);
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Out of memory: build lookup{I213}"}, LOG_LEVEL_ERROR);
+        return false;
+    }
 
-        CollisionResult a = CheckCollisions(intp, f->componentIndex);
-        if (a == COLLISION_RESULT_BLOCKING || a == COLLISION_RESULT_EVENT_AND_BLOCKING)
-        {
-            *pos = prevPos;
-        }
+    for (int i = 0; i < runtime->nodeCount; i++)
+    {
+        IdMapPut(&lookup.previousNodeById, runtime->nodeInfos[i].id, i);
+        nodeRemap[i] = -1;
+    }
+    for (int i = 0; i < intp->componentCount; i++)
+    {
+        componentRemap[i] = -1;
+    }
 
-        if (f->duration <= 0)
-        {
-            for (int j = i; j < intp->forcesCount - 1; j++)
-            {
-                intp->forces[j] = intp->forces[j + 1];
-            }
-            intp->forcesCount--;
-            continue;
-        }
+    ComputeNodeInfos(graph, &lookup, infos);
 
-        i++;
+    int changedNodes = 0;
+    int keptNodes = 0;
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        int previousIndex = IdMapGet(&lookup.previousNodeById, infos[i].id);
+        if (previousIndex == -1 || runtime->nodeInfos[previousIndex].signature != infos[i].signature)
+            changedNodes++;
+        if (previousIndex != -1)
+            keptNodes++;
     }
-}
+    int removedNodes = runtime->nodeCount - keptNodes;
+    free(infos);
 
-bool HandleGameScreen(InterpreterContext *intp, RuntimeGraphContext *graph, Vector2 mousePos, Rectangle screenBoundary)
-{
-    if (intp->isPaused)
+    if (changedNodes == 0 && removedNodes == 0)
     {
-        DrawComponents(intp);
-        DrawRectangleRec(screenBoundary, (Color){80, 80, 80, 50});
+        free(nodeRemap);
+        free(componentRemap);
+        FreeBuildLookup(&lookup);
         return true;
     }
 
-    UpdateSpecialValues(intp, mousePos, screenBoundary);
-
-    if (intp->isFirstFrame)
+    lookup.previous = intp;
+
+    InterpreterContext next = InitInterpreterContext();
+    next.projectPath = intp->projectPath;
+    next.isInfiniteLoopProtectionOn = intp->isInfiniteLoopProtectionOn;
+    next.shouldShowHitboxes = intp->shouldShowHitboxes;
+    next.shouldShowDrawCalls = intp->shouldShowDrawCalls;
+    next.physicsWorkerCount = intp->physicsWorkerCount;
+    next.textureBudgetMB = intp->textureBudgetMB;
+    // Sprites of the patched build find the running build's textures in the cache, which holds on to them until one build lets go
+    next.textureCache = intp->textureCache;
+    intp->textureCache = (TextureCache){0};
+    memcpy(next.logMessages, intp->logMessages, sizeof(intp->logMessages));
+    memcpy(next.logMessageLevels, intp->logMessageLevels, sizeof(intp->logMessageLevels));
+    next.logMessageCount = intp->logMessageCount;
+    next.newLogMessage = intp->newLogMessage;
+
+    RuntimeGraphContext patched = LowerGraph(graph, &next, &lookup);
+    next.runtimeGraph = &patched;
+
+    if (next.buildErrorOccured)
     {
-        intp->onButtonNodeIndexes = malloc(sizeof(int) * graph->nodeCount);
-        for (int i = 0; i < graph->nodeCount; i++)
+        // The atlas and the cache go back to the running build
+        for (int i = 0; i < next.componentCount; i++)
         {
-            switch (graph->nodes[i].type)
-            {
-            case NODE_EVENT_START:
-                InterpretStringOfNodes(i, intp, graph, 0);
-                break;
-            case NODE_EVENT_TICK:
-                if (intp->loopNodeIndex == -1)
-                {
-                    intp->loopNodeIndex = i;
-                }
-                break;
-            case NODE_EVENT_ON_BUTTON:
-                intp->onButtonNodeIndexes[intp->onButtonNodeIndexesCount++] = i;
-                break;
-            }
+            if (next.components[i].isSprite)
+                ReleaseCachedTexture(&next, next.components[i].sprite.cachedTexture);
+        }
+        intp->textureCache = next.textureCache;
+        next.textureCache = (TextureCache){0};
+        if (lookup.isAtlasTaken)
+            next.atlas = (TextureAtlas){0};
+        for (int i = intp->logMessageCount; i < next.logMessageCount; i++)
+        {
+            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = next.logMessages[i]}, next.logMessageLevels[i]);
         }
-        intp->onButtonNodeIndexes = realloc(intp->onButtonNodeIndexes, sizeof(int) * intp->onButtonNodeIndexesCount);
+        FreeInterpreterContext(&next);
+        free(nodeRemap);
+        free(componentRemap);
+        FreeBuildLookup(&lookup);
+        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "Hot patch failed, previous build keeps running{I105}"}, LOG_LEVEL_WARNING);
+        return false;
+    }
 
-        intp->isFirstFrame = false;
+    for (int i = 0; i < patched.nodeCount; i++)
+    {
+        int previousIndex = IdMapGet(&lookup.previousNodeById, patched.nodeInfos[i].id);
+        if (previousIndex != -1)
+            nodeRemap[previousIndex] = i;
     }
-    else
+
+    for (int i = 0; i < runtime->nodeCount; i++)
     {
-        intp->newLogMessage = false;
+        int j = nodeRemap[i];
+        if (j == -1 || runtime->nodes[i].type != patched.nodes[j].type)
+            continue;
+
+        RuntimePin *from = RuntimeOutputPin(runtime, &runtime->nodes[i], 1);
+        RuntimePin *to = RuntimeOutputPin(&patched, &patched.nodes[j], 1);
+        if (!from || !to || from->componentIndex < 0 || from->componentIndex >= intp->componentCount || to->componentIndex < 0 || to->componentIndex >= next.componentCount)
+            continue;
+
+        SceneComponent *fromComponent = &intp->components[from->componentIndex];
+        SceneComponent *toComponent = &next.components[to->componentIndex];
+        componentRemap[from->componentIndex] = to->componentIndex;
+
+        toComponent->isVisible = fromComponent->isVisible;
+        toComponent->collisionGroup = fromComponent->collisionGroup;
+        toComponent->zOrder = fromComponent->zOrder;
+        if (fromComponent->isSprite && toComponent->isSprite)
+        {
+            toComponent->sprite.isVisible = fromComponent->sprite.isVisible;
+            toComponent->sprite.position = fromComponent->sprite.position;
+            toComponent->sprite.rotation = fromComponent->sprite.rotation;
+        }
     }
 
-    for (int i = 0; i < intp->onButtonNodeIndexesCount; i++)
+    for (int i = 0; i < runtime->nodeCount; i++)
     {
-        int nodeIndex = intp->onButtonNodeIndexes[i];
-        KeyboardKey key = graph->nodes[nodeIndex].inputPins[0]->pickedOption;
-        KeyAction action = graph->nodes[nodeIndex].inputPins[1]->pickedOption;
+        int j = nodeRemap[i];
+        if (j == -1 || runtime->nodes[i].type != patched.nodes[j].type)
+            continue;
+
+        RuntimePin *from = RuntimeOutputPin(runtime, &runtime->nodes[i], 1);
+        RuntimePin *to = RuntimeOutputPin(&patched, &patched.nodes[j], 1);
+        if (!from || !to || from->valueIndex < SPECIAL_VALUES_COUNT || from->valueIndex >= intp->valueCount || to->valueIndex < SPECIAL_VALUES_COUNT || to->valueIndex >= next.valueCount)
+            continue;
 
-        bool triggered = false;
-        switch (action)
+        int a = from->valueIndex;
+        int b = to->valueIndex;
+        if (!intp->values.isVariable[a] || !next.values.isVariable[b] || intp->values.types[a] != next.values.types[b])
+            continue;
+
+        switch (next.values.types[b])
         {
-        case KEY_ACTION_PRESSED:
-            triggered = IsKeyPressed(key);
+        case VAL_NUMBER:
+            next.values.numbers[b] = intp->values.numbers[a];
             break;
-        case KEY_ACTION_RELEASED:
-            triggered = IsKeyReleased(key);
+        case VAL_STRING:
+            next.values.strings[b] = ArenaString(&next.arena, intp->values.strings[a] ? intp->values.strings[a] : "null", MAX_LITERAL_NODE_FIELD_SIZE);
             break;
-        case KEY_ACTION_DOWN:
-            triggered = IsKeyDown(key);
+        case VAL_BOOL:
+            next.values.booleans[b] = intp->values.booleans[a];
             break;
-        case KEY_ACTION_NOT_DOWN:
-            triggered = IsKeyUp(key);
+        case VAL_COLOR:
+            next.values.colors[b] = intp->values.colors[a];
             break;
-        }
-
-        if (triggered)
+        case VAL_SPRITE:
         {
-            InterpretStringOfNodes(nodeIndex, intp, graph, 0);
+            int componentIndex = intp->values.componentIndexes[a];
+            if (componentIndex >= 0 && componentIndex < intp->componentCount && componentRemap[componentIndex] != -1)
+                next.values.componentIndexes[b] = componentRemap[componentIndex];
+            break;
+        }
+        default:
+            break;
         }
+        MarkValueWritten(&next.values, b);
     }
 
-    if (intp->loopNodeIndex == -1)
+    for (int i = 0; i < intp->componentCount; i++)
     {
-        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = "No loop node found{I211}"}, LOG_LEVEL_ERROR);
-        return false;
+        int c = componentRemap[i];
+        if (c == -1)
+            continue;
+
+        next.bodies.velocityX[c] = intp->bodies.velocityX[i];
+        next.bodies.velocityY[c] = intp->bodies.velocityY[i];
+        next.bodies.gravity[c] = intp->bodies.gravity[i];
+        next.bodies.damping[c] = intp->bodies.damping[i];
     }
-    else
+
+    CarryLatentWaits(intp, &next, &patched, nodeRemap, runtime->nodeCount, componentRemap);
+    CarryContacts(intp, &next, componentRemap);
+
+    next.backgroundColor = intp->backgroundColor;
+    next.fps = intp->fps;
+    memcpy(next.collisionMasks, intp->collisionMasks, sizeof(next.collisionMasks));
+    next.isPaused = intp->isPaused;
+    next.camera = intp->camera;
+    next.camera.followComponent = intp->camera.followComponent >= 0 && intp->camera.followComponent < intp->componentCount ? componentRemap[intp->camera.followComponent] : -1;
+    next.debugLines = intp->debugLines;
+    intp->debugLines = (DebugLineQueue){0};
+    next.isFirstFrame = intp->isFirstFrame;
+    if (!next.isFirstFrame)
+        CollectEventNodes(&next, &patched, false);
+
+    for (int i = 0; i < intp->componentCount; i++)
     {
-        InterpretStringOfNodes(intp->loopNodeIndex, intp, graph, 0);
+        if (intp->components[i].isSprite)
+            ReleaseCachedTexture(&next, intp->components[i].sprite.cachedTexture);
     }
+    if (lookup.isAtlasTaken)
+        intp->atlas = (TextureAtlas){0};
 
-    HandleForces(intp);
+    // The physics threads keep running for the patched build
+    next.physicsPool = intp->physicsPool;
+    intp->physicsPool = NULL;
 
-    DrawComponents(intp);
+    intp->runtimeGraph = runtime;
+    FreeInterpreterContext(intp);
 
-    for (int i = 0; i < intp->valueCount; i++)
-    {
-        if (intp->values[i].type == VAL_SPRITE)
-        {
-            intp->components[intp->values[i].componentIndex].sprite.isVisible = intp->components[intp->values[i].componentIndex].isVisible;
-            intp->values[i].sprite = intp->components[intp->values[i].componentIndex].sprite;
-        }
-    }
+    *runtime = patched;
+    next.runtimeGraph = runtime;
+    *intp = next;
+
+    char message[MAX_LOG_MESSAGE_SIZE];
+    strmac(message, MAX_LOG_MESSAGE_SIZE, "Hot patched %d changed and %d removed node%s in %.1f ms{I303}", changedNodes, removedNodes, changedNodes + removedNodes == 1 ? "" : "s", (GetTime() - startTime) * 1000.0);
+    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = message}, LOG_LEVEL_NORMAL);
+    LogBuildArenaStats(intp);
+
+    free(nodeRemap);
+    free(componentRemap);
+    FreeBuildLookup(&lookup);
 
     return true;
-}
\ No newline at end of file
+}
@@ -10,9 +10,9 @@
 
 #define MAX_LINKS_PER_PIN 16
 
+// Fields read while building and running, packed per node: inputs first, then outputs
 typedef struct RuntimePin
 {
-    int id;
     PinType type;
     int nodeIndex;
     bool isInput;
@@ -20,29 +20,127 @@ typedef struct RuntimePin
 
     int nextNodeIndex;
     int pickedOption;
-    char textFieldValue[256];
     int componentIndex;
 } RuntimePin;
 
+// Build-only pin data, indexed like RuntimeGraphContext.pins
+typedef struct RuntimePinInfo
+{
+    int id;
+    char textFieldValue[256];
+} RuntimePinInfo;
+
+// Build-only node data, indexed like RuntimeGraphContext.nodes; hot patching diffs against it
+typedef struct RuntimeNodeInfo
+{
+    int id;
+    // Hash of the node's type, name, pin settings and incoming links
+    unsigned int signature;
+} RuntimeNodeInfo;
+
 typedef struct RuntimeNode
 {
     int index;
     NodeType type;
 
-    RuntimePin *inputPins[MAX_NODE_PINS];
+    int firstPin;
     int inputCount;
-
-    RuntimePin *outputPins[MAX_NODE_PINS];
     int outputCount;
 } RuntimeNode;
 
+typedef enum
+{
+    OP_NOP,
+    OP_END,
+    OP_JUMP,
+    OP_BRANCH,
+    OP_LOOP,
+    OP_UNKNOWN_NODE,
+    OP_SET_NUMBER,
+    OP_SET_STRING,
+    OP_SET_BOOL,
+    OP_SET_COLOR,
+    OP_SET_VARIABLE,
+    OP_SET_BACKGROUND,
+    OP_SET_FPS,
+    OP_CREATE_SPRITE,
+    OP_SPAWN_SPRITE,
+    OP_DESTROY_SPRITE,
+    OP_SET_SPRITE_POSITION,
+    OP_SET_SPRITE_ROTATION,
+    OP_SET_SPRITE_TEXTURE,
+    OP_SET_SPRITE_SIZE,
+    OP_FORCE_SPRITE,
+    OP_SET_SPRITE_PHYSICS,
+    OP_SET_COLLISION_GROUP,
+    OP_SET_GROUPS_COLLIDE,
+    OP_SET_Z_ORDER,
+    OP_SET_CAMERA,
+    OP_CAMERA_FOLLOW,
+    OP_RAYCAST,
+    OP_OVERLAP_CIRCLE,
+    OP_OVERLAP_RECTANGLE,
+    OP_NEAREST_SPRITE,
+    OP_SPRITE_AT_POINT,
+    OP_MOVE_TO_SPRITE,
+    OP_DELAY,
+    OP_SHOW_PROP,
+    OP_COMPARISON,
+    OP_GATE,
+    OP_ARITHMETIC,
+    OP_PRINT_TO_LOG,
+    OP_DRAW_DEBUG_LINE
+} OpCode;
+
+#define MAX_INSTRUCTION_OPERANDS 8
+#define INFINITE_LOOP_PROTECTION_STEPS 1000
+
+// operands[i] is the value index of input pin i, resolved at build time
+typedef struct Instruction
+{
+    OpCode op;
+    int nodeIndex;
+    int operands[MAX_INSTRUCTION_OPERANDS];
+    int result;
+    int option;
+    int componentIndex;
+    int jump;
+    int loopSteps;
+
+    // Pure nodes only: input versions seen on the last evaluation
+    unsigned int operandVersions[2];
+    // Bit i set when operands[i] is produced by a detached pure node and has to be pulled first
+    int pullMask;
+} Instruction;
+
+struct InterpreterContext;
+
+typedef void (*CompiledEvent)(struct InterpreterContext *intp);
+
 typedef struct RuntimeGraphContext
 {
     RuntimeNode *nodes;
     int nodeCount;
 
+    RuntimeNodeInfo *nodeInfos;
+
     RuntimePin *pins;
     int pinCount;
+
+    RuntimePinInfo *pinInfos;
+
+    Instruction *code;
+    int codeCount;
+    int codeCapacity;
+
+    int *entryPoints;
+
+    // Pure nodes outside any flow chain, evaluated on demand through valueProducers
+    Instruction *pureCode;
+    int pureCount;
+    int *valueProducers;
+
+    CompiledEvent *compiledEvents;
 } RuntimeGraphContext;
 
 typedef enum
@@ -64,7 +162,8 @@ typedef enum {
     HITBOX_NONE,
     HITBOX_RECT,
     HITBOX_CIRCLE,
-    HITBOX_POLY
+    HITBOX_POLY,
+    HITBOX_CAPSULE
 } HitboxType;
 
 typedef struct {
@@ -77,6 +176,18 @@ typedef struct {
     };
 } Hitbox;
 
+// Circle, rectangle or capsule a polygon hitbox is collided as, in the polygon's own texture space
+typedef struct FittedHitbox
+{
+    HitboxType type;
+    // Rectangle corner, or circle and capsule center
+    Vector2 offset;
+    Vector2 rectSize;
+    float radius;
+    // Half of the capsule's segment, around its center
+    Vector2 capsuleAxis;
+} FittedHitbox;
+
 typedef struct
 {
     bool isVisible;
@@ -90,6 +201,12 @@ typedef struct
     Hitbox hitbox;
 
     Texture2D texture;
+    // Texels of texture the sprite shows, all of it unless the texture is an atlas page
+    Rectangle source;
+    // The texture belongs to the atlas and is shared, it is never unloaded with the sprite
+    bool isInAtlas;
+    // Texture cache entry the sprite holds a reference on, -1 for none
+    int cachedTexture;
 } Sprite;
 
 typedef enum
@@ -121,6 +238,12 @@ typedef struct
     bool isVisible;
     bool isSprite;
 
+    // Its category bit is 1 << collisionGroup, what it collides with comes from the group's collision mask
+    int collisionGroup;
+
+    // Higher ones are drawn over lower ones, unlike layer which only decides what collides
+    int zOrder;
+
     union
     {
         Sprite sprite;
@@ -130,9 +253,7 @@ typedef struct
 
 typedef struct
 {
-    char *name;
     ValueType type;
-    bool isVariable;
     union
     {
         float number;
@@ -140,34 +261,449 @@ typedef struct
         char *string;
         Vector2 vector;
         Color color;
-        Sprite sprite;
+        const SceneComponent *component;
     };
     int componentIndex;
 } Value;
 
-typedef struct
+// One dense array per field, all indexed by value index; sprite values only hold a component index
+typedef struct ValueStore
 {
-    int id;
+    ValueType *types;
+    float *numbers;
+    bool *booleans;
+    char **strings;
+    Color *colors;
+    int *componentIndexes;
+
+    // Bumped on every write, pure nodes recompute only when an input version moved
+    unsigned int *versions;
+
+    char **names;
+    bool *isVariable;
+} ValueStore;
+
+typedef struct BuildArenaBlock
+{
+    struct BuildArenaBlock *next;
+    size_t capacity;
+    size_t used;
+    unsigned char *data;
+} BuildArenaBlock;
+
+// Everything a build hands to the running game is carved from here and released in one go on Stop
+typedef struct BuildArena
+{
+    BuildArenaBlock *blocks;
+    size_t bytesUsed;
+    size_t bytesReserved;
+    int allocationCount;
+    int blockCount;
+} BuildArena;
+
+#define MAX_KEY_CODES 512
+
+// On Button handlers bucketed by key and action, built when the game starts
+typedef struct KeyDispatchTable
+{
+    // Bucket key * KEY_ACTION_COUNT + action holds nodes[start[bucket]] .. nodes[start[bucket + 1] - 1], in graph order
+    int *start;
+    int *nodes;
+    int count;
+
+    // Keys with a Not Down handler, checked every frame against the held set
+    int *notDownKeys;
+    int notDownKeyCount;
+
+    bool isHeld[MAX_KEY_CODES];
+    int heldKeys[MAX_KEY_CODES];
+    int heldCount;
+
+    int *triggered;
+} KeyDispatchTable;
+
+typedef enum
+{
+    LATENT_DELAY,
+    LATENT_MOVE_TO,
+    LATENT_FORCE
+} LatentKind;
+
+// A flow suspended on a Delay or Move To node, it carries on from resumePc once the wait is over.
+// Force nodes park their running time here as well, nothing resumes when it runs out
+typedef struct LatentWait
+{
+    struct LatentWait *next;
+    LatentKind kind;
+    int nodeIndex;
+    int resumePc;
+
+    // Delay and Force: tick of the latent clock the wait is over on
+    long long dueTick;
+
+    // Move To: the sprite is slid from start to target while the flow waits
     int componentIndex;
-    int pixelsPerSecond;
-    int angle;
+    Vector2 start;
+    Vector2 target;
+    double startTime;
     float duration;
-}Force;
 
-typedef struct
+    // Force: velocity the node adds to the body of componentIndex until it runs out
+    Vector2 push;
+} LatentWait;
+
+#define LATENT_WHEEL_SLOTS 256
+#define LATENT_TICKS_PER_SECOND 60
+
+// Delays are hashed by due tick into a timing wheel, so a frame only looks at the slots its clock advanced over
+typedef struct LatentScheduler
+{
+    // Seconds of unpaused game time
+    double time;
+    long long currentTick;
+
+    LatentWait *wheel[LATENT_WHEEL_SLOTS];
+    LatentWait *wheelTail[LATENT_WHEEL_SLOTS];
+
+    LatentWait *movers;
+    LatentWait *moversTail;
+
+    LatentWait *freeList;
+    int pendingCount;
+} LatentScheduler;
+
+// Motion of every component, one array per field indexed by component index, so a frame integrates them in flat loops
+typedef struct RigidBodies
+{
+    float *velocityX;
+    float *velocityY;
+    // Pixels per second squared, pulling down the screen
+    float *gravity;
+    // Fraction of the velocity lost per second
+    float *damping;
+
+    // Sum of the Force nodes pushing the body, on top of its velocity
+    float *pushX;
+    float *pushY;
+    int *pushCount;
+
+    // Offset the body moves this frame, and where it was before the move in case it gets blocked
+    float *stepX;
+    float *stepY;
+    float *previousX;
+    float *previousY;
+    bool *isBlocked;
+    // Share of the step a blocked body still takes, stopping just short of what blocks it
+    float *impactTime;
+    // Share of the step where a swept body first touches what blocks it, 1 when it already touches at the end of the step
+    float *touchTime;
+
+    // Running Force node by node index, NULL while the node is not pushing
+    LatentWait **forceByNode;
+    int nodeCount;
+} RigidBodies;
+
+typedef struct ConvexPiece
+{
+    // Runs of CollisionShape.pieceIndexes, counter-clockwise
+    int first;
+    int count;
+    Rectangle bounds;
+} ConvexPiece;
+
+// World-space hitbox of one component, rebuilt only when the placement it was built from changes
+typedef struct CollisionShape
+{
+    HitboxType type;
+    // Type of the hitbox the shape was built from, a polygon's while a fitted primitive stands in for it
+    HitboxType hitboxType;
+    Vector2 position;
+    Vector2 size;
+    Vector2 textureSize;
+    float rotation;
+    bool isBuilt;
+
+    Rectangle bounds;
+
+    // Polygon outline or rectangle corners
+    Vector2 *vertices;
+    int vertexCount;
+
+    // Convex decomposition of the polygon, made once at build time; no pieces means the outline is not simple
+    int *pieceIndexes;
+    ConvexPiece *pieces;
+    int pieceCount;
+
+    Vector2 center;
+    float radius;
+    // World-space half segment of a capsule
+    Vector2 axis;
+
+    // Primitive a sprite's polygon is collided as while its placement allows it, made once at build time
+    FittedHitbox fitted;
+} CollisionShape;
+
+typedef struct CollisionGridEntry
+{
+    struct CollisionGridEntry *next;
+    int componentIndex;
+} CollisionGridEntry;
+
+#define MAX_COLLISION_GROUPS 32
+
+typedef struct CollisionProxy
+{
+    bool isInGrid;
+    // Too large or too far out to bin, checked against every query instead
+    bool isOversized;
+    Rectangle bounds;
+    // Copied from the component, so queries can skip groups that never meet without touching it
+    int collisionGroup;
+    int minCellX;
+    int minCellY;
+    int maxCellX;
+    int maxCellY;
+} CollisionProxy;
+
+// Per thread buffers of a grid query, so physics workers can query the grid side by side
+typedef struct CollisionScratch
+{
+    int *candidates;
+    unsigned int *visitStamp;
+    unsigned int stamp;
+} CollisionScratch;
+
+#define COLLISION_GRID_CELL_SIZE 128
+#define COLLISION_GRID_BUCKETS 4096
+#define COLLISION_GRID_MAX_CELLS 64
+
+// Uniform grid over component bounds with cells hashed into a fixed bucket table.
+// Props are binned once when the game starts, sprites move between cells as they move
+typedef struct CollisionGrid
+{
+    CollisionGridEntry **buckets;
+    CollisionProxy *proxies;
+    CollisionGridEntry *freeList;
+
+    int *oversized;
+    int oversizedCount;
+
+    // Sprites that flow nodes moved since they were last binned, re-binned before a spatial query reads the grid
+    int *movedSprites;
+    bool *isMoved;
+    int movedCount;
+
+    // Used by the game thread, physics workers bring their own
+    CollisionScratch scratch;
+} CollisionGrid;
+
+#define MAX_PHYSICS_WORKERS 16
+
+// Threads the physics step is spread over, started on the first frame that asks for more than one worker
+struct PhysicsPool;
+
+typedef enum
+{
+    CONTACT_BEGIN,
+    CONTACT_STAY,
+    CONTACT_END
+} ContactState;
+
+// Two touching components where at least one is on a collision event layer, a is the lower component index
+typedef struct ContactPair
+{
+    int a;
+    int b;
+    ContactState state;
+} ContactPair;
+
+typedef struct ContactList
+{
+    ContactPair *pairs;
+    int count;
+    int capacity;
+    bool outOfMemory;
+} ContactList;
+
+// Contacts of the last collision pass, kept across frames so every pair can be told apart as begun, staying or ended.
+// The pass only runs while the graph has On Collision nodes
+typedef struct ContactCache
+{
+    // Touching after the last pass, sorted by a then b
+    ContactList touching;
+    // Stopped touching in the last pass
+    ContactList ended;
+    // Last pass's touching list, its buffer is reused for the next pass
+    ContactList previous;
+    // What every physics worker found, merged after the pass
+    ContactList found[MAX_PHYSICS_WORKERS];
+
+    int *beginHandlers;
+    int beginHandlerCount;
+    int *endHandlers;
+    int endHandlerCount;
+} ContactCache;
+
+#define ATLAS_PAGE_SIZE 2048
+// Empty texels kept right and below every packed image
+#define ATLAS_PADDING 1
+
+typedef struct AtlasEntry
+{
+    char *fileName;
+    // -1 when the image is too large for a page and its sprites keep their own texture
+    int page;
+    Rectangle source;
+} AtlasEntry;
+
+// Every sprite texture the graph names, packed into as few pages as fit when the graph is built
+typedef struct TextureAtlas
+{
+    Texture2D *pages;
+    int pageCount;
+    AtlasEntry *entries;
+    int entryCount;
+} TextureAtlas;
+
+#define TEXTURE_CACHE_DEFAULT_BUDGET_MB 256
+
+typedef struct CachedTexture
+{
+    // Files with the same bytes share the entry and its texture
+    unsigned long long contentHash;
+    int contentSize;
+    // Id 0 once evicted, the entry stays so the names leading to it keep working
+    Texture2D texture;
+    int vramBytes;
+    int refCount;
+    unsigned int lastUsed;
+} CachedTexture;
+
+typedef struct TextureCacheName
+{
+    char *fileName;
+    int entry;
+} TextureCacheName;
+
+// Sprite textures loaded once and shared by every sprite showing them. Ones no sprite shows stay loaded
+// until the loaded total passes the budget, then go least recently used first
+typedef struct TextureCache
+{
+    CachedTexture *entries;
+    int entryCount;
+    int entryCapacity;
+    // Open addressing on the file name, entry -1 marks an empty slot
+    TextureCacheName *names;
+    int nameCount;
+    int nameCapacity;
+    long long loadedBytes;
+    unsigned int clock;
+    int hits;
+    int misses;
+    int evictions;
+} TextureCache;
+
+#define RENDER_MIN_Z_ORDER -32768
+#define RENDER_MAX_Z_ORDER 32767
+
+typedef enum
+{
+    RENDER_PRIMITIVE_SPRITE,
+    RENDER_PRIMITIVE_RECTANGLE,
+    RENDER_PRIMITIVE_CIRCLE
+} RenderPrimitive;
+
+typedef struct RenderItem
+{
+    // Z order in the highest bits, then texture, then primitive, so sorting by it groups what can share a draw call
+    unsigned long long key;
+    int componentIndex;
+} RenderItem;
+
+// Rebuilt from the visible components every frame, only its buffers are kept
+typedef struct RenderQueue
+{
+    RenderItem *items;
+    // Scratch the radix sort scatters into, swapped with items after every pass
+    RenderItem *sorted;
+    int count;
+    int capacity;
+
+    // Counted while the last frame was submitted
+    int culledCount;
+    int drawCalls;
+    int batches;
+    // What drawing in component order would have cost
+    int unsortedDrawCalls;
+} RenderQueue;
+
+typedef struct DebugLine
+{
+    Vector2 start;
+    Vector2 end;
+    Color color;
+} DebugLine;
+
+// Lines the graph asked for during the last frame it ran, in world coordinates
+typedef struct DebugLineQueue
+{
+    DebugLine *lines;
+    int count;
+    int capacity;
+} DebugLineQueue;
+
+// Until the graph places it, the camera stays centered on the game screen, which shows the world 1:1 as before
+typedef struct GameCamera
+{
+    // World point at the center of the view
+    Vector2 position;
+    bool isPlaced;
+    float zoom;
+    // Degrees, clockwise
+    float rotation;
+    // Sprite the camera is kept centered on after every physics step, -1 for none
+    int followComponent;
+
+    // Where the game screen is drawn on its render target, and the world rectangle it showed last frame
+    Rectangle screen;
+    Rectangle view;
+} GameCamera;
+
+typedef struct InterpreterContext
 {
-    Value *values;
+    BuildArena arena;
+
+    ValueStore values;
     int valueCount;
 
     int *varIndexes;
     int varCount;
-    
-    Force *forces;
-    int forcesCount;
+
+    LatentScheduler latent;
 
     SceneComponent *components;
     int componentCount;
 
+    RigidBodies bodies;
+
+    // Threads the physics step may use, the game thread included; results do not depend on it
+    int physicsWorkerCount;
+    struct PhysicsPool *physicsPool;
+
+    CollisionShape *collisionShapes;
+    CollisionGrid collisionGrid;
+    ContactCache contacts;
+
+    TextureAtlas atlas;
+    TextureCache textureCache;
+    // Megabytes of sprite textures kept loaded for reuse when no sprite shows them
+    int textureBudgetMB;
+    RenderQueue renderQueue;
+    DebugLineQueue debugLines;
+
+    // One bit for every group that group g collides with, kept symmetric
+    unsigned int collisionMasks[MAX_COLLISION_GROUPS];
+
     char *projectPath;
 
     int loopNodeIndex;
@@ -179,8 +715,7 @@ typedef struct
     LogLevel logMessageLevels[MAX_LOG_MESSAGES];
     int logMessageCount;
 
-    int *onButtonNodeIndexes;
-    int onButtonNodeIndexesCount;
+    KeyDispatchTable keyHandlers;
 
     Color backgroundColor;
 
@@ -192,10 +727,11 @@ typedef struct
     bool buildErrorOccured;
 
     bool shouldShowHitboxes;
+    bool shouldShowDrawCalls;
 
     bool isPaused;
 
-    Vector2 cameraOffset;
+    GameCamera camera;
 
     RuntimeGraphContext *runtimeGraph;
 } InterpreterContext;
@@ -206,6 +742,11 @@ typedef enum{
     SPECIAL_VALUE_MOUSE_Y,
     SPECIAL_VALUE_SCREEN_WIDTH,
     SPECIAL_VALUE_SCREEN_HEIGHT,
+    SPECIAL_VALUE_CAMERA_X,
+    SPECIAL_VALUE_CAMERA_Y,
+    SPECIAL_VALUE_CAMERA_ZOOM,
+    SPECIAL_VALUE_CAMERA_ROTATION,
+    SPECIAL_VALUE_UNLINKED,
     SPECIAL_VALUES_COUNT
 }SpecialValuesInList;
 
@@ -233,6 +774,21 @@ char *ValueTypeToString(ValueType type);
 
 char *ValueToString(Value value);
 
+Value GetValue(InterpreterContext *interpreter, int valueIndex);
+
 RuntimeGraphContext ConvertToRuntimeGraph(GraphContext *graph, InterpreterContext *interpreter);
 
-bool HandleGameScreen(InterpreterContext *interpreter, RuntimeGraphContext *graph, Vector2 mousePos, Rectangle screenBoundary);
\ No newline at end of file
+bool HotPatchRuntimeGraph(GraphContext *graph, InterpreterContext *interpreter, RuntimeGraphContext *runtimeGraph);
+
+bool HandleGameScreen(InterpreterContext *interpreter, RuntimeGraphContext *graph, Vector2 mousePos, Rectangle screenBoundary);
+
+FittedHitbox FitPolygonHitbox(const Polygon *polygon);
+
+// Spatial queries over the visible components of one collision group, answered from the collision grid
+bool RaycastComponents(InterpreterContext *interpreter, Vector2 start, Vector2 end, int group, int *componentIndex, Vector2 *hitPoint);
+
+int OverlapCircleSprites(InterpreterContext *interpreter, Vector2 center, float radius, int group, int *firstSprite);
+
+int OverlapRectangleSprites(InterpreterContext *interpreter, Rectangle rect, int group, int *firstSprite);
+
+int FindNearestSprite(InterpreterContext *interpreter, Vector2 point, float radius, int group, float *distance);
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+
+#ifdef _WIN32
+// windows.h clashes with raylib, so the few threading calls the engine needs are declared by hand
+typedef struct
+{
+    void *ptr;
+} ThreadLock;
+typedef struct
+{
+    void *ptr;
+} ThreadCondition;
+typedef void *ThreadHandle;
+
+void *__stdcall CreateThread(void *attributes, size_t stackSize, unsigned long(__stdcall *start)(void *), void *parameter, unsigned long flags, unsigned long *threadId);
+unsigned long __stdcall WaitForSingleObject(void *handle, unsigned long milliseconds);
+int __stdcall CloseHandle(void *handle);
+void __stdcall InitializeSRWLock(ThreadLock *lock);
+void __stdcall AcquireSRWLockExclusive(ThreadLock *lock);
+void __stdcall ReleaseSRWLockExclusive(ThreadLock *lock);
+void __stdcall InitializeConditionVariable(ThreadCondition *condition);
+int __stdcall SleepConditionVariableSRW(ThreadCondition *condition, ThreadLock *lock, unsigned long milliseconds, unsigned long flags);
+void __stdcall WakeAllConditionVariable(ThreadCondition *condition);
+#else
+#include <pthread.h>
+typedef pthread_mutex_t ThreadLock;
+typedef pthread_cond_t ThreadCondition;
+typedef pthread_t ThreadHandle;
+#endif
\ No newline at end of file
@@ -0,0 +1,470 @@
+#include "Transpiler.h"
+
+// Writes one instruction as straight-line C, operands are baked in as constant value indexes
+static void WriteInstruction(FILE *f, RuntimeGraphContext *graph, InterpreterContext *intp, int pc)
+{
+    Instruction *ins = &graph->code[pc];
+    int *in = ins->operands;
+
+    if (ins->pullMask)
+    {
+        fprintf(f, "    PullOperands(v, intp->runtimeGraph, &intp->runtimeGraph->code[%d], 0);\n", pc);
+    }
+
+    bool isPure = ins->op == OP_COMPARISON || ins->op == OP_GATE || ins->op == OP_ARITHMETIC;
+    if (isPure)
+    {
+        fprintf(f, "    if (PureInputsChanged(v, &intp->runtimeGraph->code[%d]))\n    {\n", pc);
+    }
+
+    switch (ins->op)
+    {
+    case OP_NOP:
+        break;
+    case OP_END:
+        fprintf(f, "    return;\n");
+        break;
+    case OP_JUMP:
+        fprintf(f, "    goto L%d;\n", ins->jump);
+        break;
+    case OP_BRANCH:
+        fprintf(f, "    if (!v->booleans[%d]) goto L%d;\n", in[1], ins->jump);
+        break;
+    case OP_LOOP:
+        fprintf(f, "    if (!v->booleans[%d]) { loopSteps%d = %d; goto L%d; }\n", in[1], pc, INFINITE_LOOP_PROTECTION_STEPS, ins->jump);
+        fprintf(f, "    if (loopSteps%d == 0)\n    {\n", pc);
+        fprintf(f, "        if (intp->isInfiniteLoopProtectionOn)\n        {\n");
+        fprintf(f, "            AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = \"Possible infinite loop detected and exited! You can turn off infinite loop protection in settings{I210}\"}, LOG_LEVEL_ERROR);\n");
+        fprintf(f, "            loopSteps%d = %d;\n            goto L%d;\n        }\n", pc, INFINITE_LOOP_PROTECTION_STEPS, ins->jump);
+        fprintf(f, "        AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = \"Possible infinite loop detected! Infinite loop protection is off!{I101}\"}, LOG_LEVEL_WARNING);\n");
+        fprintf(f, "    }\n    else\n    {\n        loopSteps%d--;\n    }\n", pc);
+        break;
+    case OP_UNKNOWN_NODE:
+        fprintf(f, "    AddToLogFromInterpreter(intp, (Value){.type = VAL_STRING, .string = \"Unknown node{I20E}\"}, LOG_LEVEL_ERROR);\n");
+        break;
+    case OP_SET_NUMBER:
+        fprintf(f, "    v->numbers[%d] = v->numbers[%d];\n    MarkValueWritten(v, %d);\n", ins->result, in[1], ins->result);
+        break;
+    case OP_SET_STRING:
+        fprintf(f, "    v->strings[%d] = v->strings[%d];\n    MarkValueWritten(v, %d);\n", ins->result, in[1], ins->result);
+        break;
+    case OP_SET_BOOL:
+        fprintf(f, "    v->booleans[%d] = v->booleans[%d];\n    MarkValueWritten(v, %d);\n", ins->result, in[1], ins->result);
+        break;
+    case OP_SET_COLOR:
+        fprintf(f, "    v->colors[%d] = v->colors[%d];\n    MarkValueWritten(v, %d);\n", ins->result, in[1], ins->result);
+        break;
+    case OP_SET_VARIABLE:
+        switch (intp->values.types[ins->result])
+        {
+        case VAL_NUMBER:
+            fprintf(f, "    v->numbers[%d] = v->numbers[%d];\n", ins->result, in[2]);
+            break;
+        case VAL_STRING:
+            fprintf(f, "    v->strings[%d] = v->strings[%d];\n", ins->result, in[2]);
+            break;
+        case VAL_BOOL:
+            fprintf(f, "    v->booleans[%d] = v->booleans[%d];\n", ins->result, in[2]);
+            break;
+        case VAL_COLOR:
+            fprintf(f, "    v->colors[%d] = v->colors[%d];\n", ins->result, in[2]);
+            break;
+        case VAL_SPRITE:
+            fprintf(f, "    v->componentIndexes[%d] = v->componentIndexes[%d];\n", ins->result, in[2]);
+            break;
+        default:
+            break;
+        }
+        fprintf(f, "    MarkValueWritten(v, %d);\n", ins->result);
+        break;
+    case OP_SET_BACKGROUND:
+        fprintf(f, "    intp->backgroundColor = v->colors[%d];\n", in[1]);
+        break;
+    case OP_SET_FPS:
+        fprintf(f, "    intp->fps = v->numbers[%d];\n", in[1]);
+        break;
+    case OP_CREATE_SPRITE:
+        fprintf(f, "    {\n        Sprite *sprite = &intp->components[%d].sprite;\n", ins->componentIndex);
+        fprintf(f, "        sprite->width = NumberOrCurrent(v, %d, sprite->width);\n", in[2]);
+        fprintf(f, "        sprite->height = NumberOrCurrent(v, %d, sprite->height);\n", in[3]);
+        fprintf(f, "        sprite->layer = NumberOrCurrent(v, %d, sprite->layer);\n", in[4]);
+        fprintf(f, "        sprite->hitbox.type = HITBOX_POLY;\n");
+        fprintf(f, "        MarkSpriteMoved(intp, %d);\n    }\n", ins->componentIndex);
+        break;
+    case OP_SPAWN_SPRITE:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n        {\n", in[1]);
+        fprintf(f, "            Sprite *sprite = &intp->components[c].sprite;\n");
+        fprintf(f, "            intp->components[c].isVisible = true;\n");
+        fprintf(f, "            sprite->position.x = NumberOrCurrent(v, %d, sprite->position.x);\n", in[2]);
+        fprintf(f, "            sprite->position.y = NumberOrCurrent(v, %d, sprite->position.y);\n", in[3]);
+        fprintf(f, "            sprite->rotation = 360 - NumberOrCurrent(v, %d, 360 - sprite->rotation);\n", in[4]);
+        fprintf(f, "            MarkSpriteMoved(intp, c);\n        }\n    }\n");
+        break;
+    case OP_DESTROY_SPRITE:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n            intp->components[c].isVisible = false;\n    }\n", in[1]);
+        break;
+    case OP_SET_SPRITE_POSITION:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n        {\n", in[1]);
+        fprintf(f, "            intp->components[c].sprite.position.x = v->numbers[%d];\n", in[2]);
+        fprintf(f, "            intp->components[c].sprite.position.y = v->numbers[%d];\n", in[3]);
+        fprintf(f, "            MarkSpriteMoved(intp, c);\n        }\n    }\n");
+        break;
+    case OP_SET_SPRITE_ROTATION:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n        {\n", in[1]);
+        fprintf(f, "            intp->components[c].sprite.rotation = -1 * (v->numbers[%d] - 360);\n", in[2]);
+        fprintf(f, "            MarkSpriteMoved(intp, c);\n        }\n    }\n");
+        break;
+    case OP_SET_SPRITE_TEXTURE:
+        fprintf(f, "    SetSpriteTexture(intp, v->componentIndexes[%d], v->strings[%d]);\n", in[1], in[2]);
+        break;
+    case OP_SET_SPRITE_SIZE:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n        {\n", in[1]);
+        fprintf(f, "            intp->components[c].sprite.width = v->numbers[%d];\n", in[2]);
+        fprintf(f, "            intp->components[c].sprite.height = v->numbers[%d];\n", in[3]);
+        fprintf(f, "            MarkSpriteMoved(intp, c);\n        }\n    }\n");
+        break;
+    case OP_FORCE_SPRITE:
+        fprintf(f, "    ApplyForce(intp, %d, v->componentIndexes[%d], v->numbers[%d], v->numbers[%d], v->numbers[%d]);\n", ins->nodeIndex, in[1], in[2], in[3], in[4]);
+        break;
+    case OP_SET_SPRITE_PHYSICS:
+        fprintf(f, "    {\n        int c = v->componentIndexes[%d];\n        if (c >= 0 && c < intp->componentCount)\n        {\n", in[1]);
+        fprintf(f, "            intp->bodies.gravity[c] = v->numbers[%d];\n", in[2]);
+        fprintf(f, "            intp->bodies.damping[c] = v->numbers[%d] > 0 ? v->numbers[%d] : 0;\n        }\n    }\n", in[3], in[3]);
+        break;
+    case OP_SET_COLLISION_GROUP:
+        fprintf(f, "    SetCollisionGroup(intp, v->componentIndexes[%d], v->numbers[%d]);\n", in[1], in[2]);
+        break;
+    case OP_SET_GROUPS_COLLIDE:
+        fprintf(f, "    SetGroupsCollide(intp, v->numbers[%d], v->numbers[%d], v->booleans[%d]);\n", in[1], in[2], in[3]);
+        break;
+    case OP_SET_Z_ORDER:
+        fprintf(f, "    SetZOrder(intp, v->componentIndexes[%d], v->numbers[%d]);\n", in[1], in[2]);
+        break;
+    case OP_SET_CAMERA:
+        fprintf(f, "    SetCamera(intp, v->numbers[%d], v->numbers[%d], v->numbers[%d], v->numbers[%d]);\n", in[1], in[2], in[3], in[4]);
+        break;
+    case OP_CAMERA_FOLLOW:
+        fprintf(f, "    SetCameraFollow(intp, v->componentIndexes[%d]);\n", in[1]);
+        break;
+    case OP_RAYCAST:
+    case OP_OVERLAP_CIRCLE:
+    case OP_OVERLAP_RECTANGLE:
+    case OP_NEAREST_SPRITE:
+    case OP_SPRITE_AT_POINT:
+        fprintf(f, "    RunSpatialQuery(intp, intp->runtimeGraph, &intp->runtimeGraph->code[%d]);\n", pc);
+        break;
+    case OP_MOVE_TO_SPRITE:
+        fprintf(f, "    if (ParkMoveTo(intp, %d, %d, v->componentIndexes[%d], (Vector2){v->numbers[%d], v->numbers[%d]}, v->numbers[%d])) return;\n", ins->nodeIndex, pc + 1, in[1], in[2], in[3], in[4]);
+        break;
+    case OP_DELAY:
+        fprintf(f, "    if (ParkDelay(intp, %d, %d, v->numbers[%d])) return;\n", ins->nodeIndex, pc + 1, in[1]);
+        break;
+    case OP_SHOW_PROP:
+        fprintf(f, "    intp->components[%d].isVisible = true;\n", ins->componentIndex);
+        break;
+    case OP_COMPARISON:
+    {
+        const char *op = ins->option == GREATER_THAN ? ">" : ins->option == LESS_THAN ? "<" : "==";
+        if (ins->option == EQUAL_TO || ins->option == GREATER_THAN || ins->option == LESS_THAN)
+            fprintf(f, "        v->booleans[%d] = v->numbers[%d] %s v->numbers[%d];\n", ins->result, in[2], op, in[3]);
+        break;
+    }
+    case OP_GATE:
+        switch (ins->option)
+        {
+        case AND:
+            fprintf(f, "        v->booleans[%d] = v->booleans[%d] && v->booleans[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case OR:
+            fprintf(f, "        v->booleans[%d] = v->booleans[%d] || v->booleans[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case NOT:
+            fprintf(f, "        v->booleans[%d] = !v->booleans[%d];\n", ins->result, in[2]);
+            break;
+        case XOR:
+            fprintf(f, "        v->booleans[%d] = v->booleans[%d] != v->booleans[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case NAND:
+            fprintf(f, "        v->booleans[%d] = !(v->booleans[%d] && v->booleans[%d]);\n", ins->result, in[2], in[3]);
+            break;
+        case NOR:
+            fprintf(f, "        v->booleans[%d] = !(v->booleans[%d] || v->booleans[%d]);\n", ins->result, in[2], in[3]);
+            break;
+        default:
+            break;
+        }
+        break;
+    case OP_ARITHMETIC:
+        switch (ins->option)
+        {
+        case ADD:
+            fprintf(f, "        v->numbers[%d] = v->numbers[%d] + v->numbers[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case SUBTRACT:
+            fprintf(f, "        v->numbers[%d] = v->numbers[%d] - v->numbers[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case MULTIPLY:
+            fprintf(f, "        v->numbers[%d] = v->numbers[%d] * v->numbers[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case DIVIDE:
+            fprintf(f, "        v->numbers[%d] = v->numbers[%d] / v->numbers[%d];\n", ins->result, in[2], in[3]);
+            break;
+        case MODULO:
+            fprintf(f, "        v->numbers[%d] = (int)v->numbers[%d] %% (int)v->numbers[%d];\n", ins->result, in[2], in[3]);
+            break;
+        default:
+            break;
+        }
+        break;
+    case OP_PRINT_TO_LOG:
+        fprintf(f, "    AddToLogFromInterpreter(intp, GetValue(intp, %d), LOG_LEVEL_DEBUG);\n", in[1]);
+        break;
+    case OP_DRAW_DEBUG_LINE:
+        fprintf(f, "    DrawDebugLine(intp, v->numbers[%d], v->numbers[%d], v->numbers[%d], v->numbers[%d], v->colors[%d]);\n", in[1], in[2], in[3], in[4], in[5]);
+        break;
+    default:
+        break;
+    }
+
+    if (isPure)
+    {
+        fprintf(f, "        MarkValueWritten(v, %d);\n    }\n", ins->result);
+    }
+}
+
+static bool IsTerminator(OpCode op)
+{
+    return op == OP_END || op == OP_JUMP;
+}
+
+// Emits one C function per event, containing every instruction reachable from its entry point.
+// Flows parked on a latent node resume through the bytecode, which is always loaded next to the compiled events
+static bool WriteEventFunction(FILE *f, RuntimeGraphContext *graph, InterpreterContext *intp, int nodeIndex, bool *isReachable, bool *isLabel, int *stack)
+{
+    int entry = graph->entryPoints[nodeIndex];
+
+    memset(isReachable, 0, sizeof(bool) * graph->codeCount);
+    memset(isLabel, 0, sizeof(bool) * graph->codeCount);
+
+    int stackCount = 0;
+    stack[stackCount++] = entry;
+    isReachable[entry] = true;
+
+    while (stackCount > 0)
+    {
+        int pc = stack[--stackCount];
+        Instruction *ins = &graph->code[pc];
+
+        int successors[2] = {-1, -1};
+        if (!IsTerminator(ins->op))
+            successors[0] = pc + 1;
+        if (ins->op == OP_JUMP || ins->op == OP_BRANCH || ins->op == OP_LOOP)
+        {
+            successors[1] = ins->jump;
+            if (ins->jump >= 0 && ins->jump < graph->codeCount)
+                isLabel[ins->jump] = true;
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            int next = successors[i];
+            if (next < 0 || next >= graph->codeCount || isReachable[next])
+                continue;
+            isReachable[next] = true;
+            stack[stackCount++] = next;
+        }
+    }
+
+    fprintf(f, "static void CG_Event_%d(InterpreterContext *intp)\n{\n", nodeIndex);
+    fprintf(f, "    ValueStore *v = &intp->values;\n");
+
+    for (int pc = 0; pc < graph->codeCount; pc++)
+    {
+        if (isReachable[pc] && graph->code[pc].op == OP_LOOP)
+            fprintf(f, "    int loopSteps%d = %d;\n", pc, INFINITE_LOOP_PROTECTION_STEPS);
+    }
+
+    int firstReachable = entry;
+    for (int pc = 0; pc < entry; pc++)
+    {
+        if (isReachable[pc])
+        {
+            firstReachable = pc;
+            break;
+        }
+    }
+
+    if (firstReachable != entry)
+    {
+        isLabel[entry] = true;
+        fprintf(f, "    goto L%d;\n", entry);
+    }
+
+    bool hasPrevious = false;
+    int prev = -1;
+    for (int pc = 0; pc < graph->codeCount; pc++)
+    {
+        if (!isReachable[pc])
+            continue;
+
+        if (hasPrevious && !IsTerminator(graph->code[prev].op) && prev + 1 != pc)
+        {
+            fprintf(f, "    goto L%d;\n", prev + 1);
+        }
+
+        if (isLabel[pc])
+            fprintf(f, "L%d:;\n", pc);
+
+        WriteInstruction(f, graph, intp, pc);
+        prev = pc;
+        hasPrevious = true;
+    }
+
+    if (hasPrevious && !IsTerminator(graph->code[prev].op))
+    {
+        fprintf(f, "    return;\n");
+    }
+
+    fprintf(f, "}\n\n");
+
+    return !ferror(f);
+}
+
+// Project names end up inside C string literals, so quotes, backslashes and line breaks are escaped
+static void EscapeCString(char *dst, size_t size, const char *src)
+{
+    size_t n = 0;
+    for (; *src && n + 3 < size; src++)
+    {
+        if (*src == '"' || *src == '\\')
+        {
+            dst[n++] = '\\';
+            dst[n++] = *src;
+        }
+        else if (*src == '\n' || *src == '\r')
+        {
+            dst[n++] = '\\';
+            dst[n++] = *src == '\n' ? 'n' : 'r';
+        }
+        else
+        {
+            dst[n++] = *src;
+        }
+    }
+    dst[n] = '\0';
+}
+
+bool IsShellSafePath(const char *path)
+{
+#ifdef _WIN32
+    const char *unsafe = "\"%\n\r";
+#else
+    const char *unsafe = "\"$`\\\n\r";
+#endif
+    return strpbrk(path, unsafe) == NULL;
+}
+
+bool TranspileRuntimeGraph(RuntimeGraphContext *graph, InterpreterContext *intp, const char *projectName, const char *outputPath)
+{
+
+    if (!graph || !graph->code || !graph->entryPoints)
+        return false;
+
+    FILE *f = fopen(outputPath, "w");
+    if (!f)
+        return false;
+
+    bool *isReachable = malloc(sizeof(bool) * (graph->codeCount + 1));
+    bool *isLabel = malloc(sizeof(bool) * (graph->codeCount + 1));
+    int *stack = malloc(sizeof(int) * (graph->codeCount + 1));
+    if (!isReachable || !isLabel || !stack)
+    {
+        free(isReachable);
+        free(isLabel);
+        free(stack);
+        fclose(f);
+        return false;
+    }
+
+    char name[MAX_FILE_PATH * 2];
+    EscapeCString(name, sizeof(name), projectName);
+
+    fprintf(f, "// Generated by Rapid Engine from %s.cg, any changes will be overwritten on export\n\n", name);
+    fprintf(f, "#include \"Nodes.c\"\n#include \"Interpreter.c\"\n\n");
+    fprintf(f, "bool STRING_ALLOCATION_FAILURE = false;\n\n");
+
+    bool ok = true;
+    for (int i = 0; i < graph->nodeCount && ok; i++)
+    {
+        if (graph->entryPoints[i] >= 0 && graph->entryPoints[i] < graph->codeCount)
+        {
+            ok = WriteEventFunction(f, graph, intp, i, isReachable, isLabel, stack);
+        }
+    }
+
+    fprintf(f, "static CompiledEvent compiledEvents[%d] = {\n", graph->nodeCount + 1);
+    for (int i = 0; i < graph->nodeCount; i++)
+    {
+        if (graph->entryPoints[i] >= 0 && graph->entryPoints[i] < graph->codeCount)
+            fprintf(f, "    [%d] = CG_Event_%d,\n", i, i);
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "int main(void)\n{\n");
+    fprintf(f, "    SetConfigFlags(FLAG_WINDOW_RESIZABLE);\n");
+    fprintf(f, "    InitWindow(1280, 720, \"%s\");\n\n", name);
+    fprintf(f, "    char cgPath[MAX_FILE_PATH];\n");
+    fprintf(f, "    strmac(cgPath, MAX_FILE_PATH, \"%%s%%s.cg\", GetApplicationDirectory(), \"%s\");\n\n", name);
+    fprintf(f, "    GraphContext graph = InitGraphContext();\n");
+    fprintf(f, "    if (!LoadGraphFromFile(cgPath, &graph))\n    {\n        CloseWindow();\n        return 1;\n    }\n\n");
+    fprintf(f, "    InterpreterContext intp = InitInterpreterContext();\n");
+    fprintf(f, "    intp.projectPath = strmac(NULL, MAX_FILE_PATH, \"%%s\", GetDirectoryPath(cgPath));\n");
+    fprintf(f, "    intp.physicsWorkerCount = %d;\n", intp->physicsWorkerCount);
+    fprintf(f, "    intp.textureBudgetMB = %d;\n", intp->textureBudgetMB);
+    fprintf(f, "    RuntimeGraphContext runtimeGraph = ConvertToRuntimeGraph(&graph, &intp);\n");
+    fprintf(f, "    intp.runtimeGraph = &runtimeGraph;\n");
+    fprintf(f, "    if (intp.buildErrorOccured || runtimeGraph.nodeCount != %d || runtimeGraph.codeCount != %d)\n", graph->nodeCount, graph->codeCount);
+    fprintf(f, "    {\n        TraceLog(LOG_ERROR, \"%%s.cg has changed since it was exported\", \"%s\");\n        CloseWindow();\n        return 1;\n    }\n", name);
+    fprintf(f, "    runtimeGraph.compiledEvents = compiledEvents;\n\n");
+    fprintf(f, "    while (!WindowShouldClose())\n    {\n");
+    fprintf(f, "        SetTargetFPS(intp.fps);\n");
+    fprintf(f, "        BeginDrawing();\n");
+    fprintf(f, "        bool isRunning = HandleGameScreen(&intp, &runtimeGraph, GetMousePosition(), (Rectangle){0, 0, GetScreenWidth(), GetScreenHeight()});\n");
+    fprintf(f, "        EndDrawing();\n\n");
+    fprintf(f, "        for (int i = 0; i < intp.logMessageCount; i++)\n        {\n");
+    fprintf(f, "            printf(\"%%s\\n\", intp.logMessages[i]);\n        }\n");
+    fprintf(f, "        intp.logMessageCount = 0;\n\n");
+    fprintf(f, "        if (!isRunning)\n            break;\n    }\n\n");
+    fprintf(f, "    runtimeGraph.compiledEvents = NULL;\n");
+    fprintf(f, "    FreeInterpreterContext(&intp);\n");
+    fprintf(f, "    free(intp.projectPath);\n");
+    fprintf(f, "    FreeGraphContext(&graph);\n");
+    fprintf(f, "    CloseWindow();\n\n    return 0;\n}\n");
+
+    ok = ok && !ferror(f);
+
+    free(isReachable);
+    free(isLabel);
+    free(stack);
+    fclose(f);
+
+    return ok;
+}
+
+bool CompileTranspiledProject(const char *engineSourcePath, const char *sourcePath, const char *executablePath)
+{
+    if (!IsShellSafePath(engineSourcePath) || !IsShellSafePath(sourcePath) || !IsShellSafePath(executablePath))
+        return false;
+
+    char command[MAX_BUILD_COMMAND_SIZE];
+    strmac(command, MAX_BUILD_COMMAND_SIZE,
+           "gcc -O2 \"%s\" \"%s%craylib%clib%clibraylib.a\" -I\"%s\" -I\"%s%craylib%cinclude\" -o \"%s\" %s",
+           sourcePath,
+           engineSourcePath, PATH_SEPARATOR, PATH_SEPARATOR, PATH_SEPARATOR,
+           engineSourcePath,
+           engineSourcePath, PATH_SEPARATOR, PATH_SEPARATOR,
+           executablePath,
+           NATIVE_BUILD_LIBS);
+
+    return system(command) == 0;
+}
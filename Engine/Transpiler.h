@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdio.h>
+#include "raylib.h"
+#include "Interpreter.h"
+#include "definitions.h"
+
+#ifdef _WIN32
+#define NATIVE_BUILD_LIBS "-lopengl32 -lgdi32 -lwinmm"
+#define NATIVE_EXECUTABLE_EXTENSION ".exe"
+#elif __APPLE__
+#define NATIVE_BUILD_LIBS "-framework OpenGL -framework Cocoa -framework IOKit -framework CoreVideo"
+#define NATIVE_EXECUTABLE_EXTENSION ""
+#else
+#define NATIVE_BUILD_LIBS "-lGL -lm -lpthread -ldl -lrt -lX11"
+#define NATIVE_EXECUTABLE_EXTENSION ""
+#endif
+
+#define MAX_BUILD_COMMAND_SIZE 4096
+
+bool TranspileRuntimeGraph(RuntimeGraphContext *graph, InterpreterContext *intp, const char *projectName, const char *outputPath);
+
+// Paths go into the build command in double quotes, anything a shell expands or ends a quote with is refused
+bool IsShellSafePath(const char *path);
+
+bool CompileTranspiledProject(const char *engineSourcePath, const char *sourcePath, const char *executablePath);
@@ -68,10 +68,23 @@ static inline void OpenFile(const char* filePath) {
 
 #define MAX_POLYGON_VERTICES 64
 
+// Collision shape a polygon hitbox is built as, automatic picks the cheapest one that follows the outline closely enough
+typedef enum
+{
+    HITBOX_FIT_AUTO,
+    HITBOX_FIT_POLYGON,
+    HITBOX_FIT_CIRCLE,
+    HITBOX_FIT_RECT,
+    HITBOX_FIT_CAPSULE,
+    HITBOX_FIT_COUNT
+} HitboxFit;
+
 typedef struct {
     Vector2 vertices[MAX_POLYGON_VERTICES];
     int count;
     bool isClosed;
+    // HitboxFit, kept to a byte so saved graphs keep their layout
+    unsigned char fit;
 } Polygon;
 
 #define MAX_LOG_MESSAGE_SIZE 256